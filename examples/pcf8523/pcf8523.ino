@@ -64,6 +64,9 @@ void setup () {
   int offset = round(deviation_ppm / drift_unit);
   // rtc.calibrate(PCF8523_TwoHours, offset); // Un-comment to perform calibration once drift (seconds) and observation period (seconds) are correct
   // rtc.calibrate(PCF8523_TwoHours, 0); // Un-comment to cancel previous calibration
+  // Alternatively, measure the drift against a reference clock and let the library pick the offset and mode:
+  // RTC_Micros reference; // or any other reference clock
+  // rtc.calibrate(measureDrift(rtc, reference, 86400)); // returns the new offset, rtc.readOffsetMode() the mode
 
   Serial.print("Offset is "); Serial.println(offset); // Print to control offset
 
@@ -0,0 +1,73 @@
+/*
+  Helpers shared by the host checks and benchmarks in extras/host; see
+  extras/run_checks.sh.
+*/
+
+#ifndef _RTCLIB_HARNESS_H_
+#define _RTCLIB_HARNESS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int checkFailures = 0; ///< Number of failed checks so far
+
+/** Store benchmark results here so the compiler cannot drop the work */
+static volatile uint32_t benchSink;
+
+/** Report and count a failed condition, without stopping */
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      checkFailures++;                                                         \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);          \
+    }                                                                          \
+  } while (0)
+
+/**************************************************************************/
+/*!
+    @brief  Print the outcome of the checks
+    @return Exit status for main(): 0 if every check passed
+*/
+/**************************************************************************/
+static inline int checkResult() {
+  if (checkFailures) {
+    printf("FAILED: %d checks\n", checkFailures);
+    return 1;
+  }
+  printf("passed\n");
+  return 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the host monotonic clock, for benchmarks
+    @return Time in seconds
+*/
+/**************************************************************************/
+static inline double benchSeconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/** NVRAM in memory, losing the writes past a given number of bytes, as if
+    the power failed there */
+struct FakeNvram {
+  static const uint8_t NVRAM_SIZE = 56; ///< Size of the NVRAM, as a DS1307
+  uint8_t data[NVRAM_SIZE];             ///< Contents
+  long budget = -1;  ///< Bytes written before the power fails, -1 for never
+  long attempts = 0; ///< Bytes written or attempted so far
+
+  void readnvram(uint8_t *buf, uint8_t size, uint8_t address) {
+    memcpy(buf, data + address, size);
+  }
+  void writenvram(uint8_t address, const uint8_t *buf, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++, attempts++)
+      if (budget < 0 || attempts < budget)
+        data[address + i] = buf[i];
+  }
+};
+
+#endif // _RTCLIB_HARNESS_H_
@@ -0,0 +1,31 @@
+/*
+  Adafruit_I2CDevice on the simulated I2C bus of SimBus.h, with the same
+  interface as the one of Adafruit BusIO.
+*/
+
+#ifndef _SIM_ADAFRUIT_I2CDEVICE_H_
+#define _SIM_ADAFRUIT_I2CDEVICE_H_
+
+#include "Arduino.h"
+#include "Wire.h"
+
+/** I2C device at a given address of the simulated bus */
+class Adafruit_I2CDevice {
+public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire = &Wire);
+  uint8_t address(void) { return addr; }
+  bool begin(bool addr_detect = true);
+  bool detected(void);
+  bool read(uint8_t *buffer, size_t len, bool stop = true);
+  bool write(const uint8_t *buffer, size_t len, bool stop = true,
+             const uint8_t *prefix_buffer = NULL, size_t prefix_len = 0);
+  bool write_then_read(const uint8_t *write_buffer, size_t write_len,
+                       uint8_t *read_buffer, size_t read_len,
+                       bool stop = false);
+  size_t maxBufferSize();
+
+private:
+  uint8_t addr;
+};
+
+#endif // _SIM_ADAFRUIT_I2CDEVICE_H_
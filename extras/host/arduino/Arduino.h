@@ -0,0 +1,45 @@
+/*
+  Minimal Arduino core for the simulated builds of RTClib on a Linux host.
+  Time only advances in simulation: through delay(), and by the duration of
+  each transfer on the simulated I2C bus (SimBus.h).
+*/
+
+#ifndef _SIM_ARDUINO_H_
+#define _SIM_ARDUINO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+typedef bool boolean;
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+#define F(string_literal)                                                      \
+  (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+/** Just enough of the Arduino String class for DateTime::timestamp() */
+class String {
+public:
+  String(const char *s = "") : s(s) {}
+  const char *c_str() const { return s.c_str(); }
+  bool operator==(const char *right) const { return s == right; }
+
+private:
+  std::string s;
+};
+
+extern uint64_t simNanos; ///< Simulated time since boot, in nanoseconds
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+#endif // _SIM_ARDUINO_H_
@@ -0,0 +1,586 @@
+/*
+  Simulated Arduino core, I2C bus and RTC chip models; see SimBus.h.
+*/
+
+#include "SimBus.h"
+#include "RTClib.h"
+
+uint64_t simNanos = 0;
+uint32_t simBusHz = 100000;
+size_t simBufferSize = 32;
+uint32_t simTransfers = 0;
+uint32_t simBytes = 0;
+TwoWire Wire;
+
+static SimDevice *devices[128]; ///< Devices on the bus, by address
+
+uint32_t millis() { return simNanos / 1000000; }
+uint32_t micros() { return simNanos / 1000; }
+void delay(uint32_t ms) { simNanos += ms * 1000000ULL; }
+
+static uint8_t bin2bcd(uint8_t val) { return val + 6 * (val / 10); }
+static uint8_t bcd2bin(uint8_t val) { return val - 6 * (val >> 4); }
+
+/**************************************************************************/
+/*!
+    @brief  Start a transfer: bring the device up to date and account for
+    the time the bytes take on the bus
+    @param dev Addressed device
+    @param bytes Number of bytes after the address byte
+*/
+/**************************************************************************/
+static void startTransfer(SimDevice *dev, size_t bytes) {
+  dev->sync();
+  simBytes += bytes;
+  if (simBusHz)
+    simNanos += (bytes + 1) * 9 * 1000000000ULL / simBusHz;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write bytes to a device, the first one being the register address
+*/
+/**************************************************************************/
+static void writeBytes(SimDevice *dev, const uint8_t *prefix,
+                       size_t prefix_len, const uint8_t *buffer, size_t len) {
+  startTransfer(dev, prefix_len + len);
+  for (size_t i = 0; i < prefix_len + len; i++) {
+    uint8_t b = i < prefix_len ? prefix[i] : buffer[i - prefix_len];
+    if (i == 0) {
+      dev->pointer = b;
+    } else {
+      dev->written[dev->pointer] = b;
+      dev->writeRegister(dev->pointer, b);
+      dev->pointer = (dev->pointer + 1) % dev->size;
+    }
+  }
+  dev->endWrite();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read bytes from a device, in chunks of the Wire buffer size
+*/
+/**************************************************************************/
+static void readBytes(SimDevice *dev, uint8_t *buffer, size_t len) {
+  for (size_t pos = 0; pos < len;) {
+    size_t n = len - pos < simBufferSize ? len - pos : simBufferSize;
+    if (pos > 0) { // each further chunk is a transfer of its own
+      dev->transfers++;
+      simTransfers++;
+    }
+    startTransfer(dev, n);
+    for (size_t i = 0; i < n; i++) {
+      buffer[pos++] = dev->readRegister(dev->pointer);
+      dev->pointer = (dev->pointer + 1) % dev->size;
+    }
+  }
+}
+
+Adafruit_I2CDevice::Adafruit_I2CDevice(uint8_t addr, TwoWire *theWire)
+    : addr(addr) {
+  (void)theWire;
+}
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  return !addr_detect || detected();
+}
+
+bool Adafruit_I2CDevice::detected(void) { return devices[addr & 0x7F]; }
+
+bool Adafruit_I2CDevice::read(uint8_t *buffer, size_t len, bool stop) {
+  (void)stop;
+  SimDevice *dev = devices[addr & 0x7F];
+  if (!dev)
+    return false;
+  dev->transfers++;
+  simTransfers++;
+  readBytes(dev, buffer, len);
+  return true;
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t *buffer, size_t len, bool stop,
+                               const uint8_t *prefix_buffer,
+                               size_t prefix_len) {
+  (void)stop;
+  SimDevice *dev = devices[addr & 0x7F];
+  if (!dev || len + prefix_len > simBufferSize)
+    return false;
+  dev->transfers++;
+  simTransfers++;
+  writeBytes(dev, prefix_buffer, prefix_len, buffer, len);
+  return true;
+}
+
+bool Adafruit_I2CDevice::write_then_read(const uint8_t *write_buffer,
+                                         size_t write_len, uint8_t *read_buffer,
+                                         size_t read_len, bool stop) {
+  (void)stop;
+  SimDevice *dev = devices[addr & 0x7F];
+  if (!dev || write_len > simBufferSize)
+    return false;
+  // one transfer, with a repeated start between the two directions
+  dev->transfers++;
+  simTransfers++;
+  writeBytes(dev, NULL, 0, write_buffer, write_len);
+  readBytes(dev, read_buffer, read_len);
+  return true;
+}
+
+size_t Adafruit_I2CDevice::maxBufferSize() { return simBufferSize; }
+
+SimDevice::SimDevice(uint8_t address, uint16_t size)
+    : address(address), size(size) {
+  memset(regs, 0, sizeof(regs));
+  memset(written, 0, sizeof(written));
+  devices[address & 0x7F] = this;
+}
+
+SimDevice::~SimDevice() {
+  if (devices[address & 0x7F] == this)
+    devices[address & 0x7F] = NULL;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read a register without the side effects of a bus read
+    @param reg Register address
+    @return Register value at the current simulated time
+*/
+/**************************************************************************/
+uint8_t SimDevice::peek(uint8_t reg) {
+  sync();
+  return regs[reg];
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set a register directly, e.g. to raise a flag
+    @param reg Register address
+    @param value New value
+*/
+/**************************************************************************/
+void SimDevice::poke(uint8_t reg, uint8_t value) {
+  sync();
+  regs[reg] = value;
+}
+
+SimRtc::SimRtc(uint8_t address, uint16_t size, uint8_t timeReg,
+               bool dayFirst, bool century)
+    : SimDevice(address, size), syncedNanos(simNanos), timeReg(timeReg),
+      dayFirst(dayFirst), century(century) {
+  encode();
+  resetWeekday();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the time of the chip, as if by a write to its registers
+    @param unixtime New time
+*/
+/**************************************************************************/
+void SimRtc::setTime(int64_t unixtime) {
+  sync();
+  seconds = unixtime;
+  fraction = 0;
+  regs[timeReg] = 0; // the drivers write CH, OS or VL as 0
+  encode();
+  resetWeekday();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the time of the chip
+    @return Unix time of the current second
+*/
+/**************************************************************************/
+int64_t SimRtc::time() {
+  sync();
+  return seconds;
+}
+
+void SimRtc::sync() {
+  double elapsed = (simNanos - syncedNanos) * 1e-9 * rate();
+  syncedNanos = simNanos;
+  chipSeconds += elapsed;
+  fraction += elapsed;
+  while (fraction >= 1) {
+    fraction -= 1;
+    seconds++;
+    encode();
+    if (seconds % SECONDS_PER_DAY == 0) {
+      // the weekday counts on from the value written, right or wrong
+      uint8_t &weekday = regs[timeReg + (dayFirst ? 4 : 3)];
+      weekday = dayFirst ? (weekday + 1) % 7 : weekday % 7 + 1;
+    }
+    tick();
+  }
+  elapse(chipSeconds);
+}
+
+void SimRtc::writeRegister(uint8_t reg, uint8_t value) {
+  if (reg >= timeReg && reg < timeReg + 7)
+    timeWritten = true;
+  regs[reg] = value;
+}
+
+void SimRtc::endWrite() {
+  if (!timeWritten)
+    return;
+  // writing the time restarts the current second
+  timeWritten = false;
+  decode();
+  fraction = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the weekday register from the time: 0 (Sunday) to 6 on the
+    PCF chips, 1 (Monday) to 7 on the others, as written by the drivers
+*/
+/**************************************************************************/
+void SimRtc::resetWeekday() {
+  uint8_t dow = DateTime64(seconds).dayOfTheWeek();
+  regs[timeReg + (dayFirst ? 4 : 3)] = dayFirst || dow ? dow : 7;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Match the alarm registers of the PCF chips against the time
+    @param alarm Minute, hour, day and weekday alarm registers, bit 7 set
+    leaving a field out
+    @return True if a field is enabled and all the enabled ones match
+*/
+/**************************************************************************/
+bool SimRtc::alarmMatches(const uint8_t *alarm) const {
+  static const uint8_t masks[4] = {0x7F, 0x3F, 0x3F, 0x07};
+  const uint8_t *t = regs + timeReg;
+  bool enabled = false, match = true;
+  for (uint8_t i = 0; i < 4; i++) {
+    if (alarm[i] & 0x80)
+      continue;
+    enabled = true;
+    match &= (alarm[i] & masks[i]) == t[i + 1];
+  }
+  return enabled && match;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Update the time registers from the time, but the weekday
+*/
+/**************************************************************************/
+void SimRtc::encode() {
+  DateTime64 dt(seconds);
+  uint8_t *t = regs + timeReg;
+  t[0] = (t[0] & 0x80) | bin2bcd(dt.second()); // keep CH, OS or VL
+  t[1] = bin2bcd(dt.minute());
+  t[2] = bin2bcd(dt.hour());
+  t[dayFirst ? 3 : 4] = bin2bcd(dt.day());
+  t[5] = bin2bcd(dt.month()) | (century && dt.year() >= 2100 ? 0x80 : 0);
+  t[6] = bin2bcd(dt.year() % 100);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Update the time from the time registers
+*/
+/**************************************************************************/
+void SimRtc::decode() {
+  const uint8_t *t = regs + timeReg;
+  uint16_t year =
+      2000 + bcd2bin(t[6]) + (century && (t[5] & 0x80) ? 100 : 0);
+  DateTime64 dt(year, bcd2bin(t[5] & 0x1F), bcd2bin(t[dayFirst ? 3 : 4] & 0x3F),
+                bcd2bin(t[2] & 0x3F), bcd2bin(t[1] & 0x7F),
+                bcd2bin(t[0] & 0x7F));
+  if (dt.isValid())
+    seconds = dt.unixtime();
+}
+
+SimDs1307::SimDs1307() : SimRtc(0x68, 0x40, 0x00, false, false) {
+  regs[0x00] = 0x80; // CH: halted until the time is set
+}
+
+double SimDs1307::rate() { return regs[0x00] & 0x80 ? 0 : SimRtc::rate(); }
+
+SimDs3231::SimDs3231(bool sram)
+    : SimRtc(0x68, sram ? 0x100 : 0x13, 0x00, false, true) {
+  regs[0x0E] = 0x1C; // INTCN, RS2, RS1
+  regs[0x0F] = 0x88; // OSF, EN32kHz
+  regs[0x11] = temperature >> 2;
+  regs[0x12] = (temperature & 3) << 6;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the temperature seen by the sensor. The temperature
+    registers follow at the end of the next conversion.
+    @param quarters Temperature in quarter degrees
+*/
+/**************************************************************************/
+void SimDs3231::setTemperature(int16_t quarters) { temperature = quarters; }
+
+void SimDs3231::tick() {
+  // Alarm 1: A1Mx set (bit 7) leaves a field out, DY/DT picks the weekday
+  const uint8_t *a = regs + 0x07;
+  if ((a[0] & 0x80 || (a[0] & 0x7F) == regs[0x00]) &&
+      (a[1] & 0x80 || (a[1] & 0x7F) == regs[0x01]) &&
+      (a[2] & 0x80 || (a[2] & 0x3F) == regs[0x02]) &&
+      (a[3] & 0x80 || (a[3] & 0x40 ? (a[3] & 0x0F) == regs[0x03]
+                                     : (a[3] & 0x3F) == regs[0x04])))
+    regs[0x0F] |= 0x01;
+  // Alarm 2: the same, at second 0
+  a = regs + 0x0B;
+  if (regs[0x00] == 0 && (a[0] & 0x80 || (a[0] & 0x7F) == regs[0x01]) &&
+      (a[1] & 0x80 || (a[1] & 0x3F) == regs[0x02]) &&
+      (a[2] & 0x80 || (a[2] & 0x40 ? (a[2] & 0x0F) == regs[0x03]
+                                     : (a[2] & 0x3F) == regs[0x04])))
+    regs[0x0F] |= 0x02;
+}
+
+void SimDs3231::sync() {
+  SimRtc::sync();
+  if (conversionEnd && simNanos >= conversionEnd) {
+    conversionEnd = 0;
+    regs[0x11] = temperature >> 2;
+    regs[0x12] = (temperature & 3) << 6;
+    regs[0x0E] &= ~0x20; // CONV
+    regs[0x0F] &= ~0x04; // BSY
+  }
+}
+
+void SimDs3231::writeRegister(uint8_t reg, uint8_t value) {
+  switch (reg) {
+  case 0x0E: // control: CONV starts a conversion taking 125 ms
+    if ((value & 0x20) && !conversionEnd) {
+      conversionEnd = simNanos + 125000000;
+      regs[0x0F] |= 0x04;
+    }
+    regs[reg] = value;
+    break;
+  case 0x0F: // status: OSF, A2F and A1F are cleared by writing 0; BSY is
+             // read-only
+    regs[reg] = (regs[reg] & value & 0x83) | (value & 0x08) |
+                (regs[reg] & 0x04);
+    break;
+  case 0x11: // temperature, read-only
+  case 0x12:
+    break;
+  default:
+    SimRtc::writeRegister(reg, value);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Start the timer, or restart it after a new value is loaded
+    @param now Oscillator time, in seconds
+    @param hz Source clock frequency
+    @param origin Oscillator time of an edge of the source clock, up to now:
+    the first period ends at the next edge
+*/
+/**************************************************************************/
+void SimTimer::start(double now, double hz, double origin) {
+  running = true;
+  this->hz = hz;
+  this->origin = origin;
+  counted = (uint64_t)((now - origin) * hz + 1e-6);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Count the source clock periods elapsed since the last call
+    @param now Oscillator time, in seconds
+    @param[in,out] value Timer register, counted down
+    @param repeat Reload at zero, or else stop there as a watchdog does
+    @return Number of times the timer reached zero
+*/
+/**************************************************************************/
+uint32_t SimTimer::advance(double now, uint8_t &value, bool repeat) {
+  if (!running)
+    return 0;
+  uint64_t edges = (uint64_t)((now - origin) * hz + 1e-6);
+  uint64_t periods = edges - counted;
+  counted = edges;
+  if (periods == 0 || value == 0)
+    return 0;
+  if (periods < value) {
+    value -= periods;
+    return 0;
+  }
+  periods -= value;
+  if (!repeat || reload == 0) {
+    value = 0;
+    running = repeat;
+    return 1;
+  }
+  value = reload - periods % reload;
+  return 1 + periods / reload;
+}
+
+static const double pcf8563Hz[4] = {4096, 64, 1, 1 / 60.0}; ///< By TD
+
+SimPcf8563::SimPcf8563() : SimRtc(0x51, 0x10, 0x02, true, true) {
+  regs[0x00] = 0x08;  // TESTC
+  regs[0x02] |= 0x80; // VL: the time is not guaranteed until set
+  memset(regs + 0x09, 0x80, 4);
+  regs[0x0D] = 0x80; // CLKOUT at 32.768 kHz
+  regs[0x0E] = 0x03; // timer stopped, on the 1/60 Hz clock
+}
+
+double SimPcf8563::rate() { return regs[0x00] & 0x20 ? 0 : SimRtc::rate(); }
+
+void SimPcf8563::tick() {
+  if ((regs[0x02] & 0x7F) == 0 && alarmMatches(regs + 0x09))
+    regs[0x01] |= 0x08; // AF
+}
+
+void SimPcf8563::elapse(double now) {
+  if (timer.advance(now, regs[0x0F], true))
+    regs[0x01] |= 0x04; // TF
+}
+
+void SimPcf8563::writeRegister(uint8_t reg, uint8_t value) {
+  switch (reg) {
+  case 0x01: // Control_2: AF and TF are cleared by writing 0, bits 7-5 are 0
+    regs[reg] = (value & 0x13) | (regs[reg] & value & 0x0C);
+    break;
+  case 0x0E: // timer control: TE starts the timer, TD picks the clock
+    if (!(value & 0x80)) {
+      timer.running = false;
+    } else if (!timer.running || (value & 0x03) != (regs[reg] & 0x03)) {
+      regs[0x0F] = timer.reload;
+      timer.start(chipSeconds, pcf8563Hz[value & 0x03], chipSeconds);
+    }
+    regs[reg] = value & 0x83;
+    break;
+  case 0x0F: // timer value, loaded at once
+    regs[reg] = value;
+    timer.reload = value;
+    if (timer.running)
+      timer.start(chipSeconds, pcf8563Hz[regs[0x0E] & 0x03], chipSeconds);
+    break;
+  default:
+    SimRtc::writeRegister(reg, value);
+  }
+}
+
+/** Frequency of a PCF8523 timer source clock, from TAQ or TBQ */
+static double pcf8523Hz(uint8_t clock) {
+  static const double hz[4] = {4096, 64, 1, 1 / 60.0};
+  clock &= 0x07;
+  return clock < 4 ? hz[clock] : 1 / 3600.0;
+}
+
+SimPcf8523::SimPcf8523() : SimRtc(0x68, 0x14, 0x03, true, false) {
+  regs[0x02] = 0xE0;  // switchover disabled, no battery low detection
+  regs[0x03] |= 0x80; // OS: the oscillator has stopped
+  memset(regs + 0x0A, 0x80, 4);
+  regs[0x10] = 0x07; // Timer A and B on the 1/3600 Hz clock
+  regs[0x12] = 0x07;
+}
+
+double SimPcf8523::rate() {
+  if (regs[0x00] & 0x20) // STOP
+    return 0;
+  // the offset slows the clock down by offset units
+  int8_t offset = (int8_t)(regs[0x0E] << 1) >> 1;
+  int32_t unit = regs[0x0E] & 0x80 ? 4069 : 4340;
+  return SimRtc::rate() * (1 - offset * unit * 1e-9);
+}
+
+void SimPcf8523::tick() {
+  if ((regs[0x03] & 0x7F) == 0 && alarmMatches(regs + 0x0A))
+    regs[0x01] |= 0x08; // AF
+  if (regs[0x00] & 0x04) // SIE
+    regs[0x01] |= 0x10; // SF
+}
+
+void SimPcf8523::elapse(double now) {
+  uint8_t mode = regs[0x0F] >> 1 & 0x03; // TAC: 1 countdown, 2 watchdog
+  if (timerA.advance(now, regs[0x11], mode == 1))
+    regs[0x01] |= mode == 1 ? 0x40 : 0x80; // CTAF or WTAF
+  if (timerB.advance(now, regs[0x13], true))
+    regs[0x01] |= 0x20; // CTBF
+}
+
+/**************************************************************************/
+/*!
+    @brief  Start a timer, or restart it after a new value is loaded
+    @details The 1 Hz, 1/60 Hz and 1/3600 Hz clocks tick with the seconds,
+    minutes and hours of the time counter, and keep running, so the first
+    period ends at the next tick. The faster clocks are taken to start with
+    the timer.
+    @param timer Timer A or Timer B
+    @param clock Source clock, from TAQ or TBQ
+*/
+/**************************************************************************/
+void SimPcf8523::startTimer(SimTimer &timer, uint8_t clock) {
+  double hz = pcf8523Hz(clock), origin = chipSeconds;
+  if (hz <= 1)
+    origin -= fraction + seconds % (int64_t)(1 / hz + 0.5);
+  timer.start(chipSeconds, hz, origin);
+}
+
+uint8_t SimPcf8523::readRegister(uint8_t reg) {
+  uint8_t value = regs[reg];
+  if (reg == 0x01) // reading Control_2 clears WTAF
+    regs[reg] &= ~0x80;
+  return value;
+}
+
+void SimPcf8523::writeRegister(uint8_t reg, uint8_t value) {
+  uint8_t previous = regs[reg];
+  switch (reg) {
+  case 0x01: // Control_2: CTAF, CTBF, SF and AF are cleared by writing 0,
+             // WTAF is read-only
+    regs[reg] = (value & 0x07) | (previous & value & 0x78) | (previous & 0x80);
+    break;
+  case 0x02: // Control_3: BSF is cleared by writing 0, BLF is read-only
+    regs[reg] = (value & 0xE3) | (previous & value & 0x08) | (previous & 0x04);
+    break;
+  case 0x0F: // Timer and CLKOUT control: TAC and TBC start the timers
+    regs[reg] = value;
+    if (!(value & 0x06)) {
+      timerA.running = false;
+    } else if ((value ^ previous) & 0x06) {
+      regs[0x11] = timerA.reload;
+      startTimer(timerA, regs[0x10]);
+    }
+    if (!(value & 0x01)) {
+      timerB.running = false;
+    } else if (!(previous & 0x01)) {
+      regs[0x13] = timerB.reload;
+      startTimer(timerB, regs[0x12]);
+    }
+    break;
+  case 0x10: // Timer A clock
+    regs[reg] = value & 0x07;
+    if (timerA.running) {
+      regs[0x11] = timerA.reload;
+      startTimer(timerA, value);
+    }
+    break;
+  case 0x11: // Timer A value, also feeding the watchdog
+    regs[reg] = value;
+    timerA.reload = value;
+    if (regs[0x0F] & 0x06)
+      startTimer(timerA, regs[0x10]);
+    break;
+  case 0x12: // Timer B clock and pulse width
+    regs[reg] = value & 0x77;
+    if (timerB.running) {
+      regs[0x13] = timerB.reload;
+      startTimer(timerB, value);
+    }
+    break;
+  case 0x13: // Timer B value
+    regs[reg] = value;
+    timerB.reload = value;
+    if (timerB.running)
+      startTimer(timerB, regs[0x12]);
+    break;
+  default:
+    SimRtc::writeRegister(reg, value);
+  }
+}
@@ -0,0 +1,161 @@
+/*
+  Simulated I2C bus and register-level models of the RTC chips, for the
+  sim_*.cpp programs in extras/host.
+
+  A model attaches itself to the bus at the address of its chip when it is
+  created. Each transfer costs the time the bytes take at simBusHz, so that
+  bus traffic shows up in the simulated time. The clock of a model runs at
+  1 + driftPpb * 1e-9 times the simulated time, and its registers follow
+  the datasheet as far as the drivers rely on them: the flags that are
+  cleared by writing 0 and left unchanged by writing 1, the read-only bits
+  and the register pointer wrapping. The countdown timers of the PCF8563
+  count whole periods of their source clock from the moment they are
+  started or loaded, the chip itself may cut the first period short. On the
+  PCF8523, the 1 Hz, 1/60 Hz and 1/3600 Hz clocks tick with the time
+  counter, so that the first period is as short as the datasheet allows.
+*/
+
+#ifndef _SIM_BUS_H_
+#define _SIM_BUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern uint32_t simBusHz;      ///< SCL clock; 0 makes transfers take no time
+extern size_t simBufferSize;   ///< Size of the Wire buffer, 32 by default
+extern uint32_t simTransfers;  ///< Number of transfers on the bus so far
+extern uint32_t simBytes;      ///< Number of bytes moved on the bus so far
+
+/** A device on the simulated bus: a plain register file */
+class SimDevice {
+public:
+  SimDevice(uint8_t address, uint16_t size);
+  virtual ~SimDevice();
+  uint8_t peek(uint8_t reg);
+  void poke(uint8_t reg, uint8_t value);
+
+  uint8_t regs[256];      ///< Register file
+  uint8_t written[256];   ///< Last value written to each register
+  uint32_t transfers = 0; ///< Number of transfers addressed to the device
+
+  /** Bring the device up to the current simulated time */
+  virtual void sync() {}
+  /** Read a register from the bus, with the side effects of a read */
+  virtual uint8_t readRegister(uint8_t reg) { return regs[reg]; }
+  /** Write a register from the bus */
+  virtual void writeRegister(uint8_t reg, uint8_t value) { regs[reg] = value; }
+  /** Called at the end of each write transfer */
+  virtual void endWrite() {}
+
+  uint8_t address;     ///< Bus address
+  uint16_t size;       ///< Number of registers; the pointer wraps to 0 there
+  uint8_t pointer = 0; ///< Register pointer
+};
+
+/** Common time keeping of the RTC models */
+class SimRtc : public SimDevice {
+public:
+  SimRtc(uint8_t address, uint16_t size, uint8_t timeReg, bool dayFirst,
+         bool century);
+  void setTime(int64_t unixtime);
+  int64_t time();
+
+  int32_t driftPpb = 0; ///< Oscillator error, positive if running fast
+
+  void sync() override;
+  void writeRegister(uint8_t reg, uint8_t value) override;
+  void endWrite() override;
+
+protected:
+  /** Oscillator rate relative to the simulated time */
+  virtual double rate() { return 1 + driftPpb * 1e-9; }
+  /** Called at each new second, after the time registers are updated */
+  virtual void tick() {}
+  /** Called after each sync, with the oscillator time in seconds */
+  virtual void elapse(double now) { (void)now; }
+  void encode();
+  void decode();
+  void resetWeekday();
+  bool alarmMatches(const uint8_t *alarm) const;
+
+  int64_t seconds = 946684800; ///< Time of the last whole second
+  double fraction = 0;         ///< Seconds since the last whole second
+  double chipSeconds = 0;      ///< Oscillator time since power-up, in seconds
+  uint64_t syncedNanos = 0;    ///< Simulated time of the last sync
+  uint8_t timeReg;             ///< Address of the seconds register
+  bool dayFirst;               ///< Day of the month before the weekday
+  bool century;                ///< Bit 7 of the month is a century bit
+  bool timeWritten = false;    ///< A time register was written
+};
+
+/** DS1307, with its 56 bytes of RAM (0x08 to 0x3F) */
+class SimDs1307 : public SimRtc {
+public:
+  SimDs1307();
+
+protected:
+  double rate() override; // CH stops the oscillator
+};
+
+/** DS3231, or DS3232 with its SRAM (0x14 to 0xFF) when `sram` is set */
+class SimDs3231 : public SimRtc {
+public:
+  SimDs3231(bool sram = false);
+  void setTemperature(int16_t quarters);
+
+  void sync() override;
+  void writeRegister(uint8_t reg, uint8_t value) override;
+
+protected:
+  void tick() override;
+  int16_t temperature = 100;  ///< Sensor temperature, in quarter degrees
+  uint64_t conversionEnd = 0; ///< Simulated time a conversion ends
+};
+
+/** Countdown timer of the PCF chips, on oscillator time */
+class SimTimer {
+public:
+  void start(double now, double hz, double origin);
+  uint32_t advance(double now, uint8_t &value, bool repeat);
+
+  bool running = false; ///< Counting down
+  uint8_t reload = 0;   ///< Value loaded at start, and at each reload
+
+protected:
+  double hz = 1;        ///< Source clock frequency
+  double origin = 0;    ///< Oscillator time of a source clock edge
+  uint64_t counted = 0; ///< Source clock edges since the origin, counted
+};
+
+/** PCF8563, with its alarm and countdown timer */
+class SimPcf8563 : public SimRtc {
+public:
+  SimPcf8563();
+
+  void writeRegister(uint8_t reg, uint8_t value) override;
+
+protected:
+  double rate() override; // STOP stops the oscillator
+  void tick() override;
+  void elapse(double now) override;
+  SimTimer timer; ///< Countdown timer
+};
+
+/** PCF8523, with its alarm, second timer, Timer A, Timer B and offset */
+class SimPcf8523 : public SimRtc {
+public:
+  SimPcf8523();
+
+  uint8_t readRegister(uint8_t reg) override;
+  void writeRegister(uint8_t reg, uint8_t value) override;
+
+protected:
+  double rate() override; // STOP, and the offset register
+  void tick() override;
+  void elapse(double now) override;
+  void startTimer(SimTimer &timer, uint8_t clock);
+  SimTimer timerA; ///< Timer A, countdown or watchdog
+  SimTimer timerB; ///< Timer B, countdown
+};
+
+#endif // _SIM_BUS_H_
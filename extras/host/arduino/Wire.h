@@ -0,0 +1,14 @@
+/*
+  Placeholder for the Arduino Wire library: the simulated bus is reached
+  through Adafruit_I2CDevice.h.
+*/
+
+#ifndef _SIM_WIRE_H_
+#define _SIM_WIRE_H_
+
+/** I2C bus handle, only passed around by the drivers */
+class TwoWire {};
+
+extern TwoWire Wire;
+
+#endif // _SIM_WIRE_H_
@@ -0,0 +1,106 @@
+/*
+  Batch conversions between Unix times and calendar fields, toFields() and
+  fromFields(), against the scalar DateTime constructors and glibc
+  gmtime_r()/timegm(). Every day from 2000 to 2099 is checked against
+  glibc first. GCC vectorises the batch loops at -O3 only, e.g.
+  CXXFLAGS="-std=gnu++11 -O3" extras/run_checks.sh bench_civil
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define COUNT (1L << 20) ///< Timestamps converted per pass
+#define ROUNDS 10        ///< Passes timed per function
+
+static uint32_t times[COUNT], back[COUNT];
+static uint16_t year[COUNT];
+static uint8_t month[COUNT], day[COUNT], hour[COUNT], minute[COUNT],
+    second[COUNT], dow[COUNT];
+static const DateTimeFields fields = {year,   month,  day, hour,
+                                      minute, second, dow};
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/** Print the time per element of ROUNDS passes, from a start time */
+static void report(const char *name, double start) {
+  printf("%-28s %5.1f ns/element\n", name,
+         (benchSeconds() - start) * 1e9 / ((double)ROUNDS * COUNT));
+}
+
+int main() {
+  // every day of 2000-2099, at a varying time of day
+  const long days = 36525;
+  for (long i = 0; i < COUNT; i++)
+    times[i] = SECONDS_FROM_1970_TO_2000 + (i % days) * 86400 +
+               random32() % 86400;
+  DateTime::toFields(times, fields, COUNT);
+  DateTime::fromFields(fields, back, COUNT);
+  for (long i = 0; i < days; i++) {
+    time_t t = times[i];
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    CHECK(year[i] == tm.tm_year + 1900 && month[i] == tm.tm_mon + 1 &&
+          day[i] == tm.tm_mday && hour[i] == tm.tm_hour &&
+          minute[i] == tm.tm_min && second[i] == tm.tm_sec &&
+          dow[i] == tm.tm_wday);
+    DateTime dt(times[i]);
+    CHECK(dt.year() == year[i] && dt.month() == month[i] &&
+          dt.day() == day[i] && dt.hour() == hour[i] &&
+          dt.minute() == minute[i] && dt.second() == second[i] &&
+          dt.dayOfTheWeek() == dow[i]);
+  }
+  CHECK(memcmp(times, back, sizeof(times)) == 0);
+
+  uint32_t sink = 0;
+  double t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (long i = 0; i < COUNT; i++) {
+      time_t unixtime = times[i];
+      struct tm tm;
+      gmtime_r(&unixtime, &tm);
+      sink += tm.tm_mday + tm.tm_sec;
+    }
+  report("gmtime_r()", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (long i = 0; i < COUNT; i++) {
+      DateTime dt(times[i]);
+      sink += dt.day() + dt.second();
+    }
+  report("DateTime(uint32_t)", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::toFields(times, fields, COUNT);
+  report("toFields()", t);
+
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (long i = 0; i < COUNT; i++) {
+      struct tm tm = {};
+      tm.tm_year = year[i] - 1900;
+      tm.tm_mon = month[i] - 1;
+      tm.tm_mday = day[i];
+      tm.tm_hour = hour[i];
+      tm.tm_min = minute[i];
+      tm.tm_sec = second[i];
+      sink += timegm(&tm);
+    }
+  report("timegm()", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (long i = 0; i < COUNT; i++)
+      sink += DateTime(year[i], month[i], day[i], hour[i], minute[i],
+                       second[i])
+                  .unixtime();
+  report("DateTime(y, m, d, ...)", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::fromFields(fields, back, COUNT);
+  report("fromFields()", t);
+  benchSink = sink + back[COUNT / 2];
+  return checkResult();
+}
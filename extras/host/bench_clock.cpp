@@ -0,0 +1,47 @@
+/*
+  Cost of now() and monotonic() of the Linux host backend of RTC_Micros
+  (RTC_Host.cpp), against bare clock_gettime() calls.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define CALLS 2000000L ///< Calls timed per function
+
+int main() {
+  RTC_Micros rtc;
+  rtc.begin();
+  int32_t skew = rtc.now().unixtime() - (uint32_t)time(NULL);
+  CHECK(skew >= -1 && skew <= 1);
+
+  // adjustDrift() only affects the time from now on: 0.3 s at 5x the rate
+  // would step the clock past the next second
+  struct timespec pause = {0, 300000000};
+  rtc.adjust(DateTime(2024, 1, 1));
+  nanosleep(&pause, NULL);
+  rtc.adjustDrift(4000000);
+  CHECK(rtc.now() == DateTime(2024, 1, 1));
+  rtc.adjustDrift(0);
+  rtc.begin();
+
+  struct timespec ts;
+  uint32_t sink = 0;
+  double t0 = benchSeconds();
+  for (long i = 0; i < CALLS; i++) {
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    sink += ts.tv_nsec;
+  }
+  double t1 = benchSeconds();
+  for (long i = 0; i < CALLS; i++)
+    sink += rtc.now().second();
+  double t2 = benchSeconds();
+  for (long i = 0; i < CALLS; i++)
+    sink += rtc.monotonic().microseconds();
+  double t3 = benchSeconds();
+  benchSink = sink;
+
+  printf("clock_gettime(): %5.1f ns/call\n", (t1 - t0) * 1e9 / CALLS);
+  printf("now():           %5.1f ns/call\n", (t2 - t1) * 1e9 / CALLS);
+  printf("monotonic():     %5.1f ns/call\n", (t3 - t2) * 1e9 / CALLS);
+  return checkResult();
+}
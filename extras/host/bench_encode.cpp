@@ -0,0 +1,123 @@
+/*
+  Throughput of the compact DateTime encodings (seconds, seconds plus
+  fraction, FAT and BCD), through the array overloads, and their round
+  trips over random times of 2000 to 2099.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define COUNT 4096 ///< Elements per array
+#define ROUNDS 500 ///< Passes timed per function
+
+static DateTime times[COUNT], decoded[COUNT];
+static uint8_t fractions[COUNT], fractionsOut[COUNT];
+static uint8_t bytes[7 * COUNT], seconds[4 * COUNT];
+static uint32_t fat[COUNT];
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/** Check the decoded times against the originals */
+static bool same(bool evenSeconds) {
+  for (uint16_t i = 0; i < COUNT; i++) {
+    uint32_t t = times[i].unixtime();
+    if (decoded[i].unixtime() != (evenSeconds ? t & ~1UL : t) ||
+        !decoded[i].isValid())
+      return false;
+  }
+  return true;
+}
+
+/** Print the time per element of ROUNDS passes, from a start time */
+static void report(const char *name, double start) {
+  printf("%-12s %5.1f ns/element\n", name,
+         (benchSeconds() - start) * 1e9 / ((double)ROUNDS * COUNT));
+}
+
+int main() {
+  // 2000-01-01 to 2099-12-31, seconds included, checked against gmtime()
+  for (uint16_t i = 0; i < COUNT; i++) {
+    uint32_t t = random32() % 3155760000UL;
+    for (uint8_t j = 0; j < 4; j++)
+      seconds[4 * i + j] = t >> (8 * j);
+    fractions[i] = random32();
+  }
+  DateTime(2000, 1, 1).encode32(seconds);
+  DateTime(2099, 12, 31, 23, 59, 59).encode32(seconds + 4);
+  DateTime(2024, 2, 29, 12, 0, 0).encode32(seconds + 8);
+  DateTime::decode32(seconds, times, COUNT);
+  for (uint16_t i = 0; i < COUNT; i++) {
+    time_t unixtime = times[i].unixtime();
+    struct tm tm;
+    gmtime_r(&unixtime, &tm);
+    CHECK(times[i].year() == tm.tm_year + 1900 &&
+          times[i].month() == tm.tm_mon + 1 && times[i].day() == tm.tm_mday &&
+          times[i].hour() == tm.tm_hour && times[i].minute() == tm.tm_min &&
+          times[i].second() == tm.tm_sec);
+  }
+  CHECK(times[1].unixtime() == 4102444799UL);
+
+  // Round trips, with the DS3231 weekday in the BCD registers
+  DateTime::encode32(times, bytes, COUNT);
+  CHECK(memcmp(bytes, seconds, 4 * COUNT) == 0);
+  DateTime::decode32(bytes, decoded, COUNT);
+  CHECK(same(false));
+  DateTime::encode40(times, fractions, bytes, COUNT);
+  DateTime::decode40(bytes, decoded, fractionsOut, COUNT);
+  CHECK(same(false));
+  CHECK(memcmp(fractions, fractionsOut, COUNT) == 0);
+  DateTime::encodeFat(times, fat, COUNT);
+  DateTime::decodeFat(fat, decoded, COUNT);
+  CHECK(same(true)); // FAT keeps seconds in 2 s units
+  DateTime::encodeBCD(times, bytes, COUNT);
+  DateTime::decodeBCD(bytes, decoded, COUNT);
+  CHECK(same(false));
+  for (uint16_t i = 0; i < COUNT; i++) {
+    uint8_t dow = times[i].dayOfTheWeek();
+    CHECK(bytes[7 * i + 3] == (dow ? dow : 7));
+  }
+  uint8_t fraction;
+  times[2].encode40(bytes, 0x80);
+  CHECK(DateTime::decode40(bytes, &fraction) == times[2] && fraction == 0x80);
+  CHECK(DateTime::decodeFat(times[2].encodeFat()) == times[2]);
+
+  double t;
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::encode32(times, bytes, COUNT);
+  report("encode32", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::decode32(bytes, decoded, COUNT);
+  report("decode32", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::encode40(times, fractions, bytes, COUNT);
+  report("encode40", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::decode40(bytes, decoded, fractionsOut, COUNT);
+  report("decode40", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::encodeFat(times, fat, COUNT);
+  report("encodeFat", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::decodeFat(fat, decoded, COUNT);
+  report("decodeFat", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::encodeBCD(times, bytes, COUNT);
+  report("encodeBCD", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    DateTime::decodeBCD(bytes, decoded, COUNT);
+  report("decodeBCD", t);
+  benchSink = bytes[COUNT] + fat[COUNT / 2] + decoded[COUNT - 1].second();
+  return checkResult();
+}
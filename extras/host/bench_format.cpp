@@ -0,0 +1,99 @@
+/*
+  Records per second of DateTimeFormat::format() against
+  DateTime::toString() called per record, on a log sampled every minute
+  and on random times. The output must match toString() for every record
+  and format.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define COUNT 100000 ///< Records per pass
+#define ROUNDS 20    ///< Passes timed per function
+
+static const char *formats[] = {
+    "YYYY-MM-DDThh:mm:ss",
+    "DD/MM/YY hh:mm AP",
+    "DDD, DD MMM YYYY hh:mm:ss",
+    "hh:mm:ss",
+};
+
+static uint32_t sorted[COUNT], shuffled[COUNT];
+static char out[COUNT * 32];
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compare format() with toString() record by record
+    @param spec Format
+    @param times Times to render
+    @return True if every record matches
+*/
+/**************************************************************************/
+static bool matches(const char *spec, const uint32_t *times) {
+  DateTimeFormat format;
+  if (!format.begin(spec))
+    return false;
+  size_t width = format.width();
+  if (format.format(times, COUNT, out, '\n') != COUNT * (width + 1))
+    return false;
+  for (size_t i = 0; i < COUNT; i++) {
+    char *record = out + i * (width + 1);
+    if (record[width] != '\n')
+      return false;
+    record[width] = 0;
+    char buffer[32];
+    strcpy(buffer, spec);
+    if (strcmp(DateTime(times[i]).toString(buffer), record) != 0)
+      return false;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Time format() and toString() on the first format
+    @param name Name of the input, for the report
+    @param times Times to render
+*/
+/**************************************************************************/
+static void bench(const char *name, const uint32_t *times) {
+  DateTimeFormat format;
+  format.begin(formats[0]);
+  double t0 = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    format.format(times, COUNT, out);
+  double t1 = benchSeconds();
+  uint32_t sink = 0;
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < COUNT; i++) {
+      char buffer[32];
+      strcpy(buffer, formats[0]);
+      sink += DateTime(times[i]).toString(buffer)[18];
+    }
+  double t2 = benchSeconds();
+  benchSink = sink + out[COUNT];
+  printf("%s: format() %5.1fM records/s, toString() %5.1fM records/s\n",
+         name, ROUNDS * COUNT / (t1 - t0) * 1e-6,
+         ROUNDS * COUNT / (t2 - t1) * 1e-6);
+}
+
+int main() {
+  for (size_t i = 0; i < COUNT; i++) {
+    sorted[i] = 1704067200 + 60 * i; // from 2024-01-01, every minute
+    shuffled[i] = SECONDS_FROM_1970_TO_2000 + random32() % 3155760000UL;
+  }
+  for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+    CHECK(matches(formats[i], sorted));
+    CHECK(matches(formats[i], shuffled));
+  }
+
+  bench("per minute", sorted);
+  bench("random    ", shuffled);
+  return checkResult();
+}
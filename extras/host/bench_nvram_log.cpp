@@ -0,0 +1,140 @@
+/*
+  Capacity and cost of RTC_NvramLog over the 236 bytes of a DS3232's SRAM,
+  held in RAM here: the records kept once the ring is full, for typical
+  sample cadences and payload sizes, then the time taken by append() and by
+  a full iteration of the records. Every log must read back the newest
+  records appended, in order, with their times.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define APPENDS 2000       ///< Records appended per log, enough to wrap it
+#define ROUNDS 200000      ///< Appends, or record reads, timed per log
+#define START 1704067200UL ///< 2024-01-01 00:00:00
+
+/** NVRAM of a DS3232, in RAM */
+struct Sram {
+  static const uint8_t NVRAM_SIZE = 236; ///< Size of the NVRAM, as a DS3232
+  uint8_t data[NVRAM_SIZE];              ///< Contents
+
+  void readnvram(uint8_t *buf, uint8_t size, uint8_t address) {
+    memcpy(buf, data + address, size);
+  }
+  void writenvram(uint8_t address, const uint8_t *buf, uint8_t size) {
+    memcpy(data + address, buf, size);
+  }
+};
+
+/**
+  Sample cadences: a period, and the jitter of each sample around it, in
+  seconds; a period of 0 draws every interval from 1 s to the jitter
+*/
+static const struct {
+  const char *name;
+  uint32_t period, jitter;
+} cadences[] = {{"1 s", 1, 0},           {"1 min", 60, 0},
+                {"15 min", 900, 0},      {"1 h", 3600, 0},
+                {"1 min +-2 s", 60, 2},  {"15 min +-30 s", 900, 30},
+                {"random 1 s-1 h", 0, 3600}};
+static const uint8_t payloads[] = {1, 2, 4, 8}; ///< Payload sizes, in bytes
+
+static uint32_t times[APPENDS];
+static Sram sram;
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/** Fill the times of the records with a cadence */
+static void fill(uint32_t period, uint32_t jitter) {
+  uint32_t time = START;
+  for (uint16_t i = 0; i < APPENDS; i++) {
+    if (period)
+      times[i] = START + i * period - jitter + random32() % (2 * jitter + 1);
+    else
+      times[i] = time += 1 + random32() % jitter;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Append APPENDS records and check the newest ones read back
+    @param log Log, started
+    @param payloadSize Size of a payload, in bytes
+    @return True if the log holds the newest records, in order
+*/
+/**************************************************************************/
+static bool logs(RTC_NvramLog<Sram> &log, uint8_t payloadSize) {
+  uint8_t payload[8];
+  for (uint16_t i = 0; i < APPENDS; i++) {
+    memset(payload, i, payloadSize);
+    log.append(times[i], payload);
+  }
+  uint16_t index = APPENDS - log.size();
+  uint32_t time;
+  log.rewind();
+  while (log.read(time, payload)) {
+    if (time != times[index] || payload[payloadSize - 1] != (uint8_t)index)
+      return false;
+    index++;
+  }
+  return index == APPENDS;
+}
+
+int main() {
+  RTC_NvramLog<Sram> log(sram);
+  printf("Records kept in %u bytes, %u of header, by payload size\n",
+         Sram::NVRAM_SIZE, NVRAMLOG_HEADER_SIZE);
+  printf("%-16s", "cadence");
+  for (uint8_t p = 0; p < sizeof(payloads); p++)
+    printf(" %4u B", payloads[p]);
+  printf("\n");
+  for (uint8_t c = 0; c < sizeof(cadences) / sizeof(cadences[0]); c++) {
+    fill(cadences[c].period, cadences[c].jitter);
+    printf("%-16s", cadences[c].name);
+    for (uint8_t p = 0; p < sizeof(payloads); p++) {
+      memset(sram.data, 0, sizeof(sram.data));
+      CHECK(log.begin(payloads[p]));
+      CHECK(logs(log, payloads[p]));
+      printf(" %6u", log.size());
+    }
+    printf("\n");
+  }
+  // a plain 4-byte timestamp would leave 212 / (4 + payload) records
+  printf("%-16s", "4-byte stamps");
+  for (uint8_t p = 0; p < sizeof(payloads); p++)
+    printf(" %6u",
+           (Sram::NVRAM_SIZE - NVRAMLOG_HEADER_SIZE) / (4 + payloads[p]));
+  printf("\n\n");
+
+  // cost on a full ring, at 1 min +-2 s with a 2-byte payload
+  fill(60, 2);
+  memset(sram.data, 0, sizeof(sram.data));
+  CHECK(log.begin(2));
+  CHECK(logs(log, 2));
+  uint8_t payload[2] = {0, 0};
+  uint32_t time = times[APPENDS - 1];
+  double t = benchSeconds();
+  for (long r = 0; r < ROUNDS; r++) {
+    time += 58 + r % 5;
+    log.append(time, payload);
+  }
+  printf("append()        %6.1f ns/record\n",
+         (benchSeconds() - t) * 1e9 / ROUNDS);
+  uint32_t sink = 0;
+  long passes = ROUNDS / log.size();
+  t = benchSeconds();
+  for (long r = 0; r < passes; r++) {
+    log.rewind();
+    while (log.read(time, payload))
+      sink += time + payload[0];
+  }
+  double pass = (benchSeconds() - t) * 1e9 / passes;
+  printf("iteration       %6.0f ns/pass of %u records, %.1f ns/record\n",
+         pass, log.size(), pass / log.size());
+  benchSink = sink;
+  return checkResult();
+}
@@ -0,0 +1,195 @@
+/*
+  CompiledTimeZone, on the tables tzcompile.py generates from the local
+  tzdata, against glibc reading the same zones: the offset and DST flag
+  must match localtime_r() every two hours from 2000 to 2099, and to the
+  second around every transition, and toUTC() must invert toLocal().
+  Then lookups per second of CompiledTimeZone, TimeZone on the POSIX rule
+  and localtime_r(), on a log sampled every minute and on random times,
+  and the PROGMEM size of each table.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+#include "zones.h"
+#include <stdlib.h>
+
+/** A zone of the generated tables */
+struct Zone {
+  const char *name;     ///< tzdata name
+  const TzTable *table; ///< Generated table
+};
+
+static const Zone zones[] = {
+    {"Europe/Paris", &tz_Europe_Paris},
+    {"America/New_York", &tz_America_New_York},
+    {"Australia/Lord_Howe", &tz_Australia_Lord_Howe},
+    {"Africa/Casablanca", &tz_Africa_Casablanca},
+    {"America/Nuuk", &tz_America_Nuuk},
+    {"Asia/Tehran", &tz_Asia_Tehran},
+    {"Pacific/Chatham", &tz_Pacific_Chatham},
+    {"Europe/Dublin", &tz_Europe_Dublin},
+};
+
+#define FIRST 946771200UL ///< 2000-01-02, local times west of UTC fit too
+#define LAST 4102444799UL  ///< 2099-12-31 23:59:59
+#define STEP 7200          ///< Sampling interval, shorter than DST
+#define COUNT 100000       ///< Lookups per pass
+#define ROUNDS 20          ///< Passes timed per function
+
+static unsigned failures; ///< Mismatches in the current zone
+static uint32_t sorted[COUNT], shuffled[COUNT];
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compare CompiledTimeZone with glibc at one time
+    @param tz Zone, set up from the table of the zone in the TZ variable
+    @param t Unix time
+    @return glibc state at that time: twice the offset in seconds east of
+    UTC, plus 1 for DST
+*/
+/**************************************************************************/
+static long compare(CompiledTimeZone &tz, uint32_t t) {
+  time_t tt = t;
+  struct tm tm;
+  localtime_r(&tt, &tm);
+  DateTime utc(t);
+  DateTime local = tz.toLocal(utc);
+  bool same = tz.offset(utc) == tm.tm_gmtoff &&
+              tz.isDST(utc) == (tm.tm_isdst > 0) &&
+              local.unixtime() == t + tm.tm_gmtoff;
+
+  // the first UTC time showing this local time
+  uint32_t back = tz.toUTC(local).unixtime();
+  same &= back <= t && tz.toLocal(DateTime(back)) == local;
+  if (!same && failures++ < 5)
+    printf("mismatch at %lu\n", (unsigned long)t);
+  return tm.tm_gmtoff * 2 + (tm.tm_isdst > 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compare a zone with glibc over 2000 to 2099
+    @param tz Zone, set up from the table of the zone in the TZ variable
+    @return Number of transitions found
+*/
+/**************************************************************************/
+static unsigned compareAll(CompiledTimeZone &tz) {
+  unsigned transitions = 0;
+  long previous = compare(tz, FIRST);
+  for (uint32_t t = FIRST + STEP; t <= LAST - 86400; t += STEP) {
+    long state = compare(tz, t);
+    if (state == previous)
+      continue;
+    // find the transition to the second, and check both sides
+    uint32_t lo = t - STEP, hi = t;
+    while (hi - lo > 1) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (compare(tz, mid) == previous)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    for (uint32_t u = lo - 2; u <= hi + 2; u++)
+      compare(tz, u);
+    previous = state;
+    transitions++;
+  }
+  return transitions;
+}
+
+/** PROGMEM bytes of a table */
+static size_t tableSize(const TzTable &table) {
+  uint8_t offsets = table.initial + 1;
+  for (uint16_t i = 0; i < table.count; i++)
+    if (table.indices[i] + 1 > offsets)
+      offsets = table.indices[i] + 1;
+  size_t anchors = (table.count + TZTABLE_ANCHOR_INTERVAL - 1) /
+                   TZTABLE_ANCHOR_INTERVAL;
+  return 4 * anchors + 3 * table.count + offsets;
+}
+
+/** Transitions of a table, not counting the fillers of long intervals */
+static unsigned changes(const TzTable &table) {
+  unsigned changes = 0;
+  uint8_t previous = table.offsets[table.initial];
+  for (uint16_t i = 0; i < table.count; i++) {
+    uint8_t offset = table.offsets[table.indices[i]];
+    changes += offset != previous;
+    previous = offset;
+  }
+  return changes;
+}
+
+/** Print the lookups per second of ROUNDS passes, from a start time */
+static void report(const char *name, double start) {
+  printf("  %-18s %6.1fM lookups/s\n", name,
+         ROUNDS * COUNT / (benchSeconds() - start) * 1e-6);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Time the lookups of one zone
+    @param name Name of the input, for the report
+    @param times Times to look up
+*/
+/**************************************************************************/
+static void bench(const char *name, const uint32_t *times) {
+  printf("%s\n", name);
+  CompiledTimeZone compiled;
+  compiled.begin(tz_Europe_Paris);
+  TimeZone rule;
+  rule.begin("CET-1CEST,M3.5.0,M10.5.0/3");
+  int32_t sink = 0;
+  double t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < COUNT; i++)
+      sink += compiled.offset(DateTime(times[i]));
+  report("CompiledTimeZone", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < COUNT; i++)
+      sink += rule.offset(DateTime(times[i]));
+  report("TimeZone", t);
+  t = benchSeconds();
+  for (int r = 0; r < ROUNDS; r++)
+    for (size_t i = 0; i < COUNT; i++) {
+      time_t tt = times[i];
+      struct tm tm;
+      localtime_r(&tt, &tm);
+      sink += tm.tm_gmtoff;
+    }
+  report("localtime_r()", t);
+  benchSink = sink;
+}
+
+int main() {
+  for (size_t z = 0; z < sizeof(zones) / sizeof(zones[0]); z++) {
+    CompiledTimeZone tz;
+    tz.begin(*zones[z].table);
+    setenv("TZ", zones[z].name, 1);
+    tzset();
+    failures = 0;
+    unsigned transitions = compareAll(tz);
+    printf("%-20s %4u transitions, %4u bytes, %u mismatches\n",
+           zones[z].name, transitions, (unsigned)tableSize(*zones[z].table),
+           failures);
+    CHECK(transitions == changes(*zones[z].table));
+    CHECK(failures == 0);
+  }
+
+  setenv("TZ", "Europe/Paris", 1);
+  tzset();
+  for (size_t i = 0; i < COUNT; i++) {
+    sorted[i] = 1704067200 + 60 * i; // from 2024-01-01, every minute
+    shuffled[i] = SECONDS_FROM_1970_TO_2000 + random32() % 3155760000UL;
+  }
+  bench("Europe/Paris, per minute", sorted);
+  bench("Europe/Paris, random", shuffled);
+  return checkResult();
+}
@@ -0,0 +1,104 @@
+/*
+  DateTime64 round trips: every day of years 1 to 9999, at a random time of
+  day, must match glibc gmtime_r() and convert back to the same Unix time.
+  The range ends, invalid dates, the DateTime interop over 2000 to 2099,
+  the TimeSpan arithmetic and the string constructors are checked too.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define FIRST_DAY -719162L ///< 0001-01-01, in days since 1970-01-01
+#define LAST_DAY 2932896L  ///< 9999-12-31, in days since 1970-01-01
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/** Check a DateTime64 against gmtime_r() at the same time */
+static bool sameAsGlibc(const DateTime64 &dt, int64_t t) {
+  time_t tt = t;
+  struct tm tm;
+  gmtime_r(&tt, &tm);
+  return dt.year() == tm.tm_year + 1900 && dt.month() == tm.tm_mon + 1 &&
+         dt.day() == tm.tm_mday && dt.hour() == tm.tm_hour &&
+         dt.minute() == tm.tm_min && dt.second() == tm.tm_sec &&
+         dt.dayOfTheWeek() == tm.tm_wday;
+}
+
+int main() {
+  unsigned failures = 0;
+  for (long day = FIRST_DAY; day <= LAST_DAY; day++) {
+    int64_t t = (int64_t)day * 86400 + random32() % 86400;
+    DateTime64 dt(t);
+    if (!(sameAsGlibc(dt, t) && dt.isValid() && dt.unixtime() == t &&
+          DateTime64(dt.year(), dt.month(), dt.day(), dt.hour(), dt.minute(),
+                     dt.second()) == dt) &&
+        failures++ < 5)
+      printf("mismatch at %lld\n", (long long)t);
+  }
+  CHECK(failures == 0);
+
+  // range ends
+  const int64_t first = FIRST_DAY * 86400LL, last = LAST_DAY * 86400LL + 86399;
+  CHECK(DateTime64(first) == DateTime64(1, 1, 1));
+  CHECK(DateTime64(last) == DateTime64(9999, 12, 31, 23, 59, 59));
+  CHECK(DateTime64(1, 1, 1).unixtime() == first);
+  CHECK(DateTime64(9999, 12, 31, 23, 59, 59).unixtime() == last);
+  CHECK(!DateTime64(first - 1).isValid());
+  CHECK(!DateTime64(last + 1).isValid());
+  CHECK(DateTime64(-1) == DateTime64(1969, 12, 31, 23, 59, 59));
+  CHECK(DateTime64((int64_t)0) == DateTime64(1970, 1, 1));
+
+  // invalid dates
+  CHECK(DateTime64(2000, 2, 29).isValid());
+  CHECK(DateTime64(2400, 2, 29).isValid());
+  CHECK(!DateTime64(1900, 2, 29).isValid());
+  CHECK(!DateTime64(2023, 4, 31).isValid());
+  CHECK(!DateTime64(2023, 13, 1).isValid());
+  CHECK(!DateTime64(2023, 1, 1, 24).isValid());
+  CHECK(!DateTime64(0, 12, 31).isValid());
+  CHECK(!DateTime64(10000, 1, 1).isValid());
+
+  // lossless interop with DateTime over 2000 to 2099
+  for (int i = 0; i < 100000; i++) {
+    uint32_t t = SECONDS_FROM_1970_TO_2000 + random32() % 3155760000UL;
+    DateTime dt(t);
+    DateTime64 wide(dt);
+    CHECK(wide.inDateTimeRange() && wide.unixtime() == t &&
+          wide == DateTime64((int64_t)t) && wide.toDateTime() == dt &&
+          wide.dayOfTheWeek() == dt.dayOfTheWeek());
+  }
+  CHECK(DateTime64(2000, 1, 1).toDateTime() == DateTime(2000, 1, 1));
+  CHECK(DateTime64(2099, 12, 31, 23, 59, 59).toDateTime() ==
+        DateTime(2099, 12, 31, 23, 59, 59));
+  CHECK(!DateTime64(1999, 12, 31, 23, 59, 59).toDateTime().isValid());
+  CHECK(!DateTime64(2100, 1, 1).toDateTime().isValid());
+
+  // TimeSpan arithmetic and ordering, across the whole range
+  for (int i = 0; i < 100000; i++) {
+    int64_t a = first + (int64_t)(((uint64_t)random32() << 32 | random32()) %
+                                  (uint64_t)(last - first + 1));
+    int32_t span = (int32_t)random32() % 2000000000;
+    DateTime64 left(a);
+    DateTime64 right = left + TimeSpan(span);
+    if (!right.isValid())
+      continue;
+    CHECK(right.unixtime() == a + span);
+    CHECK((right - left).totalseconds() == span);
+    CHECK(right - TimeSpan(span) == left);
+    CHECK((left < right) == (span > 0) && (left == right) == (span == 0));
+  }
+
+  // string constructors, with four-digit years
+  CHECK(DateTime64("Apr 16 1999", "18:34:56") ==
+        DateTime64(1999, 4, 16, 18, 34, 56));
+  CHECK(DateTime64("Dec 31 2150", "23:59:59") ==
+        DateTime64(2150, 12, 31, 23, 59, 59));
+  CHECK(DateTime64("1969-07-20T20:17:40").unixtime() == -14182940);
+  CHECK(DateTime64("0001-01-01T00:00:00") == DateTime64(1, 1, 1));
+  CHECK(DateTime64("1900-03") == DateTime64(1900, 3, 1));
+  return checkResult();
+}
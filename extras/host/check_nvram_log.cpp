@@ -0,0 +1,145 @@
+/*
+  Fault injection on RTC_NvramLog: every append is cut after each byte
+  offset, as a reset would. A log started afresh must then hold the records
+  it held before, or after, the append, save for the records the append
+  drops and the new one.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define APPENDS 400 ///< Records appended per run
+
+static uint32_t times[APPENDS]; ///< Time of each record, by index
+
+static uint32_t seed = 1;
+static uint32_t random(uint32_t range) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % range;
+}
+
+/** Records found in a log, by index */
+struct Contents {
+  uint16_t first; ///< Index of the oldest record
+  uint16_t count; ///< Number of records
+  bool valid;     ///< Consecutive records, with their times
+};
+
+/**************************************************************************/
+/*!
+    @brief  Read the records of a log started afresh on an NVRAM
+    @param nv NVRAM
+    @return Records found
+*/
+/**************************************************************************/
+static Contents readLog(FakeNvram &nv) {
+  RTC_NvramLog<FakeNvram> log(nv);
+  Contents contents = {0, 0, true};
+  CHECK(log.begin(sizeof(uint16_t)));
+  uint32_t time;
+  uint16_t index;
+  while (log.read(time, (uint8_t *)&index)) {
+    if (contents.count == 0)
+      contents.first = index;
+    contents.valid &= index == contents.first + contents.count &&
+                      index < APPENDS && time == times[index];
+    contents.count++;
+  }
+  contents.valid &= contents.count == log.size();
+  return contents;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Append a record after a reset, cutting the append after each
+    byte offset in turn, then leave the NVRAM with the append complete
+    @param nv NVRAM
+    @param index Index of the record
+    @param keepTorn Leave the NVRAM instead as the last cut that lost the
+    record left it, if any
+    @return True if the NVRAM was left with the record lost
+*/
+/**************************************************************************/
+static bool cutEverywhere(FakeNvram &nv, uint16_t index, bool keepTorn) {
+  Contents before = readLog(nv);
+  FakeNvram saved = nv;
+  RTC_NvramLog<FakeNvram> log(nv);
+  CHECK(log.begin(sizeof(index)));
+  log.append(times[index], (uint8_t *)&index);
+  Contents after = readLog(nv);
+  CHECK(after.valid && after.count > 0 &&
+        after.first + after.count == index + 1);
+  FakeNvram complete = nv, torn;
+  bool lost = false;
+
+  for (long cut = 0;; cut++) {
+    nv = saved;
+    CHECK(log.begin(sizeof(index)));
+    nv.budget = cut;
+    nv.attempts = 0;
+    log.append(times[index], (uint8_t *)&index);
+    nv.budget = -1;
+    if (nv.attempts <= cut)
+      break;
+    Contents found = readLog(nv);
+    uint16_t end = found.first + found.count;
+    CHECK(found.valid);
+    if (before.count == 0) {
+      CHECK(found.count == 0 || (end == index + 1 && found.count == 1));
+    } else {
+      CHECK(end == index || end == index + 1);
+      CHECK(found.first >= before.first && found.first <= after.first);
+    }
+    if (end == index && found.count > 0) {
+      torn = nv;
+      lost = true;
+    }
+  }
+  nv = keepTorn && lost ? torn : complete;
+  return keepTorn && lost;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fill the header copy that is not current with garbage, whose
+    check byte does not match
+    @param nv NVRAM
+*/
+/**************************************************************************/
+static void scrambleOlderHeader(FakeNvram &nv) {
+  FakeNvram probe = nv, reference = nv;
+  Contents contents = readLog(reference);
+  uint8_t copy = 0;
+  memset(probe.data, 0, NVRAMLOG_SLOT_SIZE);
+  Contents left = readLog(probe);
+  if (left.first != contents.first || left.count != contents.count)
+    copy = 1;
+  uint8_t *data = nv.data + copy * NVRAMLOG_SLOT_SIZE;
+  uint8_t sum;
+  do {
+    sum = 0;
+    for (uint8_t i = 0; i < NVRAMLOG_SLOT_SIZE; i++)
+      sum += data[i] = random(256);
+  } while (sum == 0x5A);
+}
+
+int main() {
+  FakeNvram nv;
+  for (uint8_t fill = 0; fill < 3; fill++) {
+    memset(nv.data, fill == 1 ? 0xFF : 0x00, sizeof(nv.data));
+    // mostly periodic samples, with jitter and the odd long gap
+    uint32_t time = 1704067200;
+    for (uint16_t i = 0; i < APPENDS; i++) {
+      uint32_t r = random(100);
+      time += r < 70 ? 60 : r < 95 ? 55 + random(11) : random(200000);
+      times[i] = time;
+      // on the last run, the next header often goes over garbage
+      if (fill == 2 && i > 0 && i % 3 == 0)
+        scrambleOlderHeader(nv);
+      // now and then, carry on from a torn header, and append again
+      if (cutEverywhere(nv, i, i % 7 == 0))
+        cutEverywhere(nv, i, false);
+    }
+  }
+  return checkResult();
+}
@@ -0,0 +1,124 @@
+/*
+  Fault injection on RTC_NvramStore: every write is cut after each byte
+  offset, as a reset would, and a fresh store must then recover either the
+  previous or the new value of the key, and the values of the other keys.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define KEYS 4 ///< Number of keys in the store
+#define SIZE 4 ///< Size of a value, in bytes
+
+static uint32_t seed = 1;
+static uint8_t random8() {
+  seed = seed * 1103515245 + 12345;
+  return seed >> 16;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read every key from a store started afresh on an NVRAM
+    @param nv NVRAM
+    @param values Receives the values
+    @param found Receives whether each key holds a value
+*/
+/**************************************************************************/
+static void readAll(FakeNvram &nv, uint8_t values[KEYS][SIZE],
+                    bool found[KEYS]) {
+  RTC_NvramStore<FakeNvram> store(nv);
+  CHECK(store.begin(KEYS, SIZE));
+  for (uint8_t key = 0; key < KEYS; key++)
+    found[key] = store.read(key, values[key]);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a value after a reset, cutting the write after each byte
+    offset in turn, then leave the NVRAM with the write complete
+    @param nv NVRAM
+    @param key Key to write
+    @param value New value
+*/
+/**************************************************************************/
+static void cutEverywhere(FakeNvram &nv, uint8_t key, const uint8_t *value) {
+  uint8_t before[KEYS][SIZE], after[KEYS][SIZE];
+  bool had[KEYS], has[KEYS];
+  readAll(nv, before, had);
+  FakeNvram saved = nv;
+  for (long cut = 0;; cut++) {
+    nv = saved;
+    RTC_NvramStore<FakeNvram> store(nv);
+    CHECK(store.begin(KEYS, SIZE));
+    nv.budget = cut;
+    nv.attempts = 0;
+    CHECK(store.write(key, value));
+    bool complete = nv.attempts <= cut;
+    nv.budget = -1;
+
+    readAll(nv, after, has);
+    bool isNew = has[key] && memcmp(after[key], value, SIZE) == 0;
+    bool isOld = had[key] ? has[key] && memcmp(after[key], before[key],
+                                               SIZE) == 0
+                          : !has[key];
+    CHECK(complete ? isNew : isNew || isOld);
+    for (uint8_t other = 0; other < KEYS; other++)
+      if (other != key)
+        CHECK(has[other] == had[other] &&
+              (!had[other] || !memcmp(after[other], before[other], SIZE)));
+    if (complete)
+      break;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  CRC-8 of a record, as computed by NvramStore
+    @param key Key of the record
+    @param record Value, CRC and sequence number
+    @return CRC making the record valid
+*/
+/**************************************************************************/
+static uint8_t recordCrc(uint8_t key, const uint8_t *record) {
+  uint8_t crc = 0xFF;
+  uint8_t bytes[SIZE + 2] = {key, record[SIZE + 1]};
+  memcpy(bytes + 2, record, SIZE);
+  for (uint8_t i = 0; i < SIZE + 2; i++) {
+    crc ^= bytes[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = crc & 1 ? (crc >> 1) ^ 0x8C : crc >> 1;
+  }
+  return crc;
+}
+
+int main() {
+  FakeNvram nv;
+  uint8_t value[SIZE];
+
+  // Erased and cleared NVRAM, over enough writes to wrap the sequence
+  // numbers around
+  for (uint8_t fill = 0; fill < 2; fill++) {
+    memset(nv.data, fill ? 0xFF : 0x00, sizeof(nv.data));
+    for (uint16_t i = 0; i < 600; i++) {
+      for (uint8_t j = 0; j < SIZE; j++)
+        value[j] = random8();
+      cutEverywhere(nv, i % 3, value); // the last key stays empty
+    }
+  }
+
+  // Garbage, with the second slot of key 0 holding a valid record: the
+  // first write goes to the other slot, over garbage
+  for (uint16_t round = 0; round < 500; round++) {
+    for (uint8_t i = 0; i < sizeof(nv.data); i++)
+      nv.data[i] = random8();
+    uint8_t *record = nv.data + (SIZE + 2);
+    record[SIZE] = recordCrc(0, record);
+    for (uint8_t i = 0; i < 3; i++) {
+      for (uint8_t j = 0; j < SIZE; j++)
+        value[j] = random8();
+      cutEverywhere(nv, 0, value);
+    }
+  }
+
+  return checkResult();
+}
@@ -0,0 +1,112 @@
+/*
+  PreciseDateTime and PreciseTimeSpan: toString() with runs of "f" must
+  match snprintf() of the truncated fraction, and the arithmetic,
+  comparisons and conversions must match 64-bit microsecond counts, over
+  random times of 2000 to 2099 and spans of either sign.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+
+#define COUNT 200000 ///< Random cases per check
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/** Microseconds since 1970 of a PreciseDateTime */
+static int64_t micros(const PreciseDateTime &t) {
+  return t.unixtime() * 1000000LL + t.microseconds();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check toString() on one time, for every length of fraction
+    @param t Time to render
+    @return True if every format matches snprintf()
+*/
+/**************************************************************************/
+static bool formats(const PreciseDateTime &t) {
+  time_t seconds = t.unixtime();
+  struct tm tm;
+  gmtime_r(&seconds, &tm);
+  static const uint32_t scales[] = {100000, 10000, 1000, 100, 10, 1};
+  for (int digits = 1; digits <= 6; digits++) {
+    char buffer[40], expected[96];
+    snprintf(buffer, sizeof(buffer), "YYYY-MM-DD hh:mm:ss.%.*s [ff]", digits,
+             "ffffff");
+    snprintf(expected, sizeof(expected),
+             "%04d-%02d-%02d %02d:%02d:%02d.%0*lu [%02lu]", tm.tm_year + 1900,
+             tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+             digits, (unsigned long)(t.microseconds() / scales[digits - 1]),
+             (unsigned long)(t.microseconds() / 10000));
+    if (strcmp(t.toString(buffer), expected) != 0) {
+      printf("\"%s\" instead of \"%s\"\n", buffer, expected);
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  CHECK(sizeof(PreciseDateTime) == 8 && sizeof(PreciseTimeSpan) == 8);
+
+  // formatting, with fractions close to both ends of a second
+  char buffer[32];
+  strcpy(buffer, "hh:mm:ss.fff");
+  CHECK(strcmp(PreciseDateTime(DateTime(2020, 4, 16, 18, 34, 56), 42999)
+                   .toString(buffer),
+               "18:34:56.042") == 0);
+  for (uint32_t i = 0; i < COUNT; i++) {
+    uint32_t fraction = random32() % 1000000;
+    if (i % 4 == 1)
+      fraction = 999999 - fraction % 10;
+    else if (i % 4 == 2)
+      fraction %= 10;
+    PreciseDateTime t(SECONDS_FROM_1970_TO_2000 + random32() % 3155760000UL,
+                      fraction);
+    CHECK(formats(t));
+  }
+
+  // constructors carry whole seconds, and normalise negative spans
+  CHECK(micros(PreciseDateTime(1000, 2500000)) == 1002500000LL);
+  CHECK(PreciseDateTime(DateTime(2024, 1, 1), 1000000).toDateTime() ==
+        DateTime(2024, 1, 1, 0, 0, 1));
+  PreciseTimeSpan quarter(0, -250000);
+  CHECK(quarter.totalseconds() == -1 && quarter.microseconds() == 750000 &&
+        quarter.totalmicros() == -250000);
+  CHECK(PreciseTimeSpan(TimeSpan(1, 2, 3, 4)).totalmicros() ==
+        93784000000LL);
+  CHECK(PreciseTimeSpan(5, -1).toTimeSpan().totalseconds() == 4);
+
+  // arithmetic and comparisons against microsecond counts
+  for (uint32_t i = 0; i < COUNT; i++) {
+    PreciseDateTime t(SECONDS_FROM_1970_TO_2000 + 100000000 +
+                          random32() % 2900000000UL,
+                      random32() % 1000000);
+    int32_t seconds = (int32_t)(random32() % 200000000) - 100000000;
+    int32_t fraction = (int32_t)(random32() % 4000001) - 2000000;
+    PreciseTimeSpan span(seconds, fraction);
+    int64_t length = seconds * 1000000LL + fraction;
+    CHECK(span.totalmicros() == length && span.microseconds() < 1000000);
+    PreciseDateTime later = t + span, earlier = t - span;
+    CHECK(micros(later) == micros(t) + length &&
+          later.microseconds() < 1000000);
+    CHECK(micros(earlier) == micros(t) - length &&
+          earlier.microseconds() < 1000000);
+    CHECK((later - t).totalmicros() == length);
+    CHECK((t - later).totalmicros() == -length);
+    CHECK((later - earlier) == span + span);
+    CHECK((later > t) == (length > 0) && (later < t) == (length < 0) &&
+          (later == t) == (length == 0) && (later != t) == (length != 0));
+    CHECK((later >= earlier) == (length >= 0) &&
+          (later <= earlier) == (length <= 0));
+    PreciseTimeSpan other(random32() % 1000, random32() % 1000000);
+    CHECK((span < other) == (length < other.totalmicros()) &&
+          (span > other) == (length > other.totalmicros()));
+    CHECK((span - other).totalmicros() == length - other.totalmicros());
+  }
+  return checkResult();
+}
@@ -0,0 +1,98 @@
+/*
+  TimeZone against glibc: for a set of POSIX TZ strings, the offset, DST
+  flag, abbreviation and local time must match localtime_r() every two
+  hours from 2000 to 2099, and to the second around every transition.
+  toUTC() must invert toLocal(), taking a repeated local time as its first
+  occurrence.
+*/
+
+#include "RTClib.h"
+#include "harness.h"
+#include <stdlib.h>
+
+static const char *zones[] = {
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    "IST-5:30",
+    "<+0330>-3:30<+0430>,J79/24,J263/24",
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+    "XST3XDT2,59/1:30,300",
+    "LHST-10:30LHDT-11,M10.1.0,M4.1.0",
+};
+
+#define FIRST 946771200UL ///< 2000-01-02, local times west of UTC fit too
+#define LAST 4102444799UL  ///< 2099-12-31 23:59:59
+#define STEP 7200          ///< Sampling interval, shorter than DST
+
+static unsigned failures; ///< Mismatches in the current zone
+
+/**************************************************************************/
+/*!
+    @brief  Compare TimeZone with glibc at one time
+    @param tz Zone, set up from the same rule as the TZ variable
+    @param t Unix time
+    @return glibc offset at that time, in seconds east of UTC
+*/
+/**************************************************************************/
+static long compare(TimeZone &tz, uint32_t t) {
+  time_t tt = t;
+  struct tm tm;
+  localtime_r(&tt, &tm);
+  DateTime utc(t);
+  DateTime local = tz.toLocal(utc);
+  bool same = tz.offset(utc) == tm.tm_gmtoff &&
+              tz.isDST(utc) == (tm.tm_isdst > 0) &&
+              strcmp(tz.abbreviation(utc), tm.tm_zone) == 0 &&
+              local.year() == tm.tm_year + 1900 &&
+              local.month() == tm.tm_mon + 1 && local.day() == tm.tm_mday &&
+              local.hour() == tm.tm_hour && local.minute() == tm.tm_min &&
+              local.second() == tm.tm_sec;
+
+  // the first UTC time showing this local time
+  uint32_t back = tz.toUTC(local).unixtime();
+  same &= back <= t && tz.toLocal(DateTime(back)) == local;
+  if (back < t) {
+    tt = back;
+    localtime_r(&tt, &tm);
+    same &= tm.tm_isdst > 0;
+  }
+  if (!same && failures++ < 5)
+    printf("mismatch at %lu\n", (unsigned long)t);
+  return tm.tm_gmtoff;
+}
+
+int main() {
+  for (size_t z = 0; z < sizeof(zones) / sizeof(zones[0]); z++) {
+    TimeZone tz;
+    CHECK(tz.begin(zones[z]));
+    setenv("TZ", zones[z], 1);
+    tzset();
+    failures = 0;
+    unsigned transitions = 0;
+    long previous = compare(tz, FIRST);
+    for (uint32_t t = FIRST + STEP; t <= LAST - 86400; t += STEP) {
+      long offset = compare(tz, t);
+      if (offset == previous)
+        continue;
+      // find the transition to the second, and check both sides
+      uint32_t lo = t - STEP, hi = t;
+      while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (compare(tz, mid) == previous)
+          lo = mid;
+        else
+          hi = mid;
+      }
+      for (uint32_t u = lo - 2; u <= hi + 2; u++)
+        compare(tz, u);
+      previous = offset;
+      transitions++;
+    }
+    printf("%-36s %4u transitions, %u mismatches\n", zones[z], transitions,
+           failures);
+    CHECK(failures == 0);
+  }
+  return checkResult();
+}
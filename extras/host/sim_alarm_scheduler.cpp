@@ -0,0 +1,103 @@
+/*
+  RTC_AlarmScheduler over a simulated DS3231: thousands of one-shot and
+  repeating alarms, added and removed while the clock runs, polled only
+  when the hardware alarm flag is set, as an interrupt handler would.
+  Every alarm must fire once per occurrence, at most a second after it is
+  due, or after it was added if it was already due by then.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define ALARMS 5000         ///< Capacity of the scheduler
+#define DAYS 3              ///< Length of the simulation
+#define START 1704067200UL  ///< 2024-01-01 00:00:00
+#define NONE 0xFFFFFFFFUL   ///< Expected time of an unscheduled id
+
+static uint32_t expected[ALARMS]; ///< Next expected occurrence, by id
+static uint32_t periods[ALARMS];  ///< Repeat period, by id
+static uint32_t due[ALARMS];      ///< Second the next occurrence shows up
+
+static uint32_t seed = 1;
+static uint32_t random(uint32_t range) {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % range;
+}
+
+static RTC_DS3231 rtc;
+static RTC_AlarmScheduler<RTC_DS3231> scheduler(rtc);
+
+static void add(uint32_t time, uint32_t period, uint32_t now) {
+  int16_t id = scheduler.add(DateTime(time), TimeSpan(period));
+  CHECK(id >= 0 && expected[id] == NONE);
+  if (id < 0)
+    return;
+  expected[id] = time;
+  periods[id] = period;
+  // an alarm added when already due fires at the next tick
+  due[id] = time > now ? time : now + 1;
+}
+
+int main() {
+  SimDs3231 chip;
+  chip.setTime(START);
+  CHECK(rtc.begin());
+  rtc.writeSqwPinMode(DS3231_OFF);
+
+  CHECK(!scheduler.begin(40000)); // ids would not fit an int16_t
+  CHECK(scheduler.begin(ALARMS));
+  CHECK(scheduler.add(DateTime(START + 60), TimeSpan(-60)) == -1);
+  CHECK(scheduler.empty());
+
+  for (uint16_t id = 0; id < ALARMS; id++)
+    expected[id] = NONE;
+  for (uint16_t i = 0; i < ALARMS - 100; i++) {
+    if (i % 5 == 0)
+      add(START + 1 + random(86400), 60 + random(7200), START);
+    else
+      add(START + 1 + random(DAYS * 86400), 0, START);
+  }
+
+  uint32_t fired = 0, wakeups = 0, missed = 0, transfers = chip.transfers;
+  for (uint32_t step = 0; step < DAYS * 86400; step++) {
+    delay(1000);
+    uint32_t now = chip.time();
+    if (chip.peek(0x0F) & 0x01) { // A1F asserts INT/SQW
+      wakeups++;
+      int16_t id;
+      while ((id = scheduler.poll()) >= 0) {
+        now = chip.time();
+        CHECK(expected[id] != NONE);
+        if (expected[id] == NONE)
+          continue;
+        // never early, and late only when added in the past
+        CHECK(expected[id] <= now);
+        CHECK((int32_t)(now - due[id]) <= 1);
+        fired++;
+        expected[id] = periods[id] ? expected[id] + periods[id] : NONE;
+        due[id] = expected[id];
+      }
+    }
+    for (uint16_t id = 0; id < ALARMS; id++)
+      if (expected[id] != NONE && due[id] + 3 < now) {
+        missed++;
+        expected[id] = NONE;
+      }
+    if (step % 97 == 0) { // churn: cancel one alarm, add one in the past
+      uint16_t id = random(ALARMS);
+      if (expected[id] != NONE) {
+        CHECK(scheduler.remove(id));
+        expected[id] = NONE;
+      }
+      add(now - random(30), random(2) ? 0 : 600, now);
+    }
+  }
+  CHECK(missed == 0);
+
+  printf("%u alarms fired over %u wake-ups, %u missed, %.1f transfers per "
+         "alarm\n",
+         (unsigned)fired, (unsigned)wakeups, (unsigned)missed,
+         (double)(chip.transfers - transfers) / fired);
+  return checkResult();
+}
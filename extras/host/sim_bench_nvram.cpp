@@ -0,0 +1,76 @@
+/*
+  NVRAM throughput of RTC_DS1307 and RTC_DS3232 on the simulated bus, for
+  the Wire buffer sizes of the common cores, in bytes per second of bus
+  time. Checks that whole-NVRAM transfers arrive intact, in as few
+  transfers as the buffer allows, and never spill into the time registers.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define START 1704067200UL ///< 2024-01-01 00:00:00
+
+static const size_t buffers[] = {32, 64, 128, 256}; ///< Wire buffer sizes
+
+/**************************************************************************/
+/*!
+    @brief  Fill, read back and time the whole NVRAM of a chip
+    @param rtc Driver, started on the chip model
+    @param chip Chip model
+    @param name Chip name, for the report
+*/
+/**************************************************************************/
+template <class RTC>
+static void bench(RTC &rtc, SimRtc &chip, const char *name) {
+  const uint8_t size = RTC::NVRAM_SIZE;
+  uint8_t out[256], in[256];
+  for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+    simBufferSize = buffers[i];
+    for (uint8_t j = 0; j < size; j++)
+      out[j] = j * 7 + buffers[i];
+
+    uint32_t transfers = simTransfers;
+    uint64_t t0 = simNanos;
+    rtc.writenvram(0, out, size);
+    uint64_t t1 = simNanos;
+    uint32_t writes = simTransfers - transfers;
+    rtc.readnvram(in, size, 0);
+    uint64_t t2 = simNanos;
+    uint32_t reads = simTransfers - transfers - writes;
+
+    CHECK(memcmp(in, out, size) == 0);
+    CHECK(writes == (size + buffers[i] - 2) / (buffers[i] - 1));
+    CHECK(reads == (size + buffers[i] - 1) / buffers[i]);
+    printf("%s, %3u-byte buffer: write %5.0f B/s in %u transfers, read "
+           "%5.0f B/s in %u transfers\n",
+           name, (unsigned)buffers[i], size * 1e9 / (t1 - t0),
+           (unsigned)writes, size * 1e9 / (t2 - t1), (unsigned)reads);
+  }
+  simBufferSize = 32;
+
+  // Transfers past the end are clipped rather than wrapping to the time
+  rtc.writenvram(size - 4, out, 20);
+  rtc.readnvram(in, 20, size - 4);
+  CHECK(memcmp(in, out, 4) == 0);
+  CHECK(chip.peek(0x05) == 0x01 && chip.peek(0x06) == 0x24); // 2024-01
+  CHECK(chip.time() - START < 60);
+}
+
+int main() {
+  {
+    SimDs1307 chip;
+    RTC_DS1307 rtc;
+    CHECK(rtc.begin());
+    rtc.adjust(DateTime(START));
+    bench(rtc, chip, "DS1307");
+  }
+  {
+    SimDs3231 chip(true);
+    RTC_DS3232 rtc;
+    CHECK(rtc.begin());
+    rtc.adjust(DateTime(START));
+    bench(rtc, chip, "DS3232");
+  }
+  return checkResult();
+}
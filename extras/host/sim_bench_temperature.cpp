@@ -0,0 +1,52 @@
+/*
+  Temperature readout of RTC_DS3231 on the simulated bus: the integer
+  getTemperatureQuarters() against the float getTemperature(), over the
+  whole sensor range, and a conversion forced with the CONV bit.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define CALLS 1000000L ///< Calls timed per function
+
+int main() {
+  SimDs3231 chip;
+  RTC_DS3231 rtc;
+  CHECK(rtc.begin());
+
+  // -40 to +85 degrees, through a forced conversion each time
+  for (int16_t q = -160; q <= 340; q++) {
+    chip.setTemperature(q);
+    CHECK(rtc.startTemperatureConversion());
+    CHECK(rtc.isConvertingTemperature());
+    CHECK(!rtc.startTemperatureConversion()); // already running
+    uint32_t polls = 0;
+    while (rtc.isConvertingTemperature())
+      polls++;
+    CHECK(polls > 0);
+    CHECK(rtc.getTemperatureQuarters() == q);
+    CHECK(rtc.getTemperature() == q * 0.25f);
+  }
+
+  // Time the CPU side only: transfers take no simulated time
+  simBusHz = 0;
+  chip.setTemperature(-37); // -9.25 degrees
+  rtc.startTemperatureConversion();
+  delay(200);
+  int32_t isum = 0;
+  float fsum = 0;
+  double t0 = benchSeconds();
+  for (long i = 0; i < CALLS; i++)
+    isum += rtc.getTemperatureQuarters();
+  double t1 = benchSeconds();
+  for (long i = 0; i < CALLS; i++)
+    fsum += rtc.getTemperature();
+  double t2 = benchSeconds();
+  benchSink = isum + (uint32_t)fsum;
+  CHECK(isum == -37 * CALLS);
+
+  printf("getTemperatureQuarters(): %5.1f ns/call\n", (t1 - t0) * 1e9 / CALLS);
+  printf("getTemperature():         %5.1f ns/call\n", (t2 - t1) * 1e9 / CALLS);
+  return checkResult();
+}
@@ -0,0 +1,82 @@
+/*
+  RTC_NvramCentury over a simulated DS1307: the century must advance when
+  the chip's year steps from 99 to 00 while the time is read, survive a
+  restart through the NVRAM, and stay put when the chip is set to another
+  year behind the wrapper's back. The NVRAM is only written when the year
+  changes.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define RECORD (0x08 + RTC_DS1307::NVRAM_SIZE - NVRAMCENTURY_SIZE)
+
+/** Check the century and last year held in the NVRAM of the chip */
+static bool stored(SimRtc &chip, uint8_t century, uint8_t year) {
+  uint8_t check = chip.peek(RECORD + 2);
+  return chip.peek(RECORD) == century && chip.peek(RECORD + 1) == year &&
+         (uint8_t)(century + year + check) == 0x5A;
+}
+
+int main() {
+  SimDs1307 chip;
+  RTC_DS1307 rtc;
+  CHECK(rtc.begin());
+  rtc.adjust(DateTime(2024, 1, 1));
+
+  // a blank NVRAM takes the default century
+  RTC_NvramCentury<RTC_DS1307> clock(rtc);
+  CHECK(!clock.begin());
+  CHECK(stored(chip, 20, 24));
+  CHECK(clock.now64() == DateTime64(2024, 1, 1));
+
+  // the year steps from 99 to 00 while the time is read every second
+  clock.adjust(DateTime64(2199, 12, 31, 23, 59, 57));
+  CHECK(stored(chip, 21, 99));
+  uint32_t transfers = simTransfers;
+  rtc.now();
+  uint32_t reads = simTransfers - transfers; // transfers of a plain read
+  unsigned writes = 0;
+  for (int i = 0; i < 5; i++) {
+    transfers = simTransfers;
+    CHECK(clock.now64() ==
+          DateTime64(2199, 12, 31, 23, 59, 57) + TimeSpan(i));
+    writes += simTransfers - transfers > reads;
+    delay(1000);
+  }
+  CHECK(writes == 1); // the NVRAM is only written on the step into 2200
+  CHECK(stored(chip, 22, 0));
+  CHECK(clock.now64().year() == 2200);
+
+  // a restart loads the century back
+  RTC_NvramCentury<RTC_DS1307> restarted(rtc);
+  CHECK(restarted.begin());
+  CHECK(restarted.now64().year() == 2200);
+
+  // setting the chip to another year directly never moves the century,
+  // whether the year goes up or down, or down across 00
+  rtc.adjust(DateTime(2050, 6, 1));
+  CHECK(restarted.now64().year() == 2250 && stored(chip, 22, 50));
+  rtc.adjust(DateTime(2010, 6, 1));
+  CHECK(restarted.now64().year() == 2210 && stored(chip, 22, 10));
+  rtc.adjust(DateTime(2000, 6, 1));
+  CHECK(restarted.now64().year() == 2200);
+  rtc.adjust(DateTime(2099, 6, 1));
+  CHECK(restarted.now64().year() == 2299 && stored(chip, 22, 99));
+  rtc.adjust(DateTime(2001, 6, 1));
+  CHECK(restarted.now64().year() == 2201 && stored(chip, 22, 1));
+
+  // only a step from 99 to 00 counts: reading in 2299, then in 2300
+  restarted.adjust(DateTime64(2299, 12, 31, 23, 59, 59));
+  CHECK(restarted.now64().year() == 2299);
+  delay(2000);
+  CHECK(restarted.now64().year() == 2300 && stored(chip, 23, 0));
+
+  // a corrupted record is replaced with the default century
+  chip.poke(RECORD + 2, chip.peek(RECORD + 2) + 1);
+  RTC_NvramCentury<RTC_DS1307> corrupted(rtc);
+  CHECK(!corrupted.begin(RTC_DS1307::NVRAM_SIZE - NVRAMCENTURY_SIZE, 19));
+  CHECK(corrupted.now64().year() == 1900 && stored(chip, 19, 0));
+  return checkResult();
+}
@@ -0,0 +1,145 @@
+/*
+  readAlarm1() and readAlarm2() of RTC_DS3231 and RTC_DS3232 over a
+  simulated DS3232: each must take a single transfer, give back the time
+  and every mode set by setAlarm1() or setAlarm2(), the day of the week
+  (1 for Monday to 7 for Sunday) when DY/DT is set and the day of the month
+  otherwise, and report A1IE/A2IE and A1F/A2F from the control and status
+  registers read in that same transfer, each alarm its own bits only.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define CONTROL 0x0E ///< Control register
+#define STATUS 0x0F  ///< Status register
+#define INTCN 0x04   ///< Interrupt mode of the INT/SQW pin
+#define A1IE 0x01    ///< Alarm 1 interrupt enable
+#define A2IE 0x02    ///< Alarm 2 interrupt enable
+#define A1F 0x01     ///< Alarm 1 flag
+#define A2F 0x02     ///< Alarm 2 flag
+
+static SimDs3231 chip(true);
+
+/** Dates to match: a Sunday, then the 31st, a Wednesday */
+static const DateTime dates[] = {DateTime(2024, 1, 14, 23, 59, 58),
+                                 DateTime(2024, 1, 31, 12, 34, 56)};
+static const uint8_t weekdays[] = {7, 3}; ///< Their DS3231 days of the week
+
+/** Read alarm 1, checking that it takes a single transfer */
+template <class RTC> static Ds3231AlarmState alarm1(RTC &rtc) {
+  uint32_t transfers = chip.transfers;
+  Ds3231AlarmState state = rtc.readAlarm1();
+  CHECK(chip.transfers - transfers == 1);
+  return state;
+}
+
+/** Read alarm 2, checking that it takes a single transfer */
+template <class RTC> static Ds3231AlarmState alarm2(RTC &rtc) {
+  uint32_t transfers = chip.transfers;
+  Ds3231AlarmState state = rtc.readAlarm2();
+  CHECK(chip.transfers - transfers == 1);
+  return state;
+}
+
+/** Check the time, mode and DY/DT of a state against what was set */
+static bool reads(const Ds3231AlarmState &state, uint8_t date, uint8_t mode,
+                  bool dayOfWeek, uint8_t second) {
+  const DateTime &dt = dates[date];
+  uint8_t day = dayOfWeek ? weekdays[date] : dt.day();
+  return state.mode == mode && state.dayOfWeek == dayOfWeek &&
+         state.time == DateTime(2000, 5, day, dt.hour(), dt.minute(), second) &&
+         state.enabled && !state.fired && state.interrupt;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check both alarms of an RTC driving the simulated chip
+    @param rtc RTC_DS3231 or RTC_DS3232
+    @param modes1 Every alarm 1 mode, the day of the week one last
+    @param modes2 Every alarm 2 mode, the day of the week one last
+*/
+/**************************************************************************/
+template <class RTC, class Mode1, class Mode2>
+static void checkAlarms(RTC &rtc, const Mode1 (&modes1)[6],
+                        const Mode2 (&modes2)[5]) {
+  chip.poke(CONTROL, INTCN);
+  chip.poke(STATUS, 0);
+
+  // every mode round-trips, on either date
+  for (uint8_t date = 0; date < 2; date++) {
+    for (uint8_t i = 0; i < 6; i++) {
+      CHECK(rtc.setAlarm1(dates[date], modes1[i]));
+      CHECK(reads(alarm1(rtc), date, modes1[i], i == 5, dates[date].second()));
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+      CHECK(rtc.setAlarm2(dates[date], modes2[i]));
+      CHECK(reads(alarm2(rtc), date, modes2[i], i == 4, 0));
+    }
+  }
+
+  // DY/DT picks the day field mask: a weekday leaves bits 4 and 5 out,
+  // they belong to the tens of a date
+  chip.poke(0x0A, 0x40 | 0x30 | 0x07);
+  CHECK(alarm1(rtc).time.day() == 7 && alarm1(rtc).dayOfWeek);
+  chip.poke(0x0A, 0x31);
+  CHECK(alarm1(rtc).time.day() == 31 && !alarm1(rtc).dayOfWeek);
+  chip.poke(0x0D, 0x40 | 0x30 | 0x01);
+  CHECK(alarm2(rtc).time.day() == 1 && alarm2(rtc).dayOfWeek);
+  chip.poke(0x0D, 0x29);
+  CHECK(alarm2(rtc).time.day() == 29 && !alarm2(rtc).dayOfWeek);
+  // a combination of mask bits matching no mode reads as a date match
+  chip.poke(0x07, 0x80);
+  CHECK(alarm1(rtc).mode == DS3231_A1_Date);
+  chip.poke(0x0C, 0x80);
+  CHECK(alarm2(rtc).mode == DS3231_A2_Date);
+
+  // the enables, flags and INTCN of each alarm, and only its own
+  for (uint8_t control = 0; control < 8; control++) {
+    for (uint8_t status = 0; status < 4; status++) {
+      chip.poke(CONTROL, control);
+      chip.poke(STATUS, status);
+      Ds3231AlarmState a1 = alarm1(rtc), a2 = alarm2(rtc);
+      CHECK(a1.enabled == ((control & A1IE) != 0) &&
+            a1.fired == ((status & A1F) != 0) &&
+            a1.interrupt == ((control & INTCN) != 0));
+      CHECK(a2.enabled == ((control & A2IE) != 0) &&
+            a2.fired == ((status & A2F) != 0) &&
+            a2.interrupt == ((control & INTCN) != 0));
+    }
+  }
+
+  // alarm 1 firing comes up in the state read back, with its enable
+  chip.poke(CONTROL, INTCN);
+  chip.poke(STATUS, 0);
+  rtc.adjust(DateTime(2024, 1, 14, 23, 59, 56));
+  CHECK(rtc.setAlarm1(dates[0], modes1[4]));
+  delay(1500);
+  CHECK(!alarm1(rtc).fired);
+  delay(1000);
+  Ds3231AlarmState state = alarm1(rtc);
+  CHECK(state.fired && state.enabled && !alarm2(rtc).fired);
+}
+
+int main() {
+  static const Ds3231Alarm1Mode ds3231Modes1[6] = {
+      DS3231_A1_PerSecond, DS3231_A1_Second, DS3231_A1_Minute,
+      DS3231_A1_Hour,      DS3231_A1_Date,   DS3231_A1_Day};
+  static const Ds3231Alarm2Mode ds3231Modes2[5] = {
+      DS3231_A2_PerMinute, DS3231_A2_Minute, DS3231_A2_Hour, DS3231_A2_Date,
+      DS3231_A2_Day};
+  static const Ds3232Alarm1Mode ds3232Modes1[6] = {
+      DS3232_A1_PerSecond, DS3232_A1_Second, DS3232_A1_Minute,
+      DS3232_A1_Hour,      DS3232_A1_Date,   DS3232_A1_Day};
+  static const Ds3232Alarm2Mode ds3232Modes2[5] = {
+      DS32312_A2_PerMinute, DS3232_A2_Minute, DS3232_A2_Hour, DS3232_A2_Date,
+      DS3232_A2_Day};
+
+  RTC_DS3231 ds3231;
+  CHECK(ds3231.begin());
+  checkAlarms(ds3231, ds3231Modes1, ds3231Modes2);
+  RTC_DS3232 ds3232;
+  CHECK(ds3232.begin());
+  checkAlarms(ds3232, ds3232Modes1, ds3232Modes2);
+  return checkResult();
+}
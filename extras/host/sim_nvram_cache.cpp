@@ -0,0 +1,154 @@
+/*
+  RTC_NvramCache over a simulated DS1307 and DS3232. Dirty bytes separated
+  by up to NVRAMCACHE_MAX_GAP clean bytes must be handed out as one range,
+  and split by a longer gap. flush() must write each range back in one
+  transfer, or as few as the Wire buffer allows, reads must be served from
+  RAM without any transfer, and update() must flush once the interval has
+  elapsed since the first unwritten change, and not before.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+/** Check the ranges of a bare mirror: gaps, merging, and clean writes */
+static void checkRanges() {
+  NvramCache cache;
+  uint8_t address, size;
+  // nothing to read or hand out before begin()
+  CHECK(cache.readnvram(0) == 0 && !cache.nextDirtyRange(address, size));
+  CHECK(cache.begin(56));
+
+  // a gap of NVRAMCACHE_MAX_GAP clean bytes is merged
+  cache.writenvram(10, 1);
+  cache.writenvram(11 + NVRAMCACHE_MAX_GAP, 2);
+  CHECK(cache.nextDirtyRange(address, size) && address == 10 &&
+        size == NVRAMCACHE_MAX_GAP + 2);
+  CHECK(!cache.nextDirtyRange(address, size) && !cache.isDirty());
+
+  // one more splits the range
+  cache.writenvram(10, 3);
+  cache.writenvram(12 + NVRAMCACHE_MAX_GAP, 4);
+  CHECK(cache.nextDirtyRange(address, size) && address == 10 && size == 1);
+  CHECK(cache.nextDirtyRange(address, size) &&
+        address == 12 + NVRAMCACHE_MAX_GAP && size == 1);
+  CHECK(!cache.nextDirtyRange(address, size));
+
+  // merging chains from one dirty byte to the next, up to the last byte
+  for (uint8_t a = 20; a < 56; a += NVRAMCACHE_MAX_GAP + 1)
+    cache.writenvram(a, a);
+  cache.writenvram(55, 0xFF);
+  CHECK(cache.nextDirtyRange(address, size) && address == 20 && size == 36);
+  CHECK(!cache.nextDirtyRange(address, size));
+
+  // rewriting a byte with its value leaves it clean; past the end is
+  // ignored, and reads 0
+  cache.writenvram(10, 3);
+  cache.writenvram(56, 5);
+  CHECK(!cache.isDirty());
+  CHECK(cache.readnvram(10) == 3 && cache.readnvram(56) == 0 &&
+        cache.readnvram(255) == 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check the cache of a chip's NVRAM: loading, hits, flushes
+    @param rtc Driver, started on the chip model
+    @param chip Chip model
+    @param base First NVRAM register of the chip
+*/
+/**************************************************************************/
+template <class RTC>
+static void checkCache(RTC &rtc, SimRtc &chip, uint8_t base) {
+  const uint8_t size = RTC::NVRAM_SIZE;
+  for (uint8_t a = 0; a < size; a++)
+    chip.poke(base + a, a ^ 0x5A);
+
+  // begin() loads the whole NVRAM, in as few transfers as the buffer allows
+  RTC_NvramCache<RTC> cache(rtc);
+  uint32_t transfers = chip.transfers;
+  CHECK(cache.begin(1000));
+  CHECK(chip.transfers - transfers == (size + 31u) / 32);
+
+  // reads are hits, at no transfer at all
+  transfers = chip.transfers;
+  uint8_t buf[256];
+  cache.readnvram(buf, size, 0);
+  bool loaded = true;
+  for (uint8_t a = 0; a < size; a++)
+    loaded &= buf[a] == (a ^ 0x5A) && cache.readnvram(a) == (a ^ 0x5A);
+  CHECK(loaded && cache.readnvram(size) == 0);
+  CHECK(chip.transfers == transfers);
+
+  // so are writes, until flush(): one transfer per range, the gaps
+  // rewritten with the bytes they hold
+  cache.writenvram(0, 0xA0);
+  cache.writenvram(1 + NVRAMCACHE_MAX_GAP, 0xA1);     // merged with the first
+  cache.writenvram(3 + 2 * NVRAMCACHE_MAX_GAP, 0xA2); // split from it
+  cache.writenvram(size - 1, 0xA3);
+  CHECK(chip.transfers == transfers);
+  CHECK(chip.peek(base) == (0 ^ 0x5A));
+  cache.flush();
+  CHECK(chip.transfers - transfers == 3);
+  CHECK(chip.peek(base) == 0xA0 && chip.peek(base + 1) == (1 ^ 0x5A) &&
+        chip.peek(base + 1 + NVRAMCACHE_MAX_GAP) == 0xA1 &&
+        chip.peek(base + 3 + 2 * NVRAMCACHE_MAX_GAP) == 0xA2 &&
+        chip.peek(base + size - 1) == 0xA3);
+  // nothing left to write
+  transfers = chip.transfers;
+  cache.flush();
+  CHECK(chip.transfers == transfers && !cache.isDirty());
+
+  // a range longer than the Wire buffer takes one transfer per 31 bytes
+  uint8_t block[40];
+  for (uint8_t i = 0; i < 40; i++)
+    block[i] = ~i;
+  cache.writenvram(4, block, 40);
+  cache.flush();
+  CHECK(chip.transfers - transfers == 2);
+  rtc.readnvram(buf, 40, 4);
+  CHECK(memcmp(buf, block, 40) == 0);
+
+  // update() flushes once the interval has elapsed since the first change,
+  // however many changes followed it
+  transfers = chip.transfers;
+  delay(5000);
+  CHECK(!cache.update());
+  cache.writenvram(20, 0xB0);
+  delay(600);
+  cache.writenvram(21, 0xB1);
+  CHECK(!cache.update());
+  delay(390);
+  CHECK(!cache.update() && chip.transfers == transfers);
+  delay(20);
+  CHECK(cache.update() && chip.transfers - transfers == 1);
+  CHECK(chip.peek(base + 20) == 0xB0 && chip.peek(base + 21) == 0xB1);
+  CHECK(!cache.update() && !cache.isDirty());
+
+  // without an interval, only flush() writes
+  CHECK(cache.begin());
+  cache.writenvram(30, 0xC0);
+  delay(60000);
+  CHECK(!cache.update() && chip.peek(base + 30) != 0xC0);
+  cache.flush();
+  CHECK(chip.peek(base + 30) == 0xC0);
+}
+
+int main() {
+  checkRanges();
+  {
+    SimDs1307 chip;
+    RTC_DS1307 rtc;
+    CHECK(rtc.begin());
+    rtc.adjust(DateTime(2024, 1, 1));
+    checkCache(rtc, chip, 0x08);
+  }
+  {
+    SimDs3231 chip(true);
+    RTC_DS3232 rtc;
+    CHECK(rtc.begin());
+    rtc.adjust(DateTime(2024, 1, 1));
+    checkCache(rtc, chip, 0x14);
+  }
+  return checkResult();
+}
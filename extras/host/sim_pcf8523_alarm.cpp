@@ -0,0 +1,112 @@
+/*
+  RTC_PCF8523 alarm over a simulated PCF8523: the alarm must fire at the
+  start of the selected minute, on a day of the month or of the week, the
+  latter as written by adjust(). Setting and disabling it must only touch
+  AIE in Control_1, and clear AF in Control_2 while writing 1 to the other
+  flags, as writing 0 clears them.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define CONTROL_1 0x00 ///< Control_1 register
+#define CONTROL_2 0x01 ///< Control_2 register
+#define ALARM 0x0A     ///< First alarm register
+#define CIE 0x01       ///< Correction interrupt enable
+#define AIE 0x02       ///< Alarm interrupt enable
+#define CAP_SEL 0x80   ///< 12.5 pF quartz load
+#define CTAIE 0x02     ///< Timer A countdown interrupt enable
+#define AF 0x08        ///< Alarm flag
+#define SF 0x10        ///< Second timer flag
+#define CTBF 0x20      ///< Timer B flag
+#define CTAF 0x40      ///< Timer A countdown flag
+
+static SimPcf8523 chip;
+static RTC_PCF8523 rtc;
+
+/** Poll AF every 10 ms, and return the seconds it took to come up */
+static double waitForAlarm(double limit) {
+  uint64_t start = simNanos;
+  while (!rtc.alarmFired() && simNanos - start < limit * 1e9)
+    delay(10);
+  return (simNanos - start) * 1e-9;
+}
+
+int main() {
+  CHECK(rtc.begin());
+  rtc.adjust(DateTime(2024, 1, 1, 0, 1, 55));
+
+  // setting the alarm sets AIE alone, and clears AF alone, in three
+  // transfers
+  chip.poke(CONTROL_1, CAP_SEL | CIE);
+  chip.poke(CONTROL_2, CTAIE | CTAF | CTBF | SF | AF);
+  uint32_t transfers = chip.transfers;
+  CHECK(rtc.setAlarm(DateTime(2024, 1, 1, 0, 2, 0), PCF8523_AlarmMinute));
+  CHECK(chip.transfers - transfers == 3);
+  CHECK(chip.peek(CONTROL_1) == (CAP_SEL | AIE | CIE));
+  CHECK(chip.written[CONTROL_2] == (CTAIE | CTAF | CTBF | SF));
+  CHECK(chip.peek(CONTROL_2) == (CTAIE | CTAF | CTBF | SF));
+  CHECK(chip.peek(ALARM) == 0x02 && chip.peek(ALARM + 1) & 0x80 &&
+        chip.peek(ALARM + 2) & 0x80 && chip.peek(ALARM + 3) & 0x80);
+  CHECK(rtc.getAlarmMode() == PCF8523_AlarmMinute);
+  CHECK(!rtc.setAlarm(DateTime(2024, 1, 1), 0));
+  chip.poke(CONTROL_2, CTAIE);
+
+  // the alarm fires at the start of the minute, and AF stays set
+  double waited = waitForAlarm(10);
+  CHECK(waited > 4.9 && waited < 5.1);
+  CHECK(rtc.now() == DateTime(2024, 1, 1, 0, 2, 0));
+  delay(2000);
+  CHECK(rtc.alarmFired());
+
+  // clearing AF writes 1 to the other flags
+  chip.poke(CONTROL_2, CTAIE | AF);
+  rtc.clearAlarm();
+  CHECK(chip.written[CONTROL_2] == (CTAIE | CTAF | CTBF | SF));
+  CHECK(chip.peek(CONTROL_2) == CTAIE);
+  CHECK(!rtc.alarmFired());
+
+  // a day of the month: 06:30 on the 9th, not on the 8th
+  CHECK(rtc.setAlarm(DateTime(2024, 1, 9, 6, 30, 0), PCF8523_AlarmMinute |
+                                                         PCF8523_AlarmHour |
+                                                         PCF8523_AlarmDay));
+  CHECK(rtc.getAlarmMode() ==
+        (PCF8523_AlarmMinute | PCF8523_AlarmHour | PCF8523_AlarmDay));
+  CHECK(rtc.getAlarm() == DateTime(2000, 5, 9, 6, 30, 0));
+  rtc.adjust(DateTime(2024, 1, 8, 6, 29, 50));
+  CHECK(!rtc.alarmFired());
+  CHECK(waitForAlarm(20) > 19);
+  rtc.adjust(DateTime(2024, 1, 9, 6, 29, 50));
+  waited = waitForAlarm(20);
+  CHECK(waited > 9.9 && waited < 10.1);
+  rtc.clearAlarm();
+
+  // a weekday alarm: Monday 00:00, from Sunday 23:59:50; adjust() writes
+  // the day of the week, 0 for Sunday
+  rtc.adjust(DateTime(2024, 1, 7, 23, 59, 50));
+  CHECK(chip.peek(0x07) == 0);
+  CHECK(rtc.setAlarm(DateTime(2024, 1, 1, 0, 0, 0), PCF8523_AlarmMinute |
+                                                        PCF8523_AlarmHour |
+                                                        PCF8523_AlarmWeekday));
+  CHECK(rtc.getAlarmMode() == (PCF8523_AlarmMinute | PCF8523_AlarmHour |
+                               PCF8523_AlarmWeekday));
+  CHECK(rtc.getAlarm() == DateTime(2000, 5, 1, 0, 0, 0));
+  waited = waitForAlarm(20);
+  CHECK(waited > 9.9 && waited < 10.1);
+  CHECK(rtc.now() == DateTime(2024, 1, 8));
+  CHECK(chip.peek(0x07) == 1);
+
+  // disabling the alarm clears AIE alone, and AF alone
+  chip.poke(CONTROL_2, CTAIE | CTAF | AF);
+  rtc.disableAlarm();
+  CHECK(chip.peek(CONTROL_1) == (CAP_SEL | CIE));
+  CHECK(chip.written[CONTROL_2] == (CTAIE | CTAF | CTBF | SF));
+  CHECK(chip.peek(CONTROL_2) == (CTAIE | CTAF));
+  CHECK(rtc.getAlarmMode() == 0);
+  for (uint8_t i = 0; i < 4; i++)
+    CHECK(chip.peek(ALARM + i) == 0x80);
+  rtc.adjust(DateTime(2024, 1, 8, 0, 59, 50));
+  CHECK(waitForAlarm(120) > 119);
+  return checkResult();
+}
@@ -0,0 +1,89 @@
+/*
+  RTC_PCF8523 drift calibration over a simulated PCF8523 with a drifting
+  oscillator. The offset units must be 4.340 ppm in PCF8523_TwoHours mode
+  and 4.069 ppm in PCF8523_OneMinute mode. A day of measureDrift() against
+  RTC_Micros must find the drift within 30 ppb. Once calibrate() is fed
+  with it, it must return the offset it wrote, and another day must find
+  what that offset leaves of the drift. Calibrating again from there must
+  keep the offset.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define WINDOW 86400 ///< Measurement window, in seconds
+#define MARGIN 30    ///< Precision of a measurement over the window, in ppb
+
+static SimPcf8523 chip;
+static RTC_PCF8523 rtc;
+static RTC_Micros reference;
+
+/**************************************************************************/
+/*!
+    @brief  Calibrate an oscillator from scratch, and check the result
+    @param drift Oscillator error, in ppb, positive if running fast
+    @param mode Offset mode expected from calibrate()
+    @param offset Offset expected from calibrate()
+    @return True if the drift, then what is left of it, are measured as
+    expected
+*/
+/**************************************************************************/
+static bool calibrates(int32_t drift, Pcf8523OffsetMode mode, int8_t offset) {
+  chip.driftPpb = drift;
+  rtc.calibrate(PCF8523_TwoHours, 0);
+  int32_t measured = measureDrift(rtc, reference, WINDOW);
+  if (rtc.calibrate(measured) != offset || abs(measured - drift) > MARGIN ||
+      rtc.readOffsetMode() != mode || rtc.readOffset() != offset) {
+    printf("%ld ppb: measured %ld, offset %d\n", (long)drift, (long)measured,
+           rtc.readOffset());
+    return false;
+  }
+  // the offset scales the oscillator, so the correction is off by
+  // drift * correction, 82 ppb at 300 ppm when saturated
+  int32_t unit = mode == PCF8523_OneMinute ? 4069 : 4340;
+  int32_t residual = measured - offset * unit;
+  int64_t product = (int64_t)drift * offset * unit / 1000000000;
+  int32_t remaining = measureDrift(rtc, reference, WINDOW);
+  if (abs(remaining - residual) > MARGIN + abs((int32_t)product)) {
+    printf("%ld ppb: residual %ld, measured %ld\n", (long)drift,
+           (long)residual, (long)remaining);
+    return false;
+  }
+  // calibrating again keeps the offset
+  rtc.calibrate(remaining);
+  return rtc.readOffsetMode() == mode && rtc.readOffset() == offset;
+}
+
+int main() {
+  CHECK(rtc.begin());
+  rtc.adjust(DateTime(2024, 1, 1));
+  reference.begin(DateTime(2024, 1, 1));
+
+  // offset units, on a perfect oscillator; a positive offset slows down
+  rtc.calibrate(PCF8523_TwoHours, 10);
+  CHECK(abs(measureDrift(rtc, reference, WINDOW) + 43400) <= MARGIN);
+  rtc.calibrate(PCF8523_OneMinute, 10);
+  CHECK(abs(measureDrift(rtc, reference, WINDOW) + 40690) <= MARGIN);
+  rtc.calibrate(PCF8523_TwoHours, -64);
+  CHECK(abs(measureDrift(rtc, reference, WINDOW) - 277760) <= MARGIN);
+
+  // PCF8523_OneMinute only when it leaves less: 37 ppm is 9 x 4.069 ppm +
+  // 379 ppb, but 9 x 4.340 ppm - 2060 ppb; 43.4 ppm is 10 x 4.340 ppm
+  CHECK(calibrates(37000, PCF8523_OneMinute, 9));
+  CHECK(calibrates(-20000, PCF8523_OneMinute, -5));
+  CHECK(calibrates(43400, PCF8523_TwoHours, 10));
+  CHECK(calibrates(-1000, PCF8523_TwoHours, 0));
+  // beyond the range, the offset saturates and the rest is left over
+  CHECK(calibrates(300000, PCF8523_TwoHours, 63));
+  CHECK(calibrates(-300000, PCF8523_TwoHours, -64));
+
+  // calibrate() starts from the offset in place, so that a drift measured
+  // with a correction running is added to it
+  chip.driftPpb = 37000;
+  rtc.calibrate(PCF8523_TwoHours, 5);
+  CHECK(rtc.calibrate(37000 - 5 * 4340) == 9);
+  CHECK(rtc.readOffsetMode() == PCF8523_OneMinute && rtc.readOffset() == 9);
+  CHECK(abs(measureDrift(rtc, reference, WINDOW) - 379) <= MARGIN);
+  return checkResult();
+}
@@ -0,0 +1,205 @@
+/*
+  Pcf8523Countdown plans, and their run on a simulated PCF8523. Over random
+  durations up to 49 days, the reported error and uncertainty must match
+  the plan read back from the accessors, the latter being a period of each
+  clock of 1 Hz or slower a stage starts on. By default, wake-ups must stay
+  within one of the fewest possible, and the worst error, early or late,
+  within half the uncertainty plus 4e-3 of the duration from 100 ms, or
+  half a 4096 Hz period below. startCountdown() and updateCountdown(),
+  polled at a fixed step, must then take the planned duration, less up to
+  the uncertainty, give or take one step and the bus time of servicing it
+  per wake-up, and leave both timers stopped.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define UNITS_PER_MS 512ULL ///< Planner units, of 1/512000 s, per ms
+#define LONGEST (1843200000ULL * 255) ///< Longest stage, 255 hours, in units
+#define CLKOUT 0x0F                 ///< Timer and CLKOUT control register
+
+/** Period of each #PCF8523TimerClockFreq, in planner units */
+static const uint64_t periods[5] = {125, 8000, 512000, 30720000, 1843200000};
+
+static uint32_t seed = 1;
+static uint32_t random32() {
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) ^ (seed << 20);
+}
+
+/** Duration of a plan, from its accessors, in planner units */
+static uint64_t planned(const Pcf8523Countdown &c) {
+  return c.repeats() * c.longPeriods() * periods[c.longFreq()] +
+         c.shortPeriods() * periods[c.shortFreq()];
+}
+
+/** Worst error of a plan, at its latest or earliest end, in microseconds */
+static int64_t worst(const Pcf8523Countdown &c) {
+  int64_t latest = c.errorMicros();
+  int64_t earliest = latest - (int64_t)c.uncertaintyMicros();
+  return latest > -earliest ? latest : -earliest;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Plan a duration and check the properties every plan must have
+    @param c Countdown to plan
+    @param millis Duration, in milliseconds
+    @param maxErrorMillis Accepted error, or 0
+    @return True if the plan is consistent and within its bounds
+*/
+/**************************************************************************/
+static bool plans(Pcf8523Countdown &c, uint32_t millis,
+                  uint32_t maxErrorMillis = 0) {
+  uint64_t target = millis * UNITS_PER_MS;
+  if (!c.plan(millis, maxErrorMillis) || c.repeats() < 1 ||
+      c.longPeriods() < 1 ||
+      c.wakeups() != c.repeats() + (c.shortPeriods() ? 1 : 0))
+    return false;
+  // 1 unit = 125/64 us, saturated past 35 minutes
+  int64_t micros = (int64_t)(planned(c) - target) * 125 / 64;
+  if (c.errorMicros() != (micros > INT32_MAX   ? INT32_MAX
+                          : micros < INT32_MIN ? INT32_MIN
+                                               : micros))
+    return false;
+  // the first period of Timer A, then of Timer B, may be short
+  uint64_t spread = c.longFreq() >= PCF8523_FrequencySecond
+                        ? periods[c.longFreq()]
+                        : 0;
+  if (c.shortPeriods() && c.shortFreq() >= PCF8523_FrequencySecond)
+    spread += periods[c.shortFreq()];
+  if (c.uncertaintyMicros() != spread * 125 / 64)
+    return false;
+  // a limit trades wake-ups for accuracy, so only default plans are bound
+  if (maxErrorMillis || micros != c.errorMicros())
+    return true;
+  uint64_t fewest = (target + LONGEST - 1) / LONGEST;
+  if (c.wakeups() > fewest + 1)
+    return false;
+  // plans aim for the middle of the uncertainty, and the coarse counts
+  // of two stages leave up to about 4e-3 of the duration around it
+  return worst(c) <= (int64_t)(c.uncertaintyMicros() / 2 +
+                               (millis < 100 ? 122 : millis * 4ULL));
+}
+
+/** Poll a running countdown at a fixed step, and return the seconds taken */
+static double run(RTC_PCF8523 &rtc, Pcf8523Countdown &c, uint32_t stepMillis) {
+  rtc.startCountdown(c);
+  uint64_t start = simNanos;
+  while (!rtc.updateCountdown(c))
+    delay(stepMillis);
+  return (simNanos - start) * 1e-9;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Run a planned countdown on the simulated chip
+    @param rtc RTC of the simulated chip
+    @param chip Simulated chip
+    @param c Planned countdown
+    @param millis Duration it was planned for, in milliseconds
+    @param stepMillis Polling step, in milliseconds
+    @return True if it elapsed on time and stopped both timers
+*/
+/**************************************************************************/
+static bool runs(RTC_PCF8523 &rtc, SimPcf8523 &chip, Pcf8523Countdown &c,
+                 uint32_t millis, uint32_t stepMillis) {
+  double latest = millis * 1e-3 + c.errorMicros() * 1e-6;
+  double earliest = latest - c.uncertaintyMicros() * 1e-6;
+  double took = run(rtc, c, stepMillis);
+  // each wake-up is seen up to a step late, and servicing it takes about
+  // ten transfers, 3 ms at 100 kHz
+  double late = c.wakeups() * (stepMillis + 4) * 1e-3;
+  if (took < earliest - 1e-3 || took > latest + late) {
+    printf("%u ms: %.4f s instead of %.4f to %.4f s\n", millis, took,
+           earliest, latest);
+    return false;
+  }
+  return (chip.peek(CLKOUT) & 0x07) == 0 && (chip.peek(0x01) & 0x60) == 0;
+}
+
+int main() {
+  Pcf8523Countdown c;
+
+  // nothing to plan
+  CHECK(!c.plan(0) && !c.plan(TimeSpan(0)) && !c.plan(TimeSpan(-5)));
+
+  // durations the 4096 Hz and 64 Hz clocks reach are exact, in as few
+  // wake-ups as possible
+  CHECK(plans(c, 1000) && c.wakeups() == 1 && c.errorMicros() == 0 &&
+        c.uncertaintyMicros() == 0);
+  CHECK(plans(c, 5000) && c.wakeups() == 2 && c.errorMicros() == 0 &&
+        c.uncertaintyMicros() == 0);
+  // past them, a second of uncertainty on Timer A is halved by half a
+  // second on Timer B
+  CHECK(plans(c, 60000) && c.wakeups() == 2 && c.errorMicros() == 500000 &&
+        c.uncertaintyMicros() == 1000000);
+  // an hour: 60 minutes, then 31 s, a minute and a second uncertain
+  CHECK(plans(c, 3600000) && c.longFreq() == PCF8523_FrequencyMinute &&
+        c.longPeriods() == 60 && c.shortFreq() == PCF8523_FrequencySecond &&
+        c.shortPeriods() == 31 && c.errorMicros() == 31000000 &&
+        c.uncertaintyMicros() == 61000000);
+  // 30 days: three 240-hour stages alone would be up to an hour short
+  CHECK(c.plan(TimeSpan(30, 0, 0, 0)) && c.wakeups() == 4 &&
+        c.longFreq() == PCF8523_FrequencyHour &&
+        worst(c) == 1860000000LL);
+
+  // 1000.3 s: a limit covering the default plan keeps it, a tighter one
+  // buys accuracy with wake-ups, down to the 4096 Hz clock
+  CHECK(plans(c, 1000300) && c.wakeups() == 2 && worst(c) == 30700000);
+  CHECK(plans(c, 1000300, 30700) && c.wakeups() == 2);
+  CHECK(plans(c, 1000300, 30000) && c.wakeups() == 4 &&
+        worst(c) <= 30000000);
+  CHECK(plans(c, 1000300, 300) && c.wakeups() == 252 && worst(c) <= 300000);
+
+  // every duration below a second, then random ones up to 49 days, by
+  // decade; a given limit must never cost wake-ups over the default plan
+  // when the default plan is within it
+  for (uint32_t millis = 1; millis < 1000; millis++)
+    CHECK(plans(c, millis));
+  for (uint32_t i = 0; i < 300000; i++) {
+    uint32_t decade = 1000;
+    for (uint32_t d = random32() % 7; d > 0; d--)
+      decade *= 10;
+    uint32_t millis = 1 + random32() % (decade < 4233600000UL / 10
+                                            ? decade * 10
+                                            : 4233600000UL);
+    Pcf8523Countdown limited;
+    uint32_t limit = 1 + random32() % 1000;
+    CHECK(plans(c, millis) && plans(limited, millis, limit));
+    if (worst(c) <= (int64_t)limit * 1000)
+      CHECK(limited.wakeups() <= c.wakeups() &&
+            worst(limited) <= (int64_t)limit * 1000);
+    if (millis % 1000 == 0) {
+      Pcf8523Countdown span;
+      CHECK(span.plan(TimeSpan(millis / 1000), limit) &&
+            span.wakeups() == limited.wakeups() &&
+            span.errorMicros() == limited.errorMicros() &&
+            span.uncertaintyMicros() == limited.uncertaintyMicros());
+    }
+  }
+
+  // on the chip: the long stage on Timer A, then the short one on Timer B
+  SimPcf8523 chip;
+  RTC_PCF8523 rtc;
+  CHECK(rtc.begin());
+  rtc.adjust(DateTime(2024, 1, 1));
+  CHECK(plans(c, 100) && c.shortPeriods());
+  CHECK(runs(rtc, chip, c, 100, 1));
+  CHECK(plans(c, 1000300) && runs(rtc, chip, c, 1000300, 10));
+  CHECK(plans(c, 1000300, 300) && runs(rtc, chip, c, 1000300, 10));
+  CHECK(plans(c, 12 * 86400000 + 12345) && c.repeats() > 1 &&
+        c.shortPeriods() && runs(rtc, chip, c, 12 * 86400000 + 12345, 1000));
+  // the same countdown can be run again
+  CHECK(runs(rtc, chip, c, 12 * 86400000 + 12345, 1000));
+
+  // an hour started 45.4 s into a minute: Timer A fires at the next minute,
+  // then 59 minutes later, and Timer B, started on that second, runs 31 s
+  rtc.adjust(DateTime(2024, 1, 1, 0, 0, 45));
+  delay(400);
+  CHECK(plans(c, 3600000));
+  double took = run(rtc, c, 10);
+  CHECK(took > 3585.6 && took < 3585.7);
+  return checkResult();
+}
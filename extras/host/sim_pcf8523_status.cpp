@@ -0,0 +1,137 @@
+/*
+  RTC_PCF8523 status and battery switchover over a simulated PCF8523:
+  readStatus() must decode every flag on its own, in a single transfer, and
+  clear WTAF alone. Switching modes must keep the battery flags and
+  interrupt enables, the two PM codes no mode is written as must read as
+  the mode they act as, only clearBatterySwitchover() may clear BSF, and a
+  restored snapshot must leave every flag as it is.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define CONTROL_1 0x00 ///< Control_1 register
+#define CONTROL_2 0x01 ///< Control_2 register
+#define CONTROL_3 0x02 ///< Control_3 register
+#define SECONDS 0x03   ///< Seconds register, with OS in bit 7
+#define BLIE 0x01      ///< Battery low interrupt enable
+#define BSIE 0x02      ///< Battery switchover interrupt enable
+#define BLF 0x04       ///< Battery low flag, read-only
+#define BSF 0x08       ///< Battery switchover flag
+#define CTAIE 0x02     ///< Timer A countdown interrupt enable
+#define AF 0x08        ///< Alarm flag
+#define SF 0x10        ///< Second timer flag
+#define CTBF 0x20      ///< Timer B flag
+#define CTAF 0x40      ///< Timer A countdown flag
+#define WTAF 0x80      ///< Timer A watchdog flag
+
+static SimPcf8523 chip;
+static RTC_PCF8523 rtc;
+
+/** Pack the flags of a status, in the order of Pcf8523Status */
+static uint8_t flags(const Pcf8523Status &s) {
+  return s.batteryLow | s.batterySwitchover << 1 | s.oscillatorStopped << 2 |
+         s.stopped << 3 | s.alarmFired << 4 | s.secondFired << 5 |
+         s.timerAFired << 6 | s.timerBFired << 7;
+}
+
+/** Read the status, checking that it takes a single transfer */
+static Pcf8523Status status() {
+  uint32_t transfers = chip.transfers;
+  Pcf8523Status s = rtc.readStatus();
+  CHECK(chip.transfers - transfers == 1);
+  return s;
+}
+
+int main() {
+  CHECK(rtc.begin());
+  CHECK(status().oscillatorStopped);
+  CHECK(status().switchover == PCF8523_SwitchoverDisabledNoBLD);
+
+  // adjust() replaces the power-on mode, and keeps one chosen afterwards
+  rtc.adjust(DateTime(2024, 1, 1));
+  CHECK(rtc.readSwitchoverMode() == PCF8523_SwitchoverStandard);
+  Pcf8523Status s = status();
+  CHECK(s.switchover == PCF8523_SwitchoverStandard && flags(s) == 0);
+  rtc.writeSwitchoverMode(PCF8523_SwitchoverDirect);
+  rtc.adjust(DateTime(2024, 1, 1));
+  CHECK(rtc.readSwitchoverMode() == PCF8523_SwitchoverDirect);
+
+  // each flag is decoded on its own
+  static const struct {
+    uint8_t reg, bit;
+  } bits[] = {{CONTROL_3, BLF}, {CONTROL_3, BSF}, {SECONDS, 0x80},
+              {CONTROL_1, 0x20}, {CONTROL_2, AF}, {CONTROL_2, SF},
+              {CONTROL_2, CTAF}, {CONTROL_2, CTBF}};
+  for (uint8_t i = 0; i < 8; i++) {
+    uint8_t saved = chip.peek(bits[i].reg);
+    chip.poke(bits[i].reg, saved | bits[i].bit);
+    s = status();
+    CHECK(flags(s) == 1 << i && s.switchover == PCF8523_SwitchoverDirect);
+    chip.poke(bits[i].reg, saved);
+  }
+  // WTAF counts as Timer A, and the read clears it alone
+  chip.poke(CONTROL_2, WTAF | CTAF | CTAIE);
+  CHECK(flags(status()) == 1 << 6);
+  CHECK(chip.peek(CONTROL_2) == (CTAF | CTAIE));
+  chip.poke(CONTROL_2, WTAF);
+  CHECK(flags(status()) == 1 << 6);
+  CHECK(flags(status()) == 0);
+
+  // every mode reads back, keeping the flags and interrupt enables
+  static const Pcf8523SwitchoverMode modes[] = {
+      PCF8523_SwitchoverStandard,    PCF8523_SwitchoverDirect,
+      PCF8523_SwitchoverDisabled,    PCF8523_SwitchoverStandardNoBLD,
+      PCF8523_SwitchoverDirectNoBLD, PCF8523_SwitchoverDisabledNoBLD};
+  chip.poke(CONTROL_3, BSF | BLF | BSIE | BLIE);
+  for (uint8_t i = 0; i < 6; i++) {
+    rtc.writeSwitchoverMode(modes[i]);
+    CHECK(rtc.readSwitchoverMode() == modes[i]);
+    CHECK(chip.peek(CONTROL_3) == (modes[i] | BSF | BLF | BSIE | BLIE));
+    s = status();
+    CHECK(s.switchover == modes[i] && s.batterySwitchover && s.batteryLow);
+  }
+
+  // 011 disables switchover as 010 does; 110, not allowed, reads by its
+  // bits, switchover and BLD disabled
+  chip.poke(CONTROL_3, 0x60 | BSF | BLF | BSIE | BLIE);
+  CHECK(rtc.readSwitchoverMode() == PCF8523_SwitchoverDisabled);
+  s = status();
+  CHECK(s.switchover == PCF8523_SwitchoverDisabled && s.batterySwitchover &&
+        s.batteryLow);
+  chip.poke(CONTROL_3, 0xC0 | BSF | BLF | BSIE | BLIE);
+  CHECK(rtc.readSwitchoverMode() == PCF8523_SwitchoverDisabledNoBLD);
+  s = status();
+  CHECK(s.switchover == PCF8523_SwitchoverDisabledNoBLD &&
+        s.batterySwitchover && s.batteryLow);
+
+  // clearing BSF leaves the mode, BLF and the enables
+  rtc.writeSwitchoverMode(PCF8523_SwitchoverStandard);
+  rtc.clearBatterySwitchover();
+  CHECK(chip.peek(CONTROL_3) == (BLF | BSIE | BLIE));
+  CHECK(!status().batterySwitchover);
+
+  // restoring a snapshot brings the settings back, not the flags
+  chip.poke(CONTROL_3, BSIE);
+  chip.poke(CONTROL_2, CTAIE);
+  CHECK(rtc.setAlarm(DateTime(2024, 1, 1, 6, 30, 0), PCF8523_AlarmHour));
+  rtc.calibrate(PCF8523_OneMinute, -7);
+  Pcf8523Snapshot snap = rtc.snapshot();
+  rtc.writeSwitchoverMode(PCF8523_SwitchoverDirect);
+  rtc.disableAlarm();
+  rtc.calibrate(PCF8523_TwoHours, 0);
+  chip.poke(CONTROL_2, CTAF | CTBF | SF | AF);
+  chip.poke(CONTROL_3, chip.peek(CONTROL_3) | BSF | BLF);
+  DateTime before = rtc.now();
+  uint32_t transfers = chip.transfers;
+  rtc.restore(snap);
+  CHECK(chip.transfers - transfers == 2);
+  CHECK(chip.peek(CONTROL_3) ==
+        (PCF8523_SwitchoverStandard | BSF | BLF | BSIE));
+  CHECK(chip.peek(CONTROL_2) == (CTAF | CTBF | SF | AF | CTAIE));
+  CHECK(rtc.getAlarmMode() == PCF8523_AlarmHour);
+  CHECK(rtc.readOffsetMode() == PCF8523_OneMinute && rtc.readOffset() == -7);
+  CHECK(rtc.now() == before);
+  return checkResult();
+}
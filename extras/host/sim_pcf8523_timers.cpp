@@ -0,0 +1,149 @@
+/*
+  Timer A of RTC_PCF8523 over a simulated PCF8523, in countdown and
+  watchdog modes, next to Timer B: each timer must fire on time whatever
+  the other does, enabling Timer A must take five transfers and feeding the
+  watchdog one, and the Control_2 writes must put 1 in the flags they leave
+  alone, as writing 0 clears them. On the 1 Hz and 1/60 Hz clocks, which
+  run on, the first period must end at the next tick of the time counter.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define CONTROL_2 0x01 ///< Control_2 register
+#define CLKOUT 0x0F    ///< Timer and CLKOUT control register
+#define CTBIE 0x01     ///< Timer B interrupt enable
+#define CTAIE 0x02     ///< Timer A countdown interrupt enable
+#define WTAIE 0x04     ///< Timer A watchdog interrupt enable
+#define AF 0x08        ///< Alarm flag
+#define SF 0x10        ///< Second timer flag
+#define CTBF 0x20      ///< Timer B flag
+#define CTAF 0x40      ///< Timer A countdown flag
+#define WTAF 0x80      ///< Timer A watchdog flag
+
+static SimPcf8523 chip;
+static RTC_PCF8523 rtc;
+
+/** Run for a while, counting the Timer A and Timer B flags every 10 ms */
+static void run(uint32_t ms, unsigned &firedA, unsigned &firedB) {
+  for (uint32_t t = 0; t < ms; t += 10) {
+    delay(10);
+    uint8_t control = chip.peek(CONTROL_2);
+    if (control & CTAF)
+      firedA++;
+    if (control & CTBF)
+      firedB++;
+    chip.poke(CONTROL_2, control & ~(CTAF | CTBF));
+  }
+}
+
+/** Poll CTAF every 10 ms, clear it, and return the milliseconds it took */
+static uint32_t waitForTimerA(uint32_t limit) {
+  uint32_t ms = 0;
+  while (!(chip.peek(CONTROL_2) & CTAF) && ms < limit) {
+    delay(10);
+    ms += 10;
+  }
+  chip.poke(CONTROL_2, chip.peek(CONTROL_2) & ~CTAF);
+  return ms;
+}
+
+int main() {
+  CHECK(rtc.begin());
+  rtc.adjust(DateTime(2024, 1, 1));
+
+  // Timer A every 5 s, in five transfers; CTAF is cleared, the other flags
+  // are written 1
+  chip.poke(CONTROL_2, CTAF | CTBF | AF);
+  uint32_t transfers = chip.transfers;
+  rtc.enableCountdownTimerA(PCF8523_FrequencySecond, 5);
+  CHECK(chip.transfers - transfers == 5);
+  CHECK(chip.written[CONTROL_2] == (AF | SF | CTBF | CTAIE));
+  CHECK(chip.peek(CONTROL_2) == (AF | CTBF | CTAIE));
+  CHECK((chip.peek(CLKOUT) & 0x06) == 0x02 && chip.peek(0x10) == 2 &&
+        chip.peek(0x11) == 5);
+  chip.poke(CONTROL_2, CTAIE);
+
+  // Timer B every 0.5 s alongside; each fires at its own rate
+  rtc.enableCountdownTimer(PCF8523_Frequency64Hz, 32);
+  CHECK((chip.peek(CLKOUT) & 0x07) == 0x03);
+  CHECK(chip.peek(CONTROL_2) == (CTAIE | CTBIE));
+  unsigned firedA = 0, firedB = 0;
+  run(20000, firedA, firedB);
+  CHECK(firedA == 4 && firedB == 40);
+
+  // stopping Timer B leaves Timer A running, and the other way round
+  rtc.disableCountdownTimer();
+  firedA = firedB = 0;
+  run(20000, firedA, firedB);
+  CHECK(firedA == 4 && firedB == 0);
+  rtc.enableCountdownTimer(PCF8523_Frequency64Hz, 32);
+  rtc.disableTimerA();
+  firedA = firedB = 0;
+  run(20000, firedA, firedB);
+  CHECK(firedA == 0 && firedB == 40);
+  rtc.disableCountdownTimer();
+  CHECK(chip.peek(CONTROL_2) == (CTAIE | CTBIE)); // enables left as they are
+  chip.poke(CONTROL_2, CTAIE);
+
+  // timerAFired() clears CTAF only
+  rtc.enableCountdownTimerA(PCF8523_FrequencySecond, 2);
+  delay(2100);
+  chip.poke(CONTROL_2, chip.peek(CONTROL_2) | AF);
+  CHECK(rtc.timerAFired());
+  CHECK(chip.written[CONTROL_2] == (CTAIE | AF | SF | CTBF));
+  CHECK(chip.peek(CONTROL_2) == (CTAIE | AF));
+  CHECK(!rtc.timerAFired());
+  rtc.disableTimerA();
+  chip.poke(CONTROL_2, 0);
+
+  // the watchdog never fires while fed every 2 s, in one transfer each
+  transfers = chip.transfers;
+  rtc.enableWatchdogTimer(PCF8523_FrequencySecond, 3);
+  CHECK(chip.transfers - transfers == 5);
+  CHECK((chip.peek(CLKOUT) & 0x06) == 0x04);
+  CHECK(chip.peek(CONTROL_2) == WTAIE);
+  for (int i = 0; i < 30; i++) {
+    delay(2000);
+    transfers = chip.transfers;
+    rtc.feedWatchdog(3);
+    CHECK(chip.transfers - transfers == 1);
+    CHECK(!(chip.peek(CONTROL_2) & WTAF));
+  }
+  // left alone, it fires once, 2 to 3 s after the last feed as the first
+  // period is cut short; reading Control_2 clears WTAF
+  delay(1900);
+  CHECK(!rtc.timerAFired());
+  delay(1200);
+  CHECK(chip.peek(CONTROL_2) == (WTAIE | WTAF));
+  CHECK(rtc.timerAFired());
+  CHECK(chip.peek(CONTROL_2) == WTAIE);
+  delay(10000);
+  CHECK(!rtc.timerAFired());
+  // feeding restarts it
+  rtc.feedWatchdog(3);
+  delay(3100);
+  CHECK(rtc.timerAFired());
+  rtc.disableTimerA();
+  chip.poke(CONTROL_2, 0);
+
+  // on the 1 Hz and 1/60 Hz clocks, the first period ends at the next
+  // second or minute of the time counter, the following ones are whole
+  rtc.adjust(DateTime(2024, 1, 1, 0, 0, 45));
+  delay(400);
+  rtc.enableCountdownTimerA(PCF8523_FrequencySecond, 3);
+  CHECK(waitForTimerA(5000) == 2600 && waitForTimerA(5000) == 3000);
+  rtc.enableCountdownTimerA(PCF8523_FrequencyMinute, 2);
+  CHECK(waitForTimerA(200000) == 69000 && waitForTimerA(200000) == 120000);
+  rtc.disableTimerA();
+
+  // deconfigureAllTimers() stops everything
+  rtc.enableCountdownTimerA(PCF8523_Frequency64Hz, 16);
+  rtc.enableCountdownTimer(PCF8523_Frequency64Hz, 16);
+  rtc.deconfigureAllTimers();
+  firedA = firedB = 0;
+  run(2000, firedA, firedB);
+  CHECK(firedA == 0 && firedB == 0 && chip.peek(CONTROL_2) == 0);
+  return checkResult();
+}
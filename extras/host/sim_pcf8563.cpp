@@ -0,0 +1,137 @@
+/*
+  RTC_PCF8563 alarm and countdown timer over a simulated PCF8563: the
+  alarm and the timer must fire on time, and every write to Control_2 must
+  put 1 in the flags it leaves alone, as writing 0 clears them.
+  readAndClearFlags() must take a single transfer when no flag is set, and
+  one more to clear those that are.
+*/
+
+#include "RTClib.h"
+#include "SimBus.h"
+#include "harness.h"
+
+#define CONTROL_2 0x01 ///< Control_2 register
+#define TF 0x04        ///< Timer flag
+#define AF 0x08        ///< Alarm flag
+#define AIE 0x02       ///< Alarm interrupt enable
+#define TIE 0x01       ///< Timer interrupt enable
+#define TI_TP 0x10     ///< Timer pulse mode
+
+static SimPcf8563 chip;
+static RTC_PCF8563 rtc;
+
+/** Poll a flag every 10 ms, and return the seconds it took to come up */
+static double waitFor(bool (RTC_PCF8563::*fired)(), double limit) {
+  uint64_t start = simNanos;
+  while (!(rtc.*fired)() && simNanos - start < limit * 1e9)
+    delay(10);
+  return (simNanos - start) * 1e-9;
+}
+
+int main() {
+  CHECK(rtc.begin());
+  CHECK(rtc.lostPower());
+  rtc.adjust(DateTime(2024, 1, 1, 0, 1, 55));
+  CHECK(!rtc.lostPower());
+
+  // setting the alarm clears AF, and leaves TF set
+  chip.poke(CONTROL_2, AF | TF);
+  CHECK(rtc.setAlarm(DateTime(2024, 1, 1, 0, 2, 0), PCF8563_AlarmMinute));
+  CHECK(chip.written[CONTROL_2] == (TF | AIE));
+  CHECK(chip.peek(CONTROL_2) == (TF | AIE));
+  CHECK(chip.peek(0x09) == 0x02 && chip.peek(0x0A) & 0x80 &&
+        chip.peek(0x0B) & 0x80 && chip.peek(0x0C) & 0x80);
+  CHECK(rtc.getAlarmMode() == PCF8563_AlarmMinute);
+  CHECK(!rtc.setAlarm(DateTime(2024, 1, 1), 0));
+
+  // the alarm fires at the start of the minute
+  double waited = waitFor(&RTC_PCF8563::alarmFired, 10);
+  CHECK(waited > 4.9 && waited < 5.1);
+  CHECK(rtc.now() == DateTime(2024, 1, 1, 0, 2, 0));
+
+  // clearing one flag writes 1 to the other
+  rtc.clearAlarm();
+  CHECK(chip.written[CONTROL_2] == (TF | AIE));
+  CHECK(chip.peek(CONTROL_2) == (TF | AIE));
+  rtc.clearCountdownTimer();
+  CHECK(chip.written[CONTROL_2] == (AF | AIE));
+  CHECK(chip.peek(CONTROL_2) == AIE);
+  // even when it reads as clear, in case it comes up in between
+  chip.poke(CONTROL_2, AIE | AF);
+  rtc.clearAlarm();
+  CHECK(chip.written[CONTROL_2] == (TF | AIE));
+  chip.poke(CONTROL_2, AIE | TF);
+  rtc.clearCountdownTimer();
+  CHECK(chip.written[CONTROL_2] == (AF | AIE));
+
+  // readAndClearFlags(): one transfer without flags, two with, writing 0
+  // only to the flags read as set
+  uint32_t transfers = chip.transfers;
+  CHECK(rtc.readAndClearFlags() == 0);
+  CHECK(chip.transfers - transfers == 1);
+  chip.poke(CONTROL_2, AIE | AF);
+  transfers = chip.transfers;
+  CHECK(rtc.readAndClearFlags() == PCF8563_AlarmFlag);
+  CHECK(chip.transfers - transfers == 2);
+  CHECK(chip.written[CONTROL_2] == (TF | AIE));
+  CHECK(chip.peek(CONTROL_2) == AIE);
+  chip.poke(CONTROL_2, AIE | AF | TF);
+  CHECK(rtc.readAndClearFlags() == (PCF8563_AlarmFlag | PCF8563_TimerFlag));
+  CHECK(chip.written[CONTROL_2] == AIE);
+  CHECK(chip.peek(CONTROL_2) == AIE);
+
+  // a weekday alarm: Monday 00:00, from Sunday 23:59:50
+  rtc.adjust(DateTime(2024, 1, 7, 23, 59, 50));
+  CHECK(rtc.setAlarm(DateTime(2024, 1, 1, 0, 0, 0), PCF8563_AlarmMinute |
+                                                        PCF8563_AlarmHour |
+                                                        PCF8563_AlarmWeekday));
+  CHECK(rtc.getAlarmMode() == (PCF8563_AlarmMinute | PCF8563_AlarmHour |
+                               PCF8563_AlarmWeekday));
+  CHECK(rtc.getAlarm() == DateTime(2000, 5, 1, 0, 0, 0));
+  waited = waitFor(&RTC_PCF8563::alarmFired, 20);
+  CHECK(waited > 9.9 && waited < 10.1);
+  CHECK(rtc.now() == DateTime(2024, 1, 8));
+
+  // disabling the alarm leaves both flags alone
+  rtc.disableAlarm();
+  CHECK(chip.written[CONTROL_2] == (AF | TF));
+  CHECK(chip.peek(CONTROL_2) == AF);
+  CHECK(rtc.getAlarmMode() == 0);
+  rtc.clearAlarm();
+
+  // the countdown timer fires after 10 s, then every 10 s; enabling it
+  // clears TF and leaves AF set
+  chip.poke(CONTROL_2, AF | TF);
+  rtc.enableCountdownTimer(PCF8563_FrequencySecond, 10, false);
+  CHECK(chip.written[CONTROL_2] == (AF | TIE));
+  CHECK(chip.peek(CONTROL_2) == (AF | TIE));
+  delay(3000);
+  CHECK(rtc.readCountdownTimer() == 7);
+  waited = waitFor(&RTC_PCF8563::countdownFired, 20);
+  CHECK(waited > 6.9 && waited < 7.1);
+  CHECK(rtc.readAndClearFlags() == (PCF8563_AlarmFlag | PCF8563_TimerFlag));
+  waited = waitFor(&RTC_PCF8563::countdownFired, 20);
+  CHECK(waited > 9.9 && waited < 10.1);
+
+  // pulse mode sets TI_TP; disabling clears TIE and TI_TP, not the flags
+  rtc.enableCountdownTimer(PCF8563_Frequency64Hz, 32, true);
+  CHECK(chip.peek(CONTROL_2) == (TIE | TI_TP));
+  waited = waitFor(&RTC_PCF8563::countdownFired, 20);
+  CHECK(waited > 0.49 && waited < 0.52);
+  rtc.disableCountdownTimer();
+  CHECK(chip.written[CONTROL_2] == (AF | TF));
+  CHECK(chip.peek(CONTROL_2) == TF);
+  CHECK(chip.peek(0x0E) == PCF8563_FrequencyMinute);
+  rtc.clearCountdownTimer();
+  delay(5000);
+  CHECK(!rtc.countdownFired());
+
+  // restoring a snapshot leaves the flags as they are
+  rtc.setAlarm(DateTime(2024, 1, 8, 6, 30, 0), PCF8563_AlarmHour);
+  Pcf8563Snapshot snap = rtc.snapshot();
+  chip.poke(CONTROL_2, AIE | AF | TF);
+  rtc.restore(snap);
+  CHECK(chip.peek(CONTROL_2) == (AIE | AF | TF));
+  CHECK(rtc.getAlarmMode() == PCF8563_AlarmHour);
+  return checkResult();
+}
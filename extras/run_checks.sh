@@ -0,0 +1,74 @@
+#!/bin/sh
+# Build and run the host checks and benchmarks of RTClib on Linux.
+#
+# extras/host/*.cpp are linked with a Linux host build of the library,
+# where ARDUINO is not defined and the I2C drivers compile to nothing.
+# Programs named sim_*.cpp are linked instead with an Arduino build of the
+# library, on top of the simulated core and I2C bus of extras/host/arduino,
+# so that they can drive the chip models of SimBus.h.
+# Host programs can also include "zones.h", the CompiledTimeZone tables of
+# the ZONES below, compiled by tzcompile.py from the local tzdata.
+#
+# Usage: extras/run_checks.sh [name...]
+# Without names, every program is run; e.g. extras/run_checks.sh bench_clock
+# runs a single one. The exit status is non-zero if any check fails.
+
+here=$(cd "$(dirname "$0")" && pwd)
+src="$here/../src"
+sim="$here/host/arduino"
+out="${TMPDIR:-/tmp}/rtclib-checks"
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--std=gnu++11 -O2 -Wall -Wextra}"
+status=0
+ZONES="Europe/Paris America/New_York Australia/Lord_Howe Africa/Casablanca
+  America/Nuuk Asia/Tehran Pacific/Chatham Europe/Dublin"
+
+# build the library once per mode: build <mode> <flags...>
+build() {
+  mode=$1
+  shift
+  mkdir -p "$out/$mode"
+  for f in "$src"/*.cpp; do
+    $CXX $CXXFLAGS "$@" -I"$src" -c "$f" \
+      -o "$out/$mode/$(basename "$f" .cpp).o" || exit 1
+  done
+}
+
+# build and run one program: check <mode> <file> <flags...>
+check() {
+  mode=$1
+  file=$2
+  shift 2
+  name=$(basename "$file" .cpp)
+  if [ -n "$names" ] && ! echo " $names " | grep -q " $name "; then
+    return
+  fi
+  echo "== $mode/$name"
+  if $CXX $CXXFLAGS "$@" -I"$src" -I"$here" "$file" "$out/$mode"/*.o \
+    -o "$out/$mode/$name"; then
+    "$out/$mode/$name" || status=1
+  else
+    status=1
+  fi
+}
+
+names="$*"
+
+build host
+python3 "$here/tzcompile.py" -o "$out/host/zones" $ZONES || exit 1
+$CXX $CXXFLAGS -I"$src" -c "$out/host/zones.cpp" -o "$out/host/zones.o" ||
+  exit 1
+build sim -DARDUINO -I"$sim"
+for f in "$sim"/*.cpp; do
+  $CXX $CXXFLAGS -DARDUINO -I"$sim" -I"$src" -c "$f" \
+    -o "$out/sim/$(basename "$f" .cpp).o" || exit 1
+done
+
+for f in "$here"/host/*.cpp; do
+  case $(basename "$f") in
+  sim_*) check sim "$f" -DARDUINO -I"$sim" ;;
+  *) check host "$f" -I"$out/host" ;;
+  esac
+done
+
+exit $status
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""Compile tzdata zones into transition tables for RTClib's CompiledTimeZone.
+
+Reads the compiled zone files (TZif) of a local tzdata copy, finds every
+change of UTC offset or DST flag between 2000 and 2099 among the
+transitions the file lists and those of its footer rule, and writes a
+header and a source file defining one PROGMEM TzTable per zone:
+
+    extras/tzcompile.py -o zones Europe/Paris America/New_York
+
+Add the generated zones.h and zones.cpp to the sketch, then:
+
+    #include "zones.h"
+    CompiledTimeZone tz;
+    tz.begin(tz_Europe_Paris);
+
+Requires Python 3.9 or later.
+"""
+
+import argparse
+import datetime
+import io
+import os
+import re
+import struct
+import sys
+import zoneinfo
+
+START = 946684800  # 2000-01-01 00:00:00 UTC
+END = 4102444800  # 2100-01-01 00:00:00 UTC
+ANCHOR_INTERVAL = 16  # must match TZTABLE_ANCHOR_INTERVAL
+QUARTER = 900
+MAX_DELTA = 0xFFFF * QUARTER
+
+
+def state(zone, t):
+    """Return the (offset in seconds, DST flag) in effect at Unix time t."""
+    utc = datetime.datetime.fromtimestamp(t, datetime.timezone.utc)
+    local = utc.astimezone(zone)
+    return int(local.utcoffset().total_seconds()), bool(local.dst())
+
+
+def read_tzif(data):
+    """Return the transition times and the footer TZ string of a TZif file."""
+    def counts(pos):
+        return struct.unpack(">6l", data[pos + 20 : pos + 44])
+
+    if data[:4] != b"TZif":
+        raise ValueError("not a TZif file")
+    isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt = counts(0)
+    size, fmt, footer = 4, ">%dl", ""
+    pos = 44
+    if data[4] >= ord("2"):  # skip the 32-bit data, use the 64-bit one
+        pos += (timecnt * 5 + typecnt * 6 + charcnt + leapcnt * 8 +
+                isstdcnt + isutcnt)
+        isutcnt, isstdcnt, leapcnt, timecnt, typecnt, charcnt = counts(pos)
+        size, fmt = 8, ">%dq"
+        pos += 44
+        end = (pos + timecnt * 9 + typecnt * 6 + charcnt + leapcnt * 12 +
+               isstdcnt + isutcnt)
+        footer = data[end:].split(b"\n")[1].decode()
+    times = list(struct.unpack(fmt % timecnt, data[pos : pos + timecnt * size]))
+    return times, footer
+
+
+def posix_transitions(tz, years):
+    """Return the UTC times of the DST changes of a POSIX TZ string."""
+    name = r"(?:<[^>]*>|[A-Za-z]+)"
+    offset = r"([+-]?\d+(?::\d+){0,2})"
+    rule = r"(M\d+\.\d+\.\d+|J\d+|\d+)(?:/" + offset + ")?"
+    match = re.fullmatch(f"{name}{offset}(?:({name}){offset}?"
+                         f"(?:,{rule},{rule})?)?", tz)
+    if not match:
+        sys.exit(f"cannot parse the TZ string {tz!r}")
+    if not match.group(2):
+        return []  # no DST
+
+    def seconds(text, default):
+        if text is None:
+            return default
+        sign = -1 if text.startswith("-") else 1
+        parts = [int(p) for p in text.lstrip("+-").split(":")] + [0, 0]
+        return sign * (parts[0] * 3600 + parts[1] * 60 + parts[2])
+
+    std = -seconds(match.group(1), 0)
+    dst = -seconds(match.group(3), -std - 3600)
+    start, start_time, end, end_time = match.group(4, 5, 6, 7)
+    if start is None:  # the US rules, as in POSIX
+        start, end = "M3.2.0", "M11.1.0"
+
+    def day(spec, year):
+        first = datetime.date(year, 1, 1)
+        if spec[0] == "J":  # 1 to 365, February 29 never counted
+            n = int(spec[1:]) - 1
+            date = first + datetime.timedelta(n)
+            if n >= 59 and year % 4 == 0:
+                date += datetime.timedelta(1)
+            return date
+        if spec[0] != "M":  # 0 to 365
+            return first + datetime.timedelta(int(spec))
+        month, week, weekday = (int(x) for x in spec[1:].split("."))
+        date = datetime.date(year, month, 1)
+        date += datetime.timedelta((weekday - (date.isoweekday() % 7)) % 7)
+        date += datetime.timedelta(7 * (week - 1))
+        while date.month != month:  # week 5 means the last one
+            date -= datetime.timedelta(7)
+        return date
+
+    def utc(spec, time, offset, year):
+        epoch = (day(spec, year) - datetime.date(1970, 1, 1)).days * 86400
+        return epoch + seconds(time, 7200) - offset
+
+    times = []
+    for year in years:
+        times.append(utc(start, start_time, std, year))
+        times.append(utc(end, end_time, dst, year))
+    return sorted(times)
+
+
+def transitions(zone, data):
+    """Return the initial state and the list of (time, state) changes.
+
+    The candidates are the transitions listed in the TZif file and, past
+    the last one, the DST changes of its footer rule; each is kept if the
+    state actually changes there.
+    """
+    times, footer = read_tzif(data)
+    last = times[-1] if times else START
+    last_year = datetime.datetime.fromtimestamp(last, datetime.timezone.utc).year
+    times = times + [t for t in posix_transitions(footer, range(last_year, 2101))
+                     if t > last]
+    initial = current = state(zone, START)
+    changes = []
+    for t in sorted(set(times)):
+        if START < t < END:
+            s = state(zone, t)
+            if state(zone, t - 1) != current:
+                sys.exit(f"{zone.key}: state changes before {t}")
+            if s != current:
+                current = s
+                changes.append((t, current))
+    return initial, changes
+
+
+def encode(name, initial, changes):
+    """Build the arrays of a TzTable."""
+    offsets = []
+
+    def index(s):
+        offset, dst = s
+        if offset % QUARTER:
+            sys.exit(f"{name}: offset {offset} s is not a multiple of 15 min")
+        code = (offset // QUARTER + 64) | (0x80 if dst else 0)
+        if code not in offsets:
+            offsets.append(code)
+        return offsets.index(code)
+
+    first = index(initial)
+    times, indices = [], []
+    previous, current = START, first
+    for t, s in changes:
+        if t % QUARTER:
+            sys.exit(f"{name}: transition at {t} is not on a quarter-hour")
+        while t - previous > MAX_DELTA:  # filler, keeps the same offset
+            previous += MAX_DELTA
+            times.append(previous)
+            indices.append(current)
+        current = index(s)
+        times.append(t)
+        indices.append(current)
+        previous = t
+    deltas = [0] + [(b - a) // QUARTER for a, b in zip(times, times[1:])]
+    anchors = times[::ANCHOR_INTERVAL]
+    return anchors, deltas[: len(times)], indices, offsets, first
+
+
+def c_array(ctype, name, values, per_line):
+    values = values or [0]
+    rows = [
+        ", ".join(str(v) for v in values[i : i + per_line])
+        for i in range(0, len(values), per_line)
+    ]
+    body = ",\n    ".join(rows)
+    return f"static const {ctype} {name}[] PROGMEM = {{\n    {body}}};\n"
+
+
+def tzdata_version(tzdir):
+    for path, pattern in (("tzdata.zi", r"#\s*version\s+(\S+)"), ("+VERSION", r"(\S+)")):
+        try:
+            with open(os.path.join(tzdir, path)) as f:
+                match = re.match(pattern, f.readline())
+                if match:
+                    return match.group(1)
+        except OSError:
+            pass
+    return "unknown"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("zones", nargs="+", help="zone names, e.g. Europe/Paris")
+    parser.add_argument("-d", "--tzdir", default="/usr/share/zoneinfo",
+                        help="directory of compiled zone files")
+    parser.add_argument("-o", "--output", default="zones",
+                        help="base name of the generated .h and .cpp files")
+    args = parser.parse_args()
+
+    version = tzdata_version(args.tzdir)
+    banner = (f"// Generated by extras/tzcompile.py from tzdata {version}.\n"
+              "// Do not edit.\n")
+    base = os.path.basename(args.output)
+    guard = re.sub(r"\W", "_", base).upper() + "_H"
+    header = [banner, f"#ifndef {guard}\n#define {guard}\n\n#include <RTClib.h>\n\n"]
+    source = [banner, f'#include "{base}.h"\n']
+
+    for zone_name in args.zones:
+        with open(os.path.join(args.tzdir, zone_name), "rb") as f:
+            data = f.read()
+        zone = zoneinfo.ZoneInfo.from_file(io.BytesIO(data), key=zone_name)
+        initial, changes = transitions(zone, data)
+        anchors, deltas, indices, offsets, first = encode(zone_name, initial, changes)
+        ident = re.sub(r"\W", "_", zone_name)
+        size = 4 * len(anchors) + 2 * len(deltas) + len(indices) + len(offsets)
+        print(f"{zone_name}: {len(deltas)} transitions, {size} bytes of PROGMEM",
+              file=sys.stderr)
+        header.append(f"extern const TzTable tz_{ident}; ///< {zone_name}\n")
+        source.append(f"\n// {zone_name}\n")
+        source.append(c_array("uint32_t", f"{ident}_anchors", anchors, 4))
+        source.append(c_array("uint16_t", f"{ident}_deltas", deltas, 10))
+        source.append(c_array("uint8_t", f"{ident}_indices", indices, 16))
+        source.append(c_array("uint8_t", f"{ident}_offsets", offsets, 16))
+        source.append(
+            f"const TzTable tz_{ident} = {{{ident}_anchors, {ident}_deltas, "
+            f"{ident}_indices, {ident}_offsets, {len(deltas)}, {first}}};\n")
+
+    header.append(f"\n#endif // {guard}\n")
+    with open(args.output + ".h", "w") as f:
+        f.write("".join(header))
+    with open(args.output + ".cpp", "w") as f:
+        f.write("".join(source))
+
+
+if __name__ == "__main__":
+    main()
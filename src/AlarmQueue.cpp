@@ -0,0 +1,166 @@
+#include "RTClib.h"
+
+#define ALARMQUEUE_NONE 0xFFFF ///< Position of an unscheduled alarm id
+
+/**************************************************************************/
+/*!
+    @brief  Free the memory allocated by begin()
+*/
+/**************************************************************************/
+AlarmQueue::~AlarmQueue() {
+  delete[] times;
+  delete[] periods;
+  delete[] heap;
+  delete[] positions;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Allocate storage for the alarms, clearing the queue
+    @param capacity Maximum number of simultaneously scheduled alarms, at
+    most 32767
+    @return False if the capacity is too large or the memory could not be
+    allocated, otherwise true
+*/
+/**************************************************************************/
+bool AlarmQueue::begin(uint16_t capacity) {
+  if (capacity > 32767) // ids are returned as int16_t
+    return false;
+  delete[] times;
+  delete[] periods;
+  delete[] heap;
+  delete[] positions;
+
+  times = new uint32_t[capacity];
+  periods = new uint32_t[capacity];
+  heap = new uint16_t[capacity];
+  positions = new uint16_t[capacity];
+  if (!times || !periods || !heap || !positions) {
+    this->capacity = 0;
+    count = 0;
+    return false;
+  }
+  this->capacity = capacity;
+  count = 0;
+  for (uint16_t id = 0; id < capacity; id++) {
+    heap[id] = id;
+    positions[id] = ALARMQUEUE_NONE;
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Schedule an alarm
+    @param time Unix time of the first occurrence
+    @param period Repeat period in seconds, or zero for a one-shot alarm
+    @return Alarm id, or -1 if the queue is full
+*/
+/**************************************************************************/
+int16_t AlarmQueue::add(uint32_t time, uint32_t period) {
+  if (count == capacity)
+    return -1;
+  uint16_t id = heap[count]; // first free id
+  times[id] = time;
+  periods[id] = period;
+  place(count++, id);
+  siftUp(count - 1);
+  return id;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Cancel an alarm
+    @param id Alarm id returned by add()
+    @return False if there was no such alarm, otherwise true
+*/
+/**************************************************************************/
+bool AlarmQueue::remove(uint16_t id) {
+  if (id >= capacity || positions[id] == ALARMQUEUE_NONE)
+    return false;
+  uint16_t index = positions[id];
+  uint16_t last = heap[--count];
+  heap[count] = id; // back to the free ids
+  positions[id] = ALARMQUEUE_NONE;
+  if (index < count) {
+    place(index, last);
+    siftUp(index);
+    siftDown(positions[last]);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Take the next due alarm out of the queue
+    @details One-shot alarms are removed, and their id may be reused by the
+    next call to add(). Repeating alarms are rescheduled to their first
+    occurrence after `now`.
+    @param now Current Unix time
+    @return Id of the earliest alarm due at or before `now`, or -1 if none
+*/
+/**************************************************************************/
+int16_t AlarmQueue::fire(uint32_t now) {
+  if (count == 0 || times[heap[0]] > now)
+    return -1;
+  uint16_t id = heap[0];
+  if (periods[id] == 0) {
+    remove(id);
+  } else {
+    times[id] += ((now - times[id]) / periods[id] + 1) * periods[id];
+    siftDown(0);
+  }
+  return id;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Store an alarm id at a heap position
+    @param index Position in the heap
+    @param id Alarm id
+*/
+/**************************************************************************/
+void AlarmQueue::place(uint16_t index, uint16_t id) {
+  heap[index] = id;
+  positions[id] = index;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Move an alarm towards the root until the heap is ordered
+    @param index Position of the alarm in the heap
+*/
+/**************************************************************************/
+void AlarmQueue::siftUp(uint16_t index) {
+  uint16_t id = heap[index];
+  while (index > 0) {
+    uint16_t parent = (index - 1) / 2;
+    if (times[heap[parent]] <= times[id])
+      break;
+    place(index, heap[parent]);
+    index = parent;
+  }
+  place(index, id);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Move an alarm towards the leaves until the heap is ordered
+    @param index Position of the alarm in the heap
+*/
+/**************************************************************************/
+void AlarmQueue::siftDown(uint16_t index) {
+  uint16_t id = heap[index];
+  for (;;) {
+    uint16_t child = 2 * index + 1;
+    if (child >= count)
+      break;
+    if (child + 1 < count && times[heap[child + 1]] < times[heap[child]])
+      child++;
+    if (times[id] <= times[heap[child]])
+      break;
+    place(index, heap[child]);
+    index = child;
+  }
+  place(index, id);
+}
@@ -0,0 +1,134 @@
+#include "RTClib.h"
+
+/**************************************************************************/
+/*!
+    @brief  Select the transitions to use
+    @param table Transitions of the zone, which must outlive this object
+*/
+/**************************************************************************/
+void CompiledTimeZone::begin(const TzTable &table) {
+  this->table = &table;
+  hitStart = 1; // empty the cache
+  hitEnd = 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Find the offset in effect at a given time
+    @details The anchors are binary-searched for the last one not after
+    the time, then the deltas are added up from there. The interval between
+    the surrounding transitions is cached.
+    @param utc Unix time, UTC
+    @return Offset, encoded as in TzTable::offsets
+*/
+/**************************************************************************/
+uint8_t CompiledTimeZone::lookup(uint32_t utc) {
+  if (utc >= hitStart && utc < hitEnd)
+    return hit;
+  if (!table)
+    return 64;
+  uint16_t count = table->count;
+  uint32_t start = 0, end = 0xFFFFFFFF;
+  int32_t i = -1; // last transition not after utc
+  if (count > 0 && utc >= pgm_read_dword(table->anchors)) {
+    uint16_t lo = 0, hi = (count - 1) / TZTABLE_ANCHOR_INTERVAL;
+    while (lo < hi) {
+      uint16_t mid = (lo + hi + 1) / 2;
+      if (pgm_read_dword(table->anchors + mid) <= utc)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+    i = lo * TZTABLE_ANCHOR_INTERVAL;
+    start = pgm_read_dword(table->anchors + lo);
+    while (i + 1 < count) {
+      uint32_t next = start + 900UL * pgm_read_word(table->deltas + i + 1);
+      if (next > utc)
+        break;
+      start = next;
+      i++;
+    }
+  }
+  if (i + 1 < count)
+    end = i < 0 ? pgm_read_dword(table->anchors)
+                : start + 900UL * pgm_read_word(table->deltas + i + 1);
+  uint8_t index = i < 0 ? table->initial : pgm_read_byte(table->indices + i);
+  hitStart = start;
+  hitEnd = end;
+  hit = pgm_read_byte(table->offsets + index);
+  return hit;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Offset of local time from UTC at a given time
+    @param utc Unix time, UTC
+    @return Offset in seconds, positive east of Greenwich
+*/
+/**************************************************************************/
+int32_t CompiledTimeZone::offsetAt(uint32_t utc) {
+  return ((lookup(utc) & 0x7F) - 64) * 900L;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Offset of local time from UTC at a given time
+    @param utc Date and time, UTC
+    @return Offset in seconds, positive east of Greenwich
+*/
+/**************************************************************************/
+int32_t CompiledTimeZone::offset(const DateTime &utc) {
+  return offsetAt(utc.unixtime());
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check whether DST is in effect at a given time
+    @param utc Date and time, UTC
+    @return True if DST is in effect
+*/
+/**************************************************************************/
+bool CompiledTimeZone::isDST(const DateTime &utc) {
+  return lookup(utc.unixtime()) & 0x80;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Convert UTC to local time
+    @param utc Date and time, UTC
+    @return Local date and time
+*/
+/**************************************************************************/
+DateTime CompiledTimeZone::toLocal(const DateTime &utc) {
+  uint32_t t = utc.unixtime();
+  return DateTime(t + offsetAt(t));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Convert local time to UTC
+    @details A local time occurring twice is taken as its first occurrence.
+    A local time skipped by a transition is taken with the offset in effect
+    before it, and thus lands after the transition. This assumes that
+    transitions are more than 26 hours apart.
+    @param local Local date and time
+    @return Date and time, UTC
+*/
+/**************************************************************************/
+DateTime CompiledTimeZone::toUTC(const DateTime &local) {
+  uint32_t t = local.unixtime();
+  // UTC offsets span -12 to +14 hours
+  int32_t before = offsetAt(t - 14 * 3600L);
+  int32_t after = offsetAt(t + 12 * 3600L);
+  uint32_t early = t - before, late = t - after;
+  if (early > late) { // make early the first instant
+    uint32_t swap = early;
+    early = late;
+    late = swap;
+  }
+  if (t - offsetAt(early) == early)
+    return DateTime(early);
+  if (t - offsetAt(late) == late)
+    return DateTime(late);
+  return DateTime(t - before);
+}
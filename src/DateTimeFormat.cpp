@@ -0,0 +1,233 @@
+#include "RTClib.h"
+
+/** Specifiers recognized by DateTimeFormat */
+enum DateTimeFormatField {
+  DTF_YEAR4,      ///< YYYY
+  DTF_YEAR2,      ///< YY
+  DTF_MONTH,      ///< MM
+  DTF_MONTH_NAME, ///< MMM
+  DTF_DAY,        ///< DD
+  DTF_DAY_NAME,   ///< DDD
+  DTF_HOUR,       ///< hh
+  DTF_MINUTE,     ///< mm
+  DTF_SECOND,     ///< ss
+  DTF_AP,         ///< AP
+  DTF_ap          ///< ap
+};
+
+/**************************************************************************/
+/*!
+    @brief  Free the memory allocated by begin()
+*/
+/**************************************************************************/
+DateTimeFormat::~DateTimeFormat() {
+  delete[] record;
+  delete[] fields;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compile a format
+    @details Specifiers are matched from left to right, the longest one
+    first, as `DateTime::toString()` does.
+    @param format Format string, as for `DateTime::toString()`, of at most
+    255 characters
+    @return False if the format is too long or the memory could not be
+    allocated, otherwise true
+*/
+/**************************************************************************/
+bool DateTimeFormat::begin(const char *format) {
+  delete[] record;
+  delete[] fields;
+  record = NULL;
+  fields = NULL;
+  fieldCount = length = 0;
+  twelveHour = false;
+  size_t len = strlen(format);
+  if (len > 255)
+    return false;
+  record = new char[len + 1];
+  fields = new uint8_t[len + 1]; // at most one specifier per two characters
+  if (!record || !fields)
+    return false;
+  memcpy(record, format, len + 1);
+  for (size_t i = 0; i + 1 < len;) {
+    const char *p = format + i;
+    uint8_t kind, size = 2;
+    if (strncmp(p, "YYYY", 4) == 0) {
+      kind = DTF_YEAR4;
+      size = 4;
+    } else if (strncmp(p, "YY", 2) == 0) {
+      kind = DTF_YEAR2;
+    } else if (strncmp(p, "MMM", 3) == 0) {
+      kind = DTF_MONTH_NAME;
+      size = 3;
+    } else if (strncmp(p, "MM", 2) == 0) {
+      kind = DTF_MONTH;
+    } else if (strncmp(p, "DDD", 3) == 0) {
+      kind = DTF_DAY_NAME;
+      size = 3;
+    } else if (strncmp(p, "DD", 2) == 0) {
+      kind = DTF_DAY;
+    } else if (strncmp(p, "hh", 2) == 0) {
+      kind = DTF_HOUR;
+    } else if (strncmp(p, "mm", 2) == 0) {
+      kind = DTF_MINUTE;
+    } else if (strncmp(p, "ss", 2) == 0) {
+      kind = DTF_SECOND;
+    } else if (strncmp(p, "AP", 2) == 0) {
+      kind = DTF_AP;
+    } else if (strncmp(p, "ap", 2) == 0) {
+      kind = DTF_ap;
+    } else {
+      i++;
+      continue;
+    }
+    if (kind == DTF_AP || kind == DTF_ap)
+      twelveHour = true;
+    fields[2 * fieldCount] = kind;
+    fields[2 * fieldCount + 1] = i;
+    fieldCount++;
+    i += size;
+  }
+  length = len;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a number as two digits
+    @param p Where to write
+    @param val Number, from 0 to 99
+*/
+/**************************************************************************/
+static inline void put2(char *p, uint8_t val) {
+  p[0] = '0' + val / 10;
+  p[1] = '0' + val % 10;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Render the date specifiers into the record
+    @param dt Date to render
+*/
+/**************************************************************************/
+void DateTimeFormat::renderDate(const DateTime &dt) {
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    char *p = record + fields[2 * i + 1];
+    char name[4] = "MMM";
+    switch (fields[2 * i]) {
+    case DTF_YEAR4:
+      put2(p, 20);
+      put2(p + 2, dt.year() - 2000U);
+      break;
+    case DTF_YEAR2:
+      put2(p, dt.year() - 2000U);
+      break;
+    case DTF_MONTH:
+      put2(p, dt.month());
+      break;
+    case DTF_DAY:
+      put2(p, dt.day());
+      break;
+    case DTF_DAY_NAME:
+      strcpy(name, "DDD");
+      // fall through
+    case DTF_MONTH_NAME:
+      memcpy(p, dt.toString(name), 3);
+      break;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Render the time specifiers into the record
+    @param hh Hour
+    @param mm Minute
+    @param ss Second
+*/
+/**************************************************************************/
+void DateTimeFormat::renderTime(uint8_t hh, uint8_t mm, uint8_t ss) {
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    char *p = record + fields[2 * i + 1];
+    switch (fields[2 * i]) {
+    case DTF_HOUR:
+      put2(p, twelveHour ? (hh + 11) % 12 + 1 : hh);
+      break;
+    case DTF_MINUTE:
+      put2(p, mm);
+      break;
+    case DTF_SECOND:
+      put2(p, ss);
+      break;
+    case DTF_AP:
+      p[0] = hh >= 12 ? 'P' : 'A';
+      p[1] = 'M';
+      break;
+    case DTF_ap:
+      p[0] = hh >= 12 ? 'p' : 'a';
+      p[1] = 'm';
+      break;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Render an array of Unix times
+    @param times Unix times, from 2000 to 2099
+    @param count Number of times
+    @param out Buffer receiving count * (width() + 1) characters
+    @param terminator Character written after each record, e.g. '\0' to get
+    an array of C strings
+    @return Number of characters written
+*/
+/**************************************************************************/
+size_t DateTimeFormat::format(const uint32_t *times, size_t count, char *out,
+                              char terminator) {
+  uint32_t today = 0xFFFFFFFF;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t t = times[i] - SECONDS_FROM_1970_TO_2000;
+    uint32_t day = t / 86400;
+    uint32_t s = t - day * 86400;
+    if (day != today) {
+      renderDate(DateTime(times[i]));
+      today = day;
+    }
+    renderTime(s / 3600, s / 60 % 60, s % 60);
+    memcpy(out, record, length);
+    out[length] = terminator;
+    out += length + 1;
+  }
+  return count * (length + 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Render an array of DateTime objects
+    @param times DateTime objects
+    @param count Number of objects
+    @param out Buffer receiving count * (width() + 1) characters
+    @param terminator Character written after each record, e.g. '\0' to get
+    an array of C strings
+    @return Number of characters written
+*/
+/**************************************************************************/
+size_t DateTimeFormat::format(const DateTime *times, size_t count, char *out,
+                              char terminator) {
+  uint16_t today = 0xFFFF;
+  for (size_t i = 0; i < count; i++) {
+    const DateTime &dt = times[i];
+    uint16_t day = (dt.year() - 2000U) << 9 | dt.month() << 5 | dt.day();
+    if (day != today) {
+      renderDate(dt);
+      today = day;
+    }
+    renderTime(dt.hour(), dt.minute(), dt.second());
+    memcpy(out, record, length);
+    out[length] = terminator;
+    out += length + 1;
+  }
+  return count * (length + 1);
+}
@@ -0,0 +1,131 @@
+#include "RTClib.h"
+
+/**************************************************************************/
+/*!
+    @brief  Free the memory allocated by begin()
+*/
+/**************************************************************************/
+NvramCache::~NvramCache() {
+  delete[] data;
+  delete[] dirty;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Allocate the mirror, with every byte clean
+    @param size Size of the NVRAM, in bytes
+    @return False if the memory could not be allocated, otherwise true
+*/
+/**************************************************************************/
+bool NvramCache::begin(uint8_t size) {
+  delete[] data;
+  delete[] dirty;
+  data = new uint8_t[size];
+  dirty = new uint8_t[(size + 7) / 8];
+  if (!data || !dirty) {
+    this->size = 0;
+    dirtyCount = 0;
+    return false;
+  }
+  memset(data, 0, size);
+  memset(dirty, 0, (size + 7) / 8);
+  this->size = size;
+  dirtyCount = 0;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clip a range to the end of the NVRAM
+    @param address Starting NVRAM address
+    @param[in,out] size Number of bytes, reduced to fit if needed
+    @return False if the range is empty, otherwise true
+*/
+/**************************************************************************/
+bool NvramCache::clip(uint8_t address, uint8_t &size) const {
+  if (address >= this->size)
+    return false;
+  if (size > this->size - address)
+    size = this->size - address;
+  return size > 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read data from the mirror
+    @param buf Pointer to a buffer to store the data - make sure it's large
+   enough to hold size bytes
+    @param size Number of bytes to read
+    @param address Starting NVRAM address
+*/
+/**************************************************************************/
+void NvramCache::readnvram(uint8_t *buf, uint8_t size, uint8_t address) const {
+  if (clip(address, size))
+    memcpy(buf, data + address, size);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Shortcut to write one byte to the mirror
+    @param address NVRAM address
+    @param data One byte to write
+*/
+/**************************************************************************/
+void NvramCache::writenvram(uint8_t address, uint8_t data) {
+  writenvram(address, &data, 1);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write data to the mirror, marking the changed bytes as dirty
+    @details Bytes written with their current value are not marked.
+    @param address Starting NVRAM address
+    @param buf Pointer to buffer containing the data to write
+    @param size Number of bytes in buf to write
+*/
+/**************************************************************************/
+void NvramCache::writenvram(uint8_t address, const uint8_t *buf,
+                            uint8_t size) {
+  if (!clip(address, size))
+    return;
+  for (uint8_t i = 0; i < size; i++, address++) {
+    if (data[address] == buf[i])
+      continue;
+    data[address] = buf[i];
+    uint8_t mask = 1 << (address & 7);
+    if (!(dirty[address >> 3] & mask)) {
+      dirty[address >> 3] |= mask;
+      dirtyCount++;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Take the next range of dirty bytes, marking it clean
+    @details Consecutive dirty bytes separated by at most
+   #NVRAMCACHE_MAX_GAP clean bytes are returned as a single range.
+    @param[out] address Starting NVRAM address of the range
+    @param[out] size Number of bytes in the range
+    @return False if no byte is dirty, otherwise true
+*/
+/**************************************************************************/
+bool NvramCache::nextDirtyRange(uint8_t &address, uint8_t &size) {
+  if (dirtyCount == 0)
+    return false;
+  uint8_t i = 0;
+  while (!(dirty[i >> 3] & (1 << (i & 7))))
+    i++;
+  address = i;
+  uint8_t end = i; // one past the last dirty byte of the range
+  for (; i < this->size && i - end <= NVRAMCACHE_MAX_GAP; i++) {
+    uint8_t mask = 1 << (i & 7);
+    if (dirty[i >> 3] & mask) {
+      dirty[i >> 3] &= ~mask;
+      dirtyCount--;
+      end = i + 1;
+    }
+  }
+  size = end - address;
+  return true;
+}
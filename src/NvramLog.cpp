@@ -0,0 +1,224 @@
+#include "RTClib.h"
+
+/**************************************************************************/
+/*!
+    @brief  Free the memory allocated by begin()
+*/
+/**************************************************************************/
+NvramLog::~NvramLog() {
+  delete[] record;
+  delete[] buffer;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Allocate the buffers of the log, which is left empty
+    @param payloadSize Size of the payload of a record, in bytes
+    @param size Number of NVRAM bytes used by the log, header included
+    @return False if the log cannot hold a single record or the memory
+    could not be allocated, otherwise true
+*/
+/**************************************************************************/
+bool NvramLog::begin(uint8_t payloadSize, uint8_t size) {
+  delete[] record;
+  delete[] buffer;
+  record = buffer = NULL;
+  head = used = count = 0;
+  position = 0;
+  if (size < NVRAMLOG_HEADER_SIZE ||
+      size - NVRAMLOG_HEADER_SIZE < NVRAMLOG_MAX_VARINT + payloadSize)
+    return false;
+  uint8_t bufferSize = NVRAMLOG_MAX_VARINT + payloadSize;
+  if (bufferSize < NVRAMLOG_HEADER_SIZE)
+    bufferSize = NVRAMLOG_HEADER_SIZE;
+  record = new uint8_t[bufferSize];
+  buffer = new uint8_t[bufferSize];
+  if (!record || !buffer)
+    return false;
+  this->payloadSize = payloadSize;
+  dataSize = size - NVRAMLOG_HEADER_SIZE;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Wrap an offset around the end of the ring
+    @param offset Offset, less than twice the size of the ring
+    @return Ring offset
+*/
+/**************************************************************************/
+uint8_t NvramLog::wrap(uint16_t offset) const {
+  return offset >= dataSize ? offset - dataSize : offset;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Encode a record following the newest one
+    @details The timestamp is encoded as the zigzag varint of the change of
+    interval, or as zero for the first record of the log, whose time is kept
+    in the header. The state of the log is left unchanged.
+    @param time Unix time of the record
+    @param payload Payload of the record
+    @return Size of the encoded record, in bytes
+*/
+/**************************************************************************/
+uint8_t NvramLog::encode(uint32_t time, const uint8_t *payload) {
+  uint32_t dod = count > 0 ? time - lastTime - lastDelta : 0;
+  uint32_t zigzag = (dod << 1) ^ (uint32_t)((int32_t)dod >> 31);
+  uint8_t length = 0;
+  while (zigzag >= 0x80) {
+    record[length++] = zigzag | 0x80;
+    zigzag >>= 7;
+  }
+  record[length++] = zigzag;
+  memcpy(record + length, payload, payloadSize);
+  return length + payloadSize;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Account for a record encoded by encode() and written to the ring
+    @param time Unix time of the record
+    @param length Size of the encoded record, in bytes
+*/
+/**************************************************************************/
+void NvramLog::commit(uint32_t time, uint8_t length) {
+  if (count == 0) {
+    firstTime = time;
+    firstDelta = lastDelta = 0;
+  } else {
+    lastDelta = time - lastTime;
+  }
+  lastTime = time;
+  used += length;
+  count++;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decode the record at the start of the read buffer
+    @param[out] dod Change of interval encoded by the record
+    @return Size of the record, in bytes, or 0 if it is malformed
+*/
+/**************************************************************************/
+uint8_t NvramLog::decode(uint32_t &dod) const {
+  uint32_t zigzag = 0;
+  for (uint8_t i = 0; i < NVRAMLOG_MAX_VARINT; i++) {
+    zigzag |= (uint32_t)(buffer[i] & 0x7F) << (7 * i);
+    if (!(buffer[i] & 0x80)) {
+      dod = (zigzag >> 1) ^ -(zigzag & 1);
+      return i + 1 + payloadSize;
+    }
+  }
+  return 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Drop the oldest record
+    @details The time of the new oldest record must then be updated from
+    its encoded change of interval. A malformed record empties the log.
+    @param length Size of the oldest record, as returned by decode()
+*/
+/**************************************************************************/
+void NvramLog::evict(uint8_t length) {
+  if (length == 0 || length >= used || count <= 1) {
+    used = count = 0;
+    return;
+  }
+  head = wrap(head + length);
+  used -= length;
+  count--;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decode the record under the read cursor, loaded in the read
+    buffer, and move the cursor to the next record
+    @param payload Buffer receiving the payload, or NULL
+    @return Size of the record, in bytes, or 0 if it is malformed
+*/
+/**************************************************************************/
+uint8_t NvramLog::advance(uint8_t *payload) {
+  uint32_t dod;
+  uint8_t length = decode(dod);
+  if (length == 0)
+    return 0;
+  if (position == 0) {
+    cursorTime = firstTime;
+    cursorDelta = firstDelta;
+  } else {
+    cursorDelta += dod;
+    cursorTime += cursorDelta;
+  }
+  if (payload)
+    memcpy(payload, buffer + length - payloadSize, payloadSize);
+  cursor = wrap(cursor + length);
+  position++;
+  return length;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Serialize the header into the read buffer, as the next copy
+    @details The sequence number is incremented, and placed last so that it
+    is the last byte written.
+*/
+/**************************************************************************/
+void NvramLog::packHeader() {
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    buffer[i] = firstTime >> (8 * i);
+    buffer[4 + i] = firstDelta >> (8 * i);
+  }
+  buffer[8] = head;
+  buffer[9] = used;
+  buffer[11] = ++sequence;
+  for (uint8_t i = 0; i < NVRAMLOG_SLOT_SIZE; i++)
+    if (i != 10)
+      sum += buffer[i];
+  buffer[10] = 0x5A - sum;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check a copy of the header
+    @param copy Header copy
+    @return True if the check byte matches and the fields are in range
+*/
+/**************************************************************************/
+bool NvramLog::validHeader(const uint8_t *copy) const {
+  uint8_t sum = 0;
+  for (uint8_t i = 0; i < NVRAMLOG_SLOT_SIZE; i++)
+    sum += copy[i];
+  return sum == 0x5A && copy[8] < dataSize && copy[9] <= dataSize;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Load the newest valid copy of the header from the read buffer
+    @details The records still have to be counted.
+    @return Number of valid copies: 0 if there is no log
+*/
+/**************************************************************************/
+uint8_t NvramLog::unpackHeader() {
+  bool valid[2] = {validHeader(buffer),
+                   validHeader(buffer + NVRAMLOG_SLOT_SIZE)};
+  if (!valid[0] && !valid[1])
+    return 0;
+  uint8_t seq0 = buffer[NVRAMLOG_SLOT_SIZE - 1];
+  uint8_t seq1 = buffer[2 * NVRAMLOG_SLOT_SIZE - 1];
+  // sequence numbers are compared modulo 256
+  slot = !valid[0] || (valid[1] && (int8_t)(seq1 - seq0) > 0);
+  const uint8_t *copy = buffer + slot * NVRAMLOG_SLOT_SIZE;
+  firstTime = firstDelta = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    firstTime |= (uint32_t)copy[i] << (8 * i);
+    firstDelta |= (uint32_t)copy[4 + i] << (8 * i);
+  }
+  head = copy[8];
+  used = copy[9];
+  sequence = copy[11];
+  count = 0;
+  return valid[0] + valid[1];
+}
@@ -0,0 +1,152 @@
+#include "RTClib.h"
+
+/**************************************************************************/
+/*!
+    @brief  Free the memory allocated by begin()
+*/
+/**************************************************************************/
+NvramStore::~NvramStore() {
+  delete[] record;
+  delete[] seqs;
+  delete[] copies;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Allocate the state of the store, with every key empty
+    @param keys Number of keys
+    @param valueSize Size of a value, in bytes
+    @param base NVRAM address of the first record
+    @param nvramSize Size of the NVRAM, in bytes
+    @return False if the records do not fit in the NVRAM or the memory
+    could not be allocated, otherwise true
+*/
+/**************************************************************************/
+bool NvramStore::begin(uint8_t keys, uint8_t valueSize, uint8_t base,
+                       uint8_t nvramSize) {
+  delete[] record;
+  delete[] seqs;
+  delete[] copies;
+  record = seqs = copies = NULL;
+  this->keys = 0;
+  if (keys == 0 || valueSize > 253 ||
+      base + 2UL * keys * (valueSize + 2) > nvramSize)
+    return false;
+  record = new uint8_t[valueSize + 2];
+  seqs = new uint8_t[keys];
+  copies = new uint8_t[keys];
+  if (!record || !seqs || !copies)
+    return false;
+  memset(copies, NVRAMSTORE_ABSENT, keys);
+  this->keys = keys;
+  this->valueSize = valueSize;
+  this->base = base;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  NVRAM address of a record slot
+    @param key Key
+    @param copy Slot, 0 or 1. Flags are ignored.
+    @return NVRAM address of the record
+*/
+/**************************************************************************/
+uint8_t NvramStore::address(uint8_t key, uint8_t copy) const {
+  return base + (2 * key + (copy & 1)) * recordSize();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compute the CRC-8 (Maxim) of the record buffer
+    @details The key is included, so that a record read from the wrong slot
+    is rejected. The CRC starts from 0xFF, so that erased or cleared NVRAM
+    does not read as valid records.
+    @param key Key the record belongs to
+    @return CRC of the key, sequence number and value
+*/
+/**************************************************************************/
+uint8_t NvramStore::crc(uint8_t key) const {
+  uint8_t crc = 0xFF;
+  uint8_t byte = key;
+  for (uint8_t i = 0; i <= valueSize + 1; i++) {
+    crc ^= byte;
+    for (uint8_t bit = 0; bit < 8; bit++)
+      crc = crc & 1 ? (crc >> 1) ^ 0x8C : crc >> 1;
+    // the sequence number follows the key, then the value
+    byte = i == 0 ? record[valueSize + 1] : record[i - 1];
+  }
+  return crc;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Consider the record buffer, read from a slot, as the current
+    value of a key
+    @details The record is accepted if its CRC is valid and it is newer
+    than the current record, sequence numbers being compared modulo 256.
+    @param key Key
+    @param copy Slot the record was read from
+*/
+/**************************************************************************/
+void NvramStore::recover(uint8_t key, uint8_t copy) {
+  if (record[valueSize] != crc(key))
+    return;
+  uint8_t seq = record[valueSize + 1];
+  if (copies[key] == NVRAMSTORE_ABSENT) {
+    copies[key] = copy;
+    seqs[key] = seq;
+  } else if ((int8_t)(seq - seqs[key]) > 0) {
+    copies[key] = copy | NVRAMSTORE_PAIRED;
+    seqs[key] = seq;
+  } else {
+    copies[key] |= NVRAMSTORE_PAIRED;
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Extract the value from the record buffer, read from the current
+    slot of a key
+    @details If the record is invalid, the key falls back to the older
+    value of the other slot, if any.
+    @param key Key the record was read for
+    @param value Buffer receiving the value
+    @return False if the record is invalid, otherwise true
+*/
+/**************************************************************************/
+bool NvramStore::decode(uint8_t key, uint8_t *value) {
+  if (record[valueSize] != crc(key)) {
+    if (copies[key] & NVRAMSTORE_PAIRED)
+      copies[key] = (copies[key] ^ 1) & 1;
+    else
+      copies[key] = NVRAMSTORE_ABSENT;
+    return false;
+  }
+  seqs[key] = record[valueSize + 1];
+  memcpy(value, record, valueSize);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Build the next record of a key in the record buffer
+    @details The key is considered as holding the new value from now on.
+    @param key Key
+    @param value New value
+    @return NVRAM address the record buffer must be written to
+*/
+/**************************************************************************/
+uint8_t NvramStore::prepare(uint8_t key, const uint8_t *value) {
+  if (copies[key] == NVRAMSTORE_ABSENT) {
+    copies[key] = 0;
+    seqs[key] = 0;
+  } else {
+    copies[key] = (copies[key] ^ 1) | NVRAMSTORE_PAIRED;
+    seqs[key]++;
+  }
+  memcpy(record, value, valueSize);
+  record[valueSize + 1] = seqs[key];
+  record[valueSize] = crc(key);
+  return address(key, copies[key]);
+}
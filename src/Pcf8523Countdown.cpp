@@ -0,0 +1,177 @@
+#include "RTClib.h"
+
+/*
+  Durations are handled in units of 1/512000 s, the largest unit in which
+  both a millisecond (512 units) and a period of the 4096 Hz source clock
+  (125 units) are whole numbers, so that planning involves no rounding.
+*/
+#define COUNTDOWN_UNITS_PER_MS 512UL         ///< Units per millisecond
+#define COUNTDOWN_UNITS_PER_SECOND 512000ULL ///< Units per second
+
+/** Period of each #PCF8523TimerClockFreq, in units */
+static const uint32_t periods[5] = {125, 8000, 512000, 30720000, 1843200000};
+
+/**************************************************************************/
+/*!
+    @brief  How much shorter the first period of a timer may be
+    @details The 1 Hz, 1/60 Hz and 1/3600 Hz source clocks keep running
+   while a timer is stopped, so the first of the n periods counted after a
+   start lasts anywhere from none to a whole period.
+    @param clock Source clock, as a #PCF8523TimerClockFreq
+    @return Shortfall, in units
+*/
+/**************************************************************************/
+static uint64_t firstPeriodShortfall(int8_t clock) {
+  return clock >= PCF8523_FrequencySecond ? periods[clock] : 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Plan a countdown of a number of milliseconds
+    @param millis Duration, in milliseconds
+    @param maxErrorMillis Error accepted in exchange for fewer wake-ups, in
+   milliseconds, whether the countdown elapses at the latest or, the first
+   periods being short, at the earliest. With 0, the most accurate plan
+   within one wake-up of the fewest is chosen.
+    @return False if the duration is zero, otherwise true
+*/
+/**************************************************************************/
+bool Pcf8523Countdown::plan(uint32_t millis, uint32_t maxErrorMillis) {
+  return planUnits((uint64_t)millis * COUNTDOWN_UNITS_PER_MS,
+                   (uint64_t)maxErrorMillis * COUNTDOWN_UNITS_PER_MS);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Plan a countdown of a TimeSpan
+    @param span Duration, up to the full range of a TimeSpan
+    @param maxErrorMillis Error accepted in exchange for fewer wake-ups, in
+   milliseconds, whether the countdown elapses at the latest or, the first
+   periods being short, at the earliest. With 0, the most accurate plan
+   within one wake-up of the fewest is chosen.
+    @return False if the duration is not positive, otherwise true
+*/
+/**************************************************************************/
+bool Pcf8523Countdown::plan(const TimeSpan &span, uint32_t maxErrorMillis) {
+  if (span.totalseconds() <= 0)
+    return false;
+  return planUnits(span.totalseconds() * COUNTDOWN_UNITS_PER_SECOND,
+                   (uint64_t)maxErrorMillis * COUNTDOWN_UNITS_PER_MS);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Plan a countdown
+    @details For each source clock of the long stage, the fewest repeats
+   that fit, and one more, are tried with the longest stage that does not
+   overshoot, alone or completed by a short stage on each finer clock, and
+   with the next longer stage alone. The error of a plan is the worst of
+   its latest and earliest ends, the first period of each stage started on
+   a clock of 1 Hz or slower being up to a period short. A first pass finds
+   the fewest possible wake-ups and the smallest possible error, a second
+   one the smallest error within one wake-up of the fewest, which is the
+   accepted error unless maxError is given. The last pass picks the fewest
+   wake-ups within the accepted error, coarser clocks first since they draw
+   less current.
+    @param target Duration, in units of 1/512000 s
+    @param maxError Accepted error, in the same units, or 0
+    @return False if the duration is zero, otherwise true
+*/
+/**************************************************************************/
+bool Pcf8523Countdown::planUnits(uint64_t target, uint64_t maxError) {
+  if (target == 0)
+    return false;
+  uint64_t leastError = UINT64_MAX, nearError = UINT64_MAX;
+  uint64_t threshold = UINT64_MAX, bestError = UINT64_MAX;
+  uint16_t leastWakeups = 0xFFFF, bestWakeups = 0xFFFF;
+  for (uint8_t pass = 0; pass < 3; pass++) {
+    for (int8_t l = 4; l >= 0; l--) {
+      uint64_t pl = periods[l];
+      uint64_t fewest = (target + 255 * pl - 1) / (255 * pl);
+      for (uint64_t n = fewest; n <= fewest + 1 && n <= 0xFFFF; n++) {
+        // -2: the longer stage alone, -1: the shorter one alone, 0 to l - 1:
+        // the shorter one completed on that clock
+        for (int8_t s = -2; s < l; s++) {
+          // the countdown ends between total - spread and total, so aim
+          // for the middle of that range
+          uint64_t spread = firstPeriodShortfall(l) +
+                            (s >= 0 ? firstPeriodShortfall(s) : 0);
+          uint64_t aim = target + spread / 2;
+          uint64_t floor = aim / (n * pl);
+          uint64_t count = s == -2 ? floor + 1 : floor;
+          if (count < 1 || count > 255)
+            continue;
+          uint64_t total = n * count * pl, extra = 0;
+          if (s >= 0) {
+            extra = (aim - total + periods[s] / 2) / periods[s];
+            if (extra < 1 || extra > 255)
+              continue;
+            total += extra * periods[s];
+          }
+          // the worst of the latest and earliest ends
+          int64_t latest = (int64_t)total - (int64_t)target;
+          int64_t earliest = latest - (int64_t)spread;
+          uint64_t diff = latest > -earliest ? latest : -earliest;
+          uint16_t wakeups = n + (extra ? 1 : 0);
+          if (pass == 0) {
+            if (wakeups < leastWakeups)
+              leastWakeups = wakeups;
+            if (diff < leastError)
+              leastError = diff;
+            continue;
+          }
+          if (pass == 1) {
+            if (wakeups <= leastWakeups + 1 && diff < nearError)
+              nearError = diff;
+            continue;
+          }
+          if (diff > threshold || wakeups > bestWakeups ||
+              (wakeups == bestWakeups && diff >= bestError))
+            continue;
+          bestWakeups = wakeups;
+          bestError = diff;
+          longClock = (PCF8523TimerClockFreq)l;
+          longCount = count;
+          repeatCount = n;
+          shortClock = (PCF8523TimerClockFreq)(s < 0 ? 0 : s);
+          shortCount = extra;
+          // 1 unit = 125/64 us; the spread is at most 3660 s, 3.66e9 us
+          int64_t micros = latest * 125 / 64;
+          error = micros > INT32_MAX   ? INT32_MAX
+                  : micros < INT32_MIN ? INT32_MIN
+                                       : (int32_t)micros;
+          uncertainty = spread * 125 / 64;
+        }
+      }
+    }
+    if (pass == 1)
+      threshold = !maxError ? nearError
+                  : maxError > leastError ? maxError
+                                          : leastError;
+  }
+  remaining = 0;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Rewind the countdown to its first long stage
+    @return False if nothing is planned, otherwise true
+*/
+/**************************************************************************/
+bool Pcf8523Countdown::start() {
+  remaining = repeatCount;
+  return repeatCount > 0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Count the end of a long stage
+    @return True if it was the last one
+*/
+/**************************************************************************/
+bool Pcf8523Countdown::countLong() {
+  if (remaining)
+    remaining--;
+  return remaining == 0;
+}
@@ -1,5 +1,7 @@
 #include "RTClib.h"
 
+#ifdef ARDUINO // the I2C drivers are not built on a Linux host
+
 #define DS1307_ADDRESS 0x68 ///< I2C address for DS1307
 #define DS1307_CONTROL 0x07 ///< Control register
 #define DS1307_NVRAM 0x08   ///< Start of RAM registers - 56 bytes, 0x08 to 0x3f
@@ -87,13 +89,17 @@ void RTC_DS1307::writeSqwPinMode(Ds1307SqwPinMode mode) {
     @brief  Read data from the DS1307's NVRAM
     @param buf Pointer to a buffer to store the data - make sure it's large
    enough to hold size bytes
-    @param size Number of bytes to read
+    @param size Number of bytes to read. The transfer stops at the end of the
+   NVRAM, since the chip would otherwise wrap around to the time registers.
     @param address Starting NVRAM address, from 0 to 55
 */
 /**************************************************************************/
 void RTC_DS1307::readnvram(uint8_t *buf, uint8_t size, uint8_t address) {
-  uint8_t addrByte = DS1307_NVRAM + address;
-  i2c_dev->write_then_read(&addrByte, 1, buf, size);
+  if (address >= NVRAM_SIZE)
+    return;
+  if (size > NVRAM_SIZE - address)
+    size = NVRAM_SIZE - address;
+  read_registers(DS1307_NVRAM + address, buf, size);
 }
 
 /**************************************************************************/
@@ -101,12 +107,17 @@ void RTC_DS1307::readnvram(uint8_t *buf, uint8_t size, uint8_t address) {
     @brief  Write data to the DS1307 NVRAM
     @param address Starting NVRAM address, from 0 to 55
     @param buf Pointer to buffer containing the data to write
-    @param size Number of bytes in buf to write to NVRAM
+    @param size Number of bytes in buf to write to NVRAM. The transfer stops
+   at the end of the NVRAM, since the chip would otherwise wrap around to the
+   time registers.
 */
 /**************************************************************************/
 void RTC_DS1307::writenvram(uint8_t address, const uint8_t *buf, uint8_t size) {
-  uint8_t addrByte = DS1307_NVRAM + address;
-  i2c_dev->write(buf, size, true, &addrByte, 1);
+  if (address >= NVRAM_SIZE)
+    return;
+  if (size > NVRAM_SIZE - address)
+    size = NVRAM_SIZE - address;
+  write_registers(DS1307_NVRAM + address, buf, size);
 }
 
 /**************************************************************************/
@@ -132,3 +143,26 @@ uint8_t RTC_DS1307::readnvram(uint8_t address) {
 void RTC_DS1307::writenvram(uint8_t address, uint8_t data) {
   writenvram(address, &data, 1);
 }
+
+/**************************************************************************/
+/*!
+    @brief  Save the configuration of the DS1307
+    @return Ds1307Snapshot holding the control register
+*/
+/**************************************************************************/
+Ds1307Snapshot RTC_DS1307::snapshot() {
+  Ds1307Snapshot snap = {read_register(DS1307_CONTROL)};
+  return snap;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restore a configuration saved with snapshot()
+    @param snap Ds1307Snapshot to restore
+*/
+/**************************************************************************/
+void RTC_DS1307::restore(const Ds1307Snapshot &snap) {
+  write_register(DS1307_CONTROL, snap.control);
+}
+
+#endif // ARDUINO
@@ -1,11 +1,14 @@
 #include "RTClib.h"
 
-#define DS3231_ADDRESS 0x68   ///< I2C address for DS3231
-#define DS3231_TIME 0x00      ///< Time register
-#define DS3231_ALARM1 0x07    ///< Alarm 1 register
-#define DS3231_ALARM2 0x0B    ///< Alarm 2 register
-#define DS3231_CONTROL 0x0E   ///< Control register
-#define DS3231_STATUSREG 0x0F ///< Status register
+#ifdef ARDUINO // the I2C drivers are not built on a Linux host
+
+#define DS3231_ADDRESS 0x68     ///< I2C address for DS3231
+#define DS3231_TIME 0x00        ///< Time register
+#define DS3231_ALARM1 0x07      ///< Alarm 1 register
+#define DS3231_ALARM2 0x0B      ///< Alarm 2 register
+#define DS3231_CONTROL 0x0E     ///< Control register
+#define DS3231_STATUSREG 0x0F   ///< Status register
+#define DS3231_AGINGOFFSET 0x10 ///< Aging offset register
 #define DS3231_TEMPERATUREREG                                                  \
   0x11 ///< Temperature register (high byte - low byte is at 0x12), 10-bit
        ///< temperature value
@@ -44,15 +47,31 @@ bool RTC_DS3231::lostPower(void) {
     @param dt DateTime object containing the date/time to set
 */
 /**************************************************************************/
-void RTC_DS3231::adjust(const DateTime &dt) {
+void RTC_DS3231::adjust(const DateTime &dt) { adjust(DateTime64(dt)); }
+
+/**************************************************************************/
+/*!
+    @brief  Set the date over the chip's range of 2000 to 2199, and flip
+    the Oscillator Stop Flag
+    @details The century bit, bit 7 of the month register, is set for the
+    22nd century. The chip takes 2100 as a leap year: a clock running
+    through 2100-02-28 reads one day ahead afterwards, until adjusted again.
+    @param dt DateTime64 object containing the date/time to set. Dates
+    outside 2000 to 2199 are ignored.
+*/
+/**************************************************************************/
+void RTC_DS3231::adjust(const DateTime64 &dt) {
+  if (dt.year() < 2000 || dt.year() > 2199)
+    return;
+  uint8_t century = dt.year() >= 2100 ? 0x80 : 0;
   uint8_t buffer[8] = {DS3231_TIME,
                        bin2bcd(dt.second()),
                        bin2bcd(dt.minute()),
                        bin2bcd(dt.hour()),
                        bin2bcd(dowToDS3231(dt.dayOfTheWeek())),
                        bin2bcd(dt.day()),
-                       bin2bcd(dt.month()),
-                       bin2bcd(dt.year() - 2000U)};
+                       (uint8_t)(bin2bcd(dt.month()) | century),
+                       bin2bcd(dt.year() % 100)};
   i2c_dev->write(buffer, 8);
 
   uint8_t statreg = read_register(DS3231_STATUSREG);
@@ -63,17 +82,28 @@ void RTC_DS3231::adjust(const DateTime &dt) {
 /**************************************************************************/
 /*!
     @brief  Get the current date/time
-    @return DateTime object with the current date/time
+    @return DateTime object with the current date/time, invalid past 2099
+*/
+/**************************************************************************/
+DateTime RTC_DS3231::now() { return now64().toDateTime(); }
+
+/**************************************************************************/
+/*!
+    @brief  Get the current date/time, over the chip's range of 2000 to
+    2199
+    @return DateTime64 object with the current date/time, with the century
+    taken from bit 7 of the month register
 */
 /**************************************************************************/
-DateTime RTC_DS3231::now() {
+DateTime64 RTC_DS3231::now64() {
   uint8_t buffer[7];
   buffer[0] = 0;
   i2c_dev->write_then_read(buffer, 1, buffer, 7);
 
-  return DateTime(bcd2bin(buffer[6]) + 2000U, bcd2bin(buffer[5] & 0x7F),
-                  bcd2bin(buffer[4]), bcd2bin(buffer[2]), bcd2bin(buffer[1]),
-                  bcd2bin(buffer[0] & 0x7F));
+  uint16_t year = bcd2bin(buffer[6]) + (buffer[5] & 0x80 ? 2100U : 2000U);
+  return DateTime64(year, bcd2bin(buffer[5] & 0x1F), bcd2bin(buffer[4]),
+                    bcd2bin(buffer[2]), bcd2bin(buffer[1]),
+                    bcd2bin(buffer[0] & 0x7F));
 }
 
 /**************************************************************************/
@@ -111,10 +141,114 @@ void RTC_DS3231::writeSqwPinMode(Ds3231SqwPinMode mode) {
     @return Current temperature (float)
 */
 /**************************************************************************/
-float RTC_DS3231::getTemperature() {
+float RTC_DS3231::getTemperature() { return getTemperatureQuarters() * 0.25f; }
+
+/**************************************************************************/
+/*!
+    @brief  Get the current temperature without floating point math
+    @details This reads the result of the last conversion, which is
+    performed automatically every 64 seconds or on demand with
+    startTemperatureConversion().
+    @return Current temperature in units of 0.25 Celsius degree, e.g. 101
+    for 25.25 degrees
+*/
+/**************************************************************************/
+int16_t RTC_DS3231::getTemperatureQuarters(void) {
   uint8_t buffer[2] = {DS3231_TEMPERATUREREG, 0};
   i2c_dev->write_then_read(buffer, 1, buffer, 2);
-  return (float)buffer[0] + (buffer[1] >> 6) * 0.25f;
+  // The MSB holds the signed integer part, the LSB two bits of fraction
+  return (int8_t)buffer[0] * 4 + (buffer[1] >> 6);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Force a temperature conversion
+    @details This sets the CONV bit of the control register, which also
+    re-runs the capacitance array adjustment of the oscillator. It does not
+    block: poll isConvertingTemperature() until it returns false, which
+    takes up to 200 ms, then read the result with getTemperatureQuarters()
+    or getTemperature().
+    @return False if a conversion was already in progress, otherwise true
+*/
+/**************************************************************************/
+bool RTC_DS3231::startTemperatureConversion(void) {
+  uint8_t buffer[2] = {DS3231_CONTROL, 0};
+  i2c_dev->write_then_read(buffer, 1, buffer, 2);
+  if ((buffer[0] & 0x20) || (buffer[1] & 0x04)) // CONV or BSY
+    return false;
+  write_register(DS3231_CONTROL, buffer[0] | 0x20);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check whether a temperature conversion is in progress
+    @details This reads the control and status registers in one transfer,
+    and checks both the CONV bit of a forced conversion and the BSY flag of
+    an automatic one.
+    @return True if a conversion is in progress, false if the temperature
+    registers are up to date
+*/
+/**************************************************************************/
+bool RTC_DS3231::isConvertingTemperature(void) {
+  uint8_t buffer[2] = {DS3231_CONTROL, 0};
+  i2c_dev->write_then_read(buffer, 1, buffer, 2);
+  return (buffer[0] & 0x20) || (buffer[1] & 0x04);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the aging offset register
+    @return Current aging offset, from -128 to +127
+*/
+/**************************************************************************/
+int8_t RTC_DS3231::readAgingOffset(void) {
+  return (int8_t)read_register(DS3231_AGINGOFFSET);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write the aging offset register
+    @details This trims the crystal load capacitance, one unit being
+    roughly 0.1&nbsp;ppm at 25 degrees Celsius. A positive offset makes
+    the clock slower. The new value takes effect on the next temperature
+    conversion, which happens automatically every 64 seconds.
+    @param offset Aging offset, from -128 to +127
+*/
+/**************************************************************************/
+void RTC_DS3231::writeAgingOffset(int8_t offset) {
+  write_register(DS3231_AGINGOFFSET, (uint8_t)offset);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compensate a measured drift of the RTC.
+    @details This adds the correction for the given drift to the current
+    aging offset, rounding to the nearest unit of 0.1&nbsp;ppm and
+    saturating at the register limits. The drift is best measured with
+    measureDrift(), over a window of at least a day, e.g.:
+
+    ```
+    RTC_Micros reference; // or any other reference clock
+    rtc.calibrate(measureDrift(rtc, reference, 86400));
+    ```
+
+    To start over, reset the offset with writeAgingOffset(0) before
+    measuring.
+    @param ppb Measured drift in parts per billion, positive if the RTC
+    runs fast.
+    @return The new aging offset
+*/
+/**************************************************************************/
+int8_t RTC_DS3231::calibrate(int32_t ppb) {
+  int32_t offset = readAgingOffset();
+  offset += (ppb >= 0 ? ppb + 50 : ppb - 50) / 100;
+  if (offset > 127)
+    offset = 127;
+  else if (offset < -128)
+    offset = -128;
+  writeAgingOffset(offset);
+  return offset;
 }
 
 /**************************************************************************/
@@ -256,14 +390,13 @@ DateTime RTC_DS3231::getAlarm2() {
 
 /**************************************************************************/
 /*!
-    @brief  Get the mode for Alarm1
-    @return Ds3231Alarm1Mode enum value for the current Alarm1 mode
+    @brief  Decode the mode of Alarm1 from its registers
+    @param buffer Alarm1 registers (seconds, minutes, hour, day/date)
+    @return Mode set by the A1Mx and DY/DT bits, or DS3231_A1_Date if they
+    do not match any mode
 */
 /**************************************************************************/
-Ds3231Alarm1Mode RTC_DS3231::getAlarm1Mode() {
-  uint8_t buffer[5] = {DS3231_ALARM1, 0, 0, 0, 0};
-  i2c_dev->write_then_read(buffer, 1, buffer, 5);
-
+static Ds3231Alarm1Mode alarm1Mode(const uint8_t *buffer) {
   uint8_t alarm_mode = (buffer[0] & 0x80) >> 7    // A1M1 - Seconds bit
                        | (buffer[1] & 0x80) >> 6  // A1M2 - Minutes bit
                        | (buffer[2] & 0x80) >> 5  // A1M3 - Hour bit
@@ -287,14 +420,13 @@ Ds3231Alarm1Mode RTC_DS3231::getAlarm1Mode() {
 
 /**************************************************************************/
 /*!
-    @brief  Get the mode for Alarm2
-    @return Ds3231Alarm2Mode enum value for the current Alarm2 mode
+    @brief  Decode the mode of Alarm2 from its registers
+    @param buffer Alarm2 registers (minutes, hour, day/date)
+    @return Mode set by the A2Mx and DY/DT bits, or DS3231_A2_Date if they
+    do not match any mode
 */
 /**************************************************************************/
-Ds3231Alarm2Mode RTC_DS3231::getAlarm2Mode() {
-  uint8_t buffer[4] = {DS3231_ALARM2, 0, 0, 0};
-  i2c_dev->write_then_read(buffer, 1, buffer, 4);
-
+static Ds3231Alarm2Mode alarm2Mode(const uint8_t *buffer) {
   uint8_t alarm_mode = (buffer[0] & 0x80) >> 7    // A2M2 - Minutes bit
                        | (buffer[1] & 0x80) >> 6  // A2M3 - Hour bit
                        | (buffer[2] & 0x80) >> 5  // A2M4 - Day/Date bit
@@ -314,6 +446,86 @@ Ds3231Alarm2Mode RTC_DS3231::getAlarm2Mode() {
   }
 }
 
+/**************************************************************************/
+/*!
+    @brief  Get the mode for Alarm1
+    @return Ds3231Alarm1Mode enum value for the current Alarm1 mode
+*/
+/**************************************************************************/
+Ds3231Alarm1Mode RTC_DS3231::getAlarm1Mode() {
+  uint8_t buffer[5] = {DS3231_ALARM1, 0, 0, 0, 0};
+  i2c_dev->write_then_read(buffer, 1, buffer, 5);
+  return alarm1Mode(buffer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the mode for Alarm2
+    @return Ds3231Alarm2Mode enum value for the current Alarm2 mode
+*/
+/**************************************************************************/
+Ds3231Alarm2Mode RTC_DS3231::getAlarm2Mode() {
+  uint8_t buffer[4] = {DS3231_ALARM2, 0, 0, 0};
+  i2c_dev->write_then_read(buffer, 1, buffer, 4);
+  return alarm2Mode(buffer);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the complete state of Alarm1 in a single transfer
+    @details This reads the alarm, control and status registers in one
+    burst, so the returned fields are consistent with each other.
+    @return Ds3231AlarmState with the time, mode, DY/DT, enable and
+    flag of Alarm1
+*/
+/**************************************************************************/
+Ds3231AlarmState RTC_DS3231::readAlarm1() {
+  // Alarm1 (4 bytes), Alarm2 (3 bytes), control and status registers
+  uint8_t buffer[9] = {DS3231_ALARM1};
+  i2c_dev->write_then_read(buffer, 1, buffer, 9);
+
+  bool isDayOfWeek = buffer[3] & 0x40;
+  uint8_t day = bcd2bin(buffer[3] & (isDayOfWeek ? 0x0F : 0x3F));
+  // Hours are always stored in 24 hour format by this library
+  Ds3231AlarmState state = {
+      DateTime(2000, 5, day, bcd2bin(buffer[2] & 0x3F),
+               bcd2bin(buffer[1] & 0x7F), bcd2bin(buffer[0] & 0x7F)),
+      alarm1Mode(buffer),
+      isDayOfWeek,
+      (buffer[7] & 0x01) != 0,  // A1IE
+      (buffer[8] & 0x01) != 0,  // A1F
+      (buffer[7] & 0x04) != 0}; // INTCN
+  return state;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the complete state of Alarm2 in a single transfer
+    @details This reads the alarm, control and status registers in one
+    burst, so the returned fields are consistent with each other.
+    @return Ds3231AlarmState with the time, mode, DY/DT, enable and
+    flag of Alarm2
+*/
+/**************************************************************************/
+Ds3231AlarmState RTC_DS3231::readAlarm2() {
+  // Alarm2 (3 bytes), control and status registers
+  uint8_t buffer[5] = {DS3231_ALARM2};
+  i2c_dev->write_then_read(buffer, 1, buffer, 5);
+
+  bool isDayOfWeek = buffer[2] & 0x40;
+  uint8_t day = bcd2bin(buffer[2] & (isDayOfWeek ? 0x0F : 0x3F));
+  // Hours are always stored in 24 hour format by this library
+  Ds3231AlarmState state = {
+      DateTime(2000, 5, day, bcd2bin(buffer[1] & 0x3F),
+               bcd2bin(buffer[0] & 0x7F), 0),
+      alarm2Mode(buffer),
+      isDayOfWeek,
+      (buffer[3] & 0x02) != 0,  // A2IE
+      (buffer[4] & 0x02) != 0,  // A2F
+      (buffer[3] & 0x04) != 0}; // INTCN
+  return state;
+}
+
 /**************************************************************************/
 /*!
     @brief  Disable alarm
@@ -382,3 +594,38 @@ void RTC_DS3231::disable32K(void) {
 bool RTC_DS3231::isEnabled32K(void) {
   return (read_register(DS3231_STATUSREG) >> 0x03) & 0x01;
 }
+
+/**************************************************************************/
+/*!
+    @brief  Save the configuration of the DS3231 in a single transfer
+    @return Ds3231Snapshot holding the alarm, control, status and aging
+    offset registers
+*/
+/**************************************************************************/
+Ds3231Snapshot RTC_DS3231::snapshot() {
+  Ds3231Snapshot snap;
+  uint8_t addrByte = DS3231_ALARM1;
+  i2c_dev->write_then_read(&addrByte, 1, snap.registers,
+                           sizeof(snap.registers));
+  return snap;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restore a configuration saved with snapshot() in a single
+    transfer
+    @details The oscillator stop and alarm flags are left untouched: they
+    reflect events, not configuration.
+    @param snap Ds3231Snapshot to restore
+*/
+/**************************************************************************/
+void RTC_DS3231::restore(const Ds3231Snapshot &snap) {
+  uint8_t buffer[sizeof(snap.registers)];
+  memcpy(buffer, snap.registers, sizeof(buffer));
+  // Writing 1 to OSF, A2F and A1F leaves them unchanged
+  buffer[DS3231_STATUSREG - DS3231_ALARM1] |= 0x83;
+  uint8_t addrByte = DS3231_ALARM1;
+  i2c_dev->write(buffer, sizeof(buffer), true, &addrByte, 1);
+}
+
+#endif // ARDUINO
@@ -0,0 +1,148 @@
+#include "RTClib.h"
+
+#ifndef ARDUINO // Linux host backend for RTC_Millis and RTC_Micros
+
+#define NANOS_PER_SECOND 1000000000LL ///< Nanoseconds in one second
+
+/**************************************************************************/
+/*!
+    @brief  Read one of the system clocks. On Linux, this is serviced by the
+            vDSO without entering the kernel.
+    @param clock_id `CLOCK_MONOTONIC` or `CLOCK_REALTIME`
+    @return Clock reading in nanoseconds
+*/
+/**************************************************************************/
+static int64_t clockNanos(clockid_t clock_id) {
+  struct timespec ts;
+  clock_gettime(clock_id, &ts);
+  return ts.tv_sec * NANOS_PER_SECOND + ts.tv_nsec;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Convert a nanosecond count to a MonotonicTime.
+    @param nanos Non-negative number of nanoseconds
+    @return MonotonicTime with microsecond resolution
+*/
+/**************************************************************************/
+static MonotonicTime nanosToMonotonic(int64_t nanos) {
+  return MonotonicTime(nanos / NANOS_PER_SECOND,
+                       (nanos % NANOS_PER_SECOND) / 1000);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Apply a drift compensation to an elapsed time.
+    @param nanos Elapsed time, in nanoseconds
+    @param ppm Compensation, positive to make the clock faster
+    @return Compensated elapsed time, in nanoseconds
+*/
+/**************************************************************************/
+static int64_t applyDrift(int64_t nanos, int32_t ppm) {
+  // Split the product to avoid overflow on long uptimes
+  return nanos + nanos / 1000000 * ppm + nanos % 1000000 * ppm / 1000000;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Start the RTC_Millis clock from the system wall clock.
+*/
+/**************************************************************************/
+void RTC_Millis::begin() {
+  monoNanos = clockNanos(CLOCK_MONOTONIC);
+  unixNanos = clockNanos(CLOCK_REALTIME);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the current date/time of the RTC_Millis clock.
+    @param dt DateTime object with the desired date and time
+*/
+/**************************************************************************/
+void RTC_Millis::adjust(const DateTime &dt) {
+  monoNanos = clockNanos(CLOCK_MONOTONIC);
+  unixNanos = dt.unixtime() * NANOS_PER_SECOND;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Return a DateTime object containing the current date/time.
+    @return DateTime object containing current time
+*/
+/**************************************************************************/
+DateTime RTC_Millis::now() {
+  int64_t elapsed = clockNanos(CLOCK_MONOTONIC) - monoNanos;
+  return DateTime((uint32_t)((unixNanos + elapsed) / NANOS_PER_SECOND));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the monotonic timescale of the RTC_Millis clock.
+    @return MonotonicTime counting from boot, not affected by adjust()
+*/
+/**************************************************************************/
+MonotonicTime RTC_Millis::monotonic() {
+  return nanosToMonotonic(clockNanos(CLOCK_MONOTONIC));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Start the RTC_Micros clock from the system wall clock.
+*/
+/**************************************************************************/
+void RTC_Micros::begin() {
+  monoNanos = clockNanos(CLOCK_MONOTONIC);
+  unixNanos = clockNanos(CLOCK_REALTIME);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the current date/time of the RTC_Micros clock.
+    @param dt DateTime object with the desired date and time
+*/
+/**************************************************************************/
+void RTC_Micros::adjust(const DateTime &dt) {
+  monoNanos = clockNanos(CLOCK_MONOTONIC);
+  unixNanos = dt.unixtime() * NANOS_PER_SECOND;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Adjust the RTC_Micros clock to compensate for system clock drift
+    @details As on Arduino, only the time from now on is affected: the
+            time elapsed so far is folded into the current time first.
+    @param ppm Adjustment to make. A positive adjustment makes the clock faster.
+*/
+/**************************************************************************/
+void RTC_Micros::adjustDrift(int ppm) {
+  int64_t mono = clockNanos(CLOCK_MONOTONIC);
+  unixNanos += applyDrift(mono - monoNanos, driftPpm);
+  monoNanos = mono;
+  driftPpm = ppm;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the current date/time from the RTC_Micros clock.
+    @return DateTime object containing the current date/time
+*/
+/**************************************************************************/
+DateTime RTC_Micros::now() {
+  int64_t elapsed =
+      applyDrift(clockNanos(CLOCK_MONOTONIC) - monoNanos, driftPpm);
+  return DateTime((uint32_t)((unixNanos + elapsed) / NANOS_PER_SECOND));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the monotonic timescale of the RTC_Micros clock.
+    @details Unlike now(), this is not drift-compensated: the system's
+            monotonic clock is already disciplined on a Linux host.
+    @return MonotonicTime counting from boot, not affected by adjust()
+*/
+/**************************************************************************/
+MonotonicTime RTC_Micros::monotonic() {
+  return nanosToMonotonic(clockNanos(CLOCK_MONOTONIC));
+}
+
+#endif // ARDUINO
@@ -1,5 +1,7 @@
 #include "RTClib.h"
 
+#ifdef ARDUINO // see RTC_Host.cpp for the Linux host implementation
+
 /**************************************************************************/
 /*!
     @brief  Set the current date/time of the RTC_Micros clock.
@@ -31,3 +33,32 @@ DateTime RTC_Micros::now() {
   lastUnix += elapsedSeconds;
   return lastUnix;
 }
+
+/**************************************************************************/
+/*!
+    @brief  Read the monotonic timescale of the RTC_Micros clock.
+    @details This counts the time elapsed since boot, compensated for drift
+            like now(), but unlike now() it is not affected by adjust(). It
+            has to be called more frequently than the micros() rollover
+            period.
+    @return MonotonicTime with microsecond resolution
+*/
+/**************************************************************************/
+MonotonicTime RTC_Micros::monotonic() {
+  uint32_t elapsed = micros() - monoMicros;
+  uint32_t elapsedSeconds = elapsed / microsPerSecond;
+  monoMicros += elapsedSeconds * microsPerSecond;
+  monoSeconds += elapsedSeconds;
+  uint32_t fraction = elapsed - elapsedSeconds * microsPerSecond;
+  if (microsPerSecond != 1000000) {
+    // Scale the ticks left over to calibrated microseconds, in two 32-bit
+    // steps of 1000: they are less than microsPerSecond, so neither
+    // product overflows, and the result is the same as one exact division
+    uint32_t scaled = fraction * 1000;
+    fraction = scaled / microsPerSecond * 1000 +
+               scaled % microsPerSecond * 1000 / microsPerSecond;
+  }
+  return MonotonicTime(monoSeconds, fraction);
+}
+
+#endif // ARDUINO
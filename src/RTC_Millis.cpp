@@ -1,5 +1,7 @@
 #include "RTClib.h"
 
+#ifdef ARDUINO // see RTC_Host.cpp for the Linux host implementation
+
 /**************************************************************************/
 /*!
     @brief  Set the current date/time of the RTC_Millis clock.
@@ -25,3 +27,22 @@ DateTime RTC_Millis::now() {
   lastUnix += elapsedSeconds;
   return lastUnix;
 }
+
+/**************************************************************************/
+/*!
+    @brief  Read the monotonic timescale of the RTC_Millis clock.
+    @details This counts the time elapsed since boot and, unlike now(), is
+            not affected by adjust(). Like now(), it is rollover-safe as long
+            as it is called at least once every 49.7 days.
+    @return MonotonicTime with millisecond resolution
+*/
+/**************************************************************************/
+MonotonicTime RTC_Millis::monotonic() {
+  uint32_t elapsed = millis() - monoMillis;
+  uint32_t elapsedSeconds = elapsed / 1000;
+  monoMillis += elapsedSeconds * 1000;
+  monoSeconds += elapsedSeconds;
+  return MonotonicTime(monoSeconds, (elapsed - elapsedSeconds * 1000) * 1000);
+}
+
+#endif // ARDUINO
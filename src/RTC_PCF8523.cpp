@@ -1,14 +1,23 @@
 #include "RTClib.h"
 
+#ifdef ARDUINO // the I2C drivers are not built on a Linux host
+
 #define PCF8523_ADDRESS 0x68       ///< I2C address for PCF8523
 #define PCF8523_CLKOUTCONTROL 0x0F ///< Timer and CLKOUT control register
 #define PCF8523_CONTROL_1 0x00     ///< Control and status register 1
 #define PCF8523_CONTROL_2 0x01     ///< Control and status register 2
 #define PCF8523_CONTROL_3 0x02     ///< Control and status register 3
+#define PCF8523_TIMER_A_FRCTL 0x10 ///< Timer A source clock frequency control
+#define PCF8523_TIMER_A_VALUE 0x11 ///< Timer A value (number clock periods)
 #define PCF8523_TIMER_B_FRCTL 0x12 ///< Timer B source clock frequency control
 #define PCF8523_TIMER_B_VALUE 0x13 ///< Timer B value (number clock periods)
 #define PCF8523_OFFSET 0x0E        ///< Offset register
 #define PCF8523_STATUSREG 0x03     ///< Status register
+#define PCF8523_ALARM 0x0A         ///< Alarm registers, first of 4
+#define PCF8523_AIE 0x02           ///< Alarm interrupt enable bit of Control_1
+#define PCF8523_AF 0x08            ///< Alarm flag bit of Control_2
+#define PCF8523_OFFSET_2H 4340     ///< Offset unit in ppb, PCF8523_TwoHours
+#define PCF8523_OFFSET_1M 4069     ///< Offset unit in ppb, PCF8523_OneMinute
 
 /**************************************************************************/
 /*!
@@ -55,6 +64,9 @@ bool RTC_PCF8523::initialized(void) {
 /**************************************************************************/
 /*!
     @brief  Set the date and time, set battery switchover mode
+    @details The switchover mode is set to PCF8523_SwitchoverStandard if it
+   still has its power-on default; one chosen with writeSwitchoverMode() is
+   kept.
     @param dt DateTime to set
 */
 /**************************************************************************/
@@ -64,13 +76,14 @@ void RTC_PCF8523::adjust(const DateTime &dt) {
                        bin2bcd(dt.minute()),
                        bin2bcd(dt.hour()),
                        bin2bcd(dt.day()),
-                       bin2bcd(0), // skip weekdays
+                       dt.dayOfTheWeek(),
                        bin2bcd(dt.month()),
                        bin2bcd(dt.year() - 2000U)};
   i2c_dev->write(buffer, 8);
 
   // set to battery switchover mode
-  write_register(PCF8523_CONTROL_3, 0x00);
+  if (!initialized())
+    writeSwitchoverMode(PCF8523_SwitchoverStandard);
 }
 
 /**************************************************************************/
@@ -175,7 +188,9 @@ void RTC_PCF8523::disableSecondTimer() {
    countdown period ranging from 244 microseconds to 10.625 days.
     Uses PCF8523 Timer B. Any existing CLKOUT square wave, configured with
    writeSqwPinMode(), will halt. The interrupt low pulse width is adjustable
-   from 3/64ths (default) to 14/64ths of a second.
+   from 3/64ths (default) to 14/64ths of a second. On the 1 Hz, 1/60 Hz and
+   1/3600 Hz clocks, which keep running, the first countdown lasts between
+   numPeriods - 1 and numPeriods periods.
     @param clkFreq One of the PCF8523's Timer Source Clock Frequencies.
    See the #PCF8523TimerClockFreq enum for options and associated time ranges.
     @param numPeriods The number of clkFreq periods (1-255) to count down.
@@ -226,7 +241,7 @@ void RTC_PCF8523::enableCountdownTimer(PCF8523TimerClockFreq clkFreq,
     @brief  Disable the Countdown Timer Interrupt on the PCF8523.
     @details For simplicity, this function strictly disables Timer B by setting
    TBC to 0. The datasheet describes TBC as the Timer B on/off switch.
-   Timer B is the only countdown timer implemented at this time.
+   Timer A is left running, see disableTimerA().
    The following flags have no effect while TBC is off, they are *not* cleared:
       - TBM: Timer B will still be set to pulsed mode.
       - CTBIE: Timer B interrupt would be triggered if TBC were on.
@@ -240,21 +255,318 @@ void RTC_PCF8523::disableCountdownTimer() {
                  ~1 & read_register(PCF8523_CLKOUTCONTROL));
 }
 
+/**************************************************************************/
+/*!
+    @brief  Enable Timer A as a countdown timer and its interrupt.
+    @details The INT/SQW pin will be pulsed low each time Timer A counts
+   down to zero, after which it reloads and counts down again. Timer A runs
+   independently of Timer B, so a long periodic wake-up can run on one
+   timer and a short countdown on the other. The pulse mode (TAM) is shared
+   with the second timer, and CLKOUT is disabled as for Timer B. As on
+   Timer B, the first countdown on the 1 Hz, 1/60 Hz and 1/3600 Hz clocks
+   lasts between numPeriods - 1 and numPeriods periods; the following ones
+   are whole. This takes five transfers.
+    @param clkFreq One of the PCF8523's Timer Source Clock Frequencies.
+   See the #PCF8523TimerClockFreq enum for options and associated time ranges.
+    @param numPeriods The number of clkFreq periods (1-255) to count down.
+*/
+/**************************************************************************/
+void RTC_PCF8523::enableCountdownTimerA(PCF8523TimerClockFreq clkFreq,
+                                        uint8_t numPeriods) {
+  // TAM pulse int. mode, CLKOUT disabled, TAC = 01 countdown timer
+  configureTimerA(clkFreq, numPeriods, 0xB8 | 0x02);
+  // CTAIE Countdown Timer A Interrupt Enabled, clear CTAF
+  writeControl2(0x02, 0x40);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Enable Timer A as a watchdog timer and its interrupt.
+    @details The INT/SQW pin is asserted if Timer A counts down to zero
+   before feedWatchdog() restarts it. It is released when Control_2 is read,
+   e.g. by timerAFired(); wire it to the MCU reset to recover from a hang.
+   The pulse mode (TAM) is left as is: when it is cleared, INT stays
+   asserted until then. This takes five transfers.
+    @param clkFreq One of the PCF8523's Timer Source Clock Frequencies.
+   See the #PCF8523TimerClockFreq enum for options and associated time ranges.
+    @param numPeriods The number of clkFreq periods (1-255) before the
+   watchdog fires.
+*/
+/**************************************************************************/
+void RTC_PCF8523::enableWatchdogTimer(PCF8523TimerClockFreq clkFreq,
+                                      uint8_t numPeriods) {
+  // CLKOUT disabled, TAC = 10 watchdog timer
+  configureTimerA(clkFreq, numPeriods, 0x38 | 0x04);
+  // WTAIE Watchdog Timer A Interrupt Enabled; WTAF is cleared by the read
+  writeControl2(0x04, 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restart the watchdog timer in a single transfer.
+    @param numPeriods The number of clock periods (1-255) before the
+   watchdog fires, usually the value given to enableWatchdogTimer().
+*/
+/**************************************************************************/
+void RTC_PCF8523::feedWatchdog(uint8_t numPeriods) {
+  write_register(PCF8523_TIMER_A_VALUE, numPeriods);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Disable Timer A, in countdown or watchdog mode.
+    @details As with disableCountdownTimer(), this only stops the timer by
+   setting TAC to 00. Timer B and the second timer are left running.
+*/
+/**************************************************************************/
+void RTC_PCF8523::disableTimerA() {
+  write_register(PCF8523_CLKOUTCONTROL,
+                 read_register(PCF8523_CLKOUTCONTROL) & ~0x06);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check and clear the Timer A flags.
+    @details Reading Control_2 clears the watchdog flag (WTAF) in hardware.
+   The countdown flag (CTAF), if set, is then cleared without touching the
+   other flags.
+    @return True if Timer A has counted down to zero, in either mode, since
+   the flags were last cleared
+*/
+/**************************************************************************/
+bool RTC_PCF8523::timerAFired() {
+  uint8_t ctlreg = read_register(PCF8523_CONTROL_2);
+  if (ctlreg & 0x40)
+    // Writing 1 to CTBF, SF and AF leaves them unchanged
+    write_register(PCF8523_CONTROL_2, (ctlreg | 0x38) & ~0x40);
+  return ctlreg & 0xC0;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Load Timer A and start it in the given mode.
+    @details The timer is stopped in the same transfer that loads its
+   frequency and value, as the datasheet cautions against updating the value
+   while it runs, then started with a second transfer.
+    @param clkFreq Timer A source clock frequency
+    @param numPeriods The number of clkFreq periods (1-255) to count down
+    @param clkout Bits to set in the Timer and CLKOUT control register,
+   including the TAC mode
+*/
+/**************************************************************************/
+void RTC_PCF8523::configureTimerA(PCF8523TimerClockFreq clkFreq,
+                                  uint8_t numPeriods, uint8_t clkout) {
+  uint8_t clkreg;
+  read_registers(PCF8523_CLKOUTCONTROL, &clkreg, 1); // one write_then_read
+  clkreg &= ~0x06;
+  uint8_t buffer[4] = {PCF8523_CLKOUTCONTROL, clkreg, (uint8_t)clkFreq,
+                       numPeriods};
+  i2c_dev->write(buffer, 4);
+  write_register(PCF8523_CLKOUTCONTROL, clkreg | clkout);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set interrupt enable bits in Control_2 and clear some flags.
+    @details Writing 1 to a flag leaves it unchanged, so only the flags in
+   clear are affected.
+    @param enable Interrupt enable bits to set
+    @param clear Flags to clear
+*/
+/**************************************************************************/
+void RTC_PCF8523::writeControl2(uint8_t enable, uint8_t clear) {
+  uint8_t ctlreg;
+  read_registers(PCF8523_CONTROL_2, &ctlreg, 1); // one write_then_read
+  write_register(PCF8523_CONTROL_2, (ctlreg | 0x78 | enable) & ~clear);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Start a countdown planned with Pcf8523Countdown::plan().
+    @details The countdown uses both Timer A and Timer B: Timer A runs the
+   long stage, and updateCountdown() switches to Timer B for the short
+   stage. The switch happens in software, so each wake-up adds the time
+   taken to service the interrupt to the countdown. On a source clock of
+   1 Hz or slower, the first period of each timer may be short, see
+   Pcf8523Countdown::uncertaintyMicros().
+    @param countdown Planned countdown, rewound to its start
+*/
+/**************************************************************************/
+void RTC_PCF8523::startCountdown(Pcf8523Countdown &countdown) {
+  if (!countdown.start())
+    return;
+  disableCountdownTimer();
+  enableCountdownTimerA(countdown.longFreq(), countdown.longPeriods());
+}
+
+/**************************************************************************/
+/*!
+    @brief  Advance a countdown started with startCountdown().
+    @details Call this on each interrupt from the INT/SQW pin. It clears
+   the Timer A and Timer B flags, counts the long stages, and starts the
+   short stage on Timer B after the last one. It may be polled instead, but
+   then at least once per long stage: CTAF does not count how many times
+   Timer A fired, so stages elapsed between two calls are counted as one.
+   The delay from a wake-up to the call adds to the countdown.
+    @param countdown Running countdown
+    @return True once the whole countdown has elapsed
+*/
+/**************************************************************************/
+bool RTC_PCF8523::updateCountdown(Pcf8523Countdown &countdown) {
+  uint8_t ctlreg = read_register(PCF8523_CONTROL_2);
+  uint8_t fired = ctlreg & 0x60; // CTAF, CTBF
+  if (!fired)
+    return false;
+  // Writing 1 to the other flags leaves them unchanged
+  write_register(PCF8523_CONTROL_2, (ctlreg | 0x78) & ~fired);
+  if (fired & 0x20) {
+    disableCountdownTimer();
+    return true;
+  }
+  if (!countdown.countLong())
+    return false;
+  disableTimerA();
+  if (!countdown.shortPeriods())
+    return true;
+  enableCountdownTimer(countdown.shortFreq(), countdown.shortPeriods());
+  return false;
+}
+
 /**************************************************************************/
 /*!
     @brief  Stop all timers, clear their flags and settings on the PCF8523.
-    @details This includes the Countdown Timer, Second Timer, and any CLKOUT
-   square wave configured with writeSqwPinMode().
+    @details This includes the Countdown Timer, Timer A, Second Timer, and any
+   CLKOUT square wave configured with writeSqwPinMode().
 */
 /**************************************************************************/
 void RTC_PCF8523::deconfigureAllTimers() {
   disableSecondTimer(); // Surgically clears CONTROL_1
   write_register(PCF8523_CONTROL_2, 0);
   write_register(PCF8523_CLKOUTCONTROL, 0);
+  write_register(PCF8523_TIMER_A_FRCTL, 0);
+  write_register(PCF8523_TIMER_A_VALUE, 0);
   write_register(PCF8523_TIMER_B_FRCTL, 0);
   write_register(PCF8523_TIMER_B_VALUE, 0);
 }
 
+/**************************************************************************/
+/*!
+    @brief  Set the alarm and enable its interrupt on the INT1 pin
+    @details The alarm fires when all the selected fields match the current
+   time; the seconds are not compared, so it fires at the start of the
+   minute. The day of the week is taken from dt, as written by adjust().
+   The four alarm registers are written in one burst, then AIE is set and
+   AF cleared in one more, as the time registers sit in between. AF stays
+   set once the alarm fires until cleared with clearAlarm().
+    @param dt DateTime object holding the minute, hour, day and day of the
+   week to match
+    @param mode Fields to match, an OR of #Pcf8523AlarmMode values
+    @return False if no field is selected, otherwise true
+*/
+/**************************************************************************/
+bool RTC_PCF8523::setAlarm(const DateTime &dt, uint8_t mode) {
+  if (!(mode & 0x0F))
+    return false;
+  // AEN_x bit 7 set disables the field
+  uint8_t buffer[5] = {
+      PCF8523_ALARM,
+      (uint8_t)(bin2bcd(dt.minute()) | (mode & PCF8523_AlarmMinute ? 0 : 0x80)),
+      (uint8_t)(bin2bcd(dt.hour()) | (mode & PCF8523_AlarmHour ? 0 : 0x80)),
+      (uint8_t)(bin2bcd(dt.day()) | (mode & PCF8523_AlarmDay ? 0 : 0x80)),
+      (uint8_t)(dt.dayOfTheWeek() | (mode & PCF8523_AlarmWeekday ? 0 : 0x80))};
+  i2c_dev->write(buffer, 5);
+  writeAlarmControl(true);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the date/time value of the alarm
+    @return DateTime object with the alarm minute and hour set. The day is
+   the day of the month, or, if only the day of the week is matched, a day
+   of the first week of May 2000, where it equals the day of the week
+   (7 for Sunday).
+*/
+/**************************************************************************/
+DateTime RTC_PCF8523::getAlarm() {
+  uint8_t buffer[4] = {PCF8523_ALARM};
+  i2c_dev->write_then_read(buffer, 1, buffer, 4);
+
+  uint8_t day = bcd2bin(buffer[2] & 0x3F);
+  if ((buffer[2] & 0x80) && !(buffer[3] & 0x80)) {
+    day = buffer[3] & 0x07;
+    if (day == 0)
+      day = 7;
+  }
+  return DateTime(2000, 5, day, bcd2bin(buffer[1] & 0x3F),
+                  bcd2bin(buffer[0] & 0x7F), 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the fields matched by the alarm
+    @return An OR of #Pcf8523AlarmMode values, 0 if the alarm is disabled
+*/
+/**************************************************************************/
+uint8_t RTC_PCF8523::getAlarmMode() {
+  uint8_t buffer[4] = {PCF8523_ALARM};
+  i2c_dev->write_then_read(buffer, 1, buffer, 4);
+
+  uint8_t mode = 0;
+  for (uint8_t i = 0; i < 4; i++)
+    if (!(buffer[i] & 0x80))
+      mode |= 1 << i;
+  return mode;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Disable the alarm and its interrupt, and clear AF
+*/
+/**************************************************************************/
+void RTC_PCF8523::disableAlarm(void) {
+  writeAlarmControl(false);
+
+  uint8_t buffer[5] = {PCF8523_ALARM, 0x80, 0x80, 0x80, 0x80};
+  i2c_dev->write(buffer, 5);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clear the alarm flag (AF), releasing the INT1 pin
+*/
+/**************************************************************************/
+void RTC_PCF8523::clearAlarm(void) { writeControl2(0, PCF8523_AF); }
+
+/**************************************************************************/
+/*!
+    @brief  Get the status of the alarm flag (AF)
+    @return True if the alarm has fired since it was last cleared
+*/
+/**************************************************************************/
+bool RTC_PCF8523::alarmFired(void) {
+  return read_register(PCF8523_CONTROL_2) & PCF8523_AF;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set or clear AIE in Control_1 and clear AF in Control_2, reading
+   and writing both registers in one transfer each
+    @param enable True to enable the alarm interrupt
+*/
+/**************************************************************************/
+void RTC_PCF8523::writeAlarmControl(bool enable) {
+  uint8_t control[2];
+  read_registers(PCF8523_CONTROL_1, control, 2);
+  if (enable)
+    control[0] |= PCF8523_AIE;
+  else
+    control[0] &= ~PCF8523_AIE;
+  // Writing 1 to CTAF, CTBF and SF leaves them unchanged
+  control[1] = (control[1] | 0x78) & ~PCF8523_AF;
+  write_registers(PCF8523_CONTROL_1, control, 2);
+}
+
 /**************************************************************************/
 /*!
     @brief Compensate the drift of the RTC.
@@ -290,3 +602,200 @@ void RTC_PCF8523::deconfigureAllTimers() {
 void RTC_PCF8523::calibrate(Pcf8523OffsetMode mode, int8_t offset) {
   write_register(PCF8523_OFFSET, ((uint8_t)offset & 0x7F) | mode);
 }
+
+/**************************************************************************/
+/*!
+    @brief  Compensate a measured drift of the RTC.
+    @details This adds the correction currently in the offset register to
+    the given drift, to get the drift of the bare oscillator, then picks
+    the mode and offset that best cancel it, saturating at the register
+    limits. PCF8523_TwoHours is kept unless PCF8523_OneMinute leaves a
+    smaller residual, as it draws less current. The drift is best measured
+    with measureDrift(), over a window of at least a day, e.g.:
+
+    ```
+    RTC_Micros reference; // or any other reference clock
+    rtc.calibrate(measureDrift(rtc, reference, 86400));
+    ```
+
+    To start over, reset the offset with calibrate(PCF8523_TwoHours, 0)
+    before measuring.
+    @param ppb Measured drift in parts per billion, positive if the RTC
+    runs fast.
+    @return The new offset, as for RTC_DS3231::calibrate(); the mode picked
+    is read back with readOffsetMode(). The drift left over is that of the
+    bare oscillator minus the offset times its unit.
+*/
+/**************************************************************************/
+int8_t RTC_PCF8523::calibrate(int32_t ppb) {
+  uint8_t reg = read_register(PCF8523_OFFSET);
+  int32_t offset = (int8_t)(reg << 1) >> 1;
+  int64_t raw = ppb + (int64_t)offset * (reg & PCF8523_OneMinute
+                                             ? PCF8523_OFFSET_1M
+                                             : PCF8523_OFFSET_2H);
+
+  Pcf8523OffsetMode mode = PCF8523_TwoHours;
+  int64_t residual = 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    int32_t unit = i ? PCF8523_OFFSET_1M : PCF8523_OFFSET_2H;
+    int64_t o = (raw >= 0 ? raw + unit / 2 : raw - unit / 2) / unit;
+    if (o > 63)
+      o = 63;
+    else if (o < -64)
+      o = -64;
+    int64_t r = raw - o * unit;
+    if (i == 0 || (r < 0 ? -r : r) < (residual < 0 ? -residual : residual)) {
+      mode = i ? PCF8523_OneMinute : PCF8523_TwoHours;
+      offset = o;
+      residual = r;
+    }
+  }
+  calibrate(mode, offset);
+  return offset;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the offset register
+    @return Current offset, from -64 to +63
+*/
+/**************************************************************************/
+int8_t RTC_PCF8523::readOffset(void) {
+  return (int8_t)(read_register(PCF8523_OFFSET) << 1) >> 1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the offset mode
+    @return Current offset mode, either `PCF8523_TwoHours` or
+      `PCF8523_OneMinute`.
+*/
+/**************************************************************************/
+Pcf8523OffsetMode RTC_PCF8523::readOffsetMode(void) {
+  return static_cast<Pcf8523OffsetMode>(read_register(PCF8523_OFFSET) &
+                                        PCF8523_OneMinute);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Decode the battery switchover mode from Control_3
+    @param control3 Control_3 register
+    @return Mode set by the PM bits. With switchover disabled, the direct
+    bit does not matter: 011 reads as PCF8523_SwitchoverDisabled, and 110,
+    which the datasheet does not allow, as PCF8523_SwitchoverDisabledNoBLD.
+*/
+/**************************************************************************/
+static Pcf8523SwitchoverMode switchoverMode(uint8_t control3) {
+  switch (control3 & 0xE0) {
+  case 0x60:
+    return PCF8523_SwitchoverDisabled;
+  case 0xC0:
+    return PCF8523_SwitchoverDisabledNoBLD;
+  default:
+    return static_cast<Pcf8523SwitchoverMode>(control3 & 0xE0);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the power, battery and interrupt flags in a single transfer
+    @details Reading Control_2 clears WTAF, as timerAFired() does; the other
+   flags are left set.
+    @return Pcf8523Status decoded from registers 0x00 to 0x03
+*/
+/**************************************************************************/
+Pcf8523Status RTC_PCF8523::readStatus(void) {
+  uint8_t buffer[4] = {PCF8523_CONTROL_1};
+  i2c_dev->write_then_read(buffer, 1, buffer, 4);
+
+  Pcf8523Status status = {
+      switchoverMode(buffer[2]),
+      (buffer[2] & 0x04) != 0,  // BLF
+      (buffer[2] & 0x08) != 0,  // BSF
+      (buffer[3] & 0x80) != 0,  // OS
+      (buffer[0] & 0x20) != 0,  // STOP
+      (buffer[1] & 0x08) != 0,  // AF
+      (buffer[1] & 0x10) != 0,  // SF
+      (buffer[1] & 0xC0) != 0,  // WTAF, CTAF
+      (buffer[1] & 0x20) != 0}; // CTBF
+  return status;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the battery switchover mode
+    @return Mode as a #Pcf8523SwitchoverMode enum
+*/
+/**************************************************************************/
+Pcf8523SwitchoverMode RTC_PCF8523::readSwitchoverMode(void) {
+  return switchoverMode(read_register(PCF8523_CONTROL_3));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Set the battery switchover mode
+    @details The battery interrupt enables and flags are left unchanged.
+   Note that PCF8523_SwitchoverDisabledNoBLD is also the power-on default,
+   so initialized() returns false with it, and adjust() replaces it with
+   PCF8523_SwitchoverStandard.
+    @param mode The mode to use
+*/
+/**************************************************************************/
+void RTC_PCF8523::writeSwitchoverMode(Pcf8523SwitchoverMode mode) {
+  uint8_t ctlreg = read_register(PCF8523_CONTROL_3);
+  // Writing 1 to BSF leaves it unchanged; BLF is read-only
+  write_register(PCF8523_CONTROL_3, (ctlreg & 0x03) | 0x08 | mode);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clear the battery switchover flag (BSF)
+*/
+/**************************************************************************/
+void RTC_PCF8523::clearBatterySwitchover(void) {
+  uint8_t ctlreg = read_register(PCF8523_CONTROL_3);
+  write_register(PCF8523_CONTROL_3, ctlreg & ~0x08);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Save the configuration of the PCF8523 in a single transfer
+    @return Pcf8523Snapshot holding the control, alarm, offset, CLKOUT and
+   timer registers
+*/
+/**************************************************************************/
+Pcf8523Snapshot RTC_PCF8523::snapshot() {
+  // Registers 0x00 to 0x13, time registers included
+  uint8_t buffer[PCF8523_TIMER_B_VALUE + 1] = {PCF8523_CONTROL_1};
+  i2c_dev->write_then_read(buffer, 1, buffer, sizeof(buffer));
+
+  Pcf8523Snapshot snap;
+  memcpy(snap.control, buffer, sizeof(snap.control));
+  memcpy(snap.registers, buffer + PCF8523_ALARM, sizeof(snap.registers));
+  return snap;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restore a configuration saved with snapshot()
+    @details This takes two transfers, one for the control registers and one
+   for the alarm to timer registers, leaving the time registers in between
+   untouched. Interrupt flags are left untouched as well: they reflect
+   events, not configuration.
+    @param snap Pcf8523Snapshot to restore
+*/
+/**************************************************************************/
+void RTC_PCF8523::restore(const Pcf8523Snapshot &snap) {
+  uint8_t control[sizeof(snap.control)];
+  memcpy(control, snap.control, sizeof(control));
+  // Writing 1 to CTAF, CTBF, SF, AF and BSF leaves them unchanged
+  control[PCF8523_CONTROL_2] |= 0x78;
+  control[PCF8523_CONTROL_3] |= 0x08;
+  uint8_t addrByte = PCF8523_CONTROL_1;
+  i2c_dev->write(control, sizeof(control), true, &addrByte, 1);
+
+  addrByte = PCF8523_ALARM;
+  i2c_dev->write(snap.registers, sizeof(snap.registers), true, &addrByte, 1);
+}
+
+#endif // ARDUINO
@@ -1,11 +1,20 @@
 #include "RTClib.h"
 
+#ifdef ARDUINO // the I2C drivers are not built on a Linux host
+
 #define PCF8563_ADDRESS 0x51       ///< I2C address for PCF8563
 #define PCF8563_CLKOUTCONTROL 0x0D ///< CLKOUT control register
 #define PCF8563_CONTROL_1 0x00     ///< Control and status register 1
 #define PCF8563_CONTROL_2 0x01     ///< Control and status register 2
 #define PCF8563_VL_SECONDS 0x02    ///< register address for VL_SECONDS
+#define PCF8563_ALARM 0x09         ///< Alarm registers, first of 4
+#define PCF8563_TIMER_CONTROL 0x0E ///< Timer control register
+#define PCF8563_TIMER 0x0F         ///< Timer countdown value register
 #define PCF8563_CLKOUT_MASK 0x83   ///< bitmask for SqwPinMode on CLKOUT pin
+#define PCF8563_FLAGS 0x0C         ///< AF and TF bits of Control_2
+#define PCF8563_AIE 0x02           ///< Alarm interrupt enable bit of Control_2
+#define PCF8563_TIE 0x01           ///< Timer interrupt enable bit of Control_2
+#define PCF8563_TI_TP 0x10         ///< Timer pulse mode bit of Control_2
 
 /**************************************************************************/
 /*!
@@ -44,29 +53,57 @@ bool RTC_PCF8563::lostPower(void) {
     @param dt DateTime to set
 */
 /**************************************************************************/
-void RTC_PCF8563::adjust(const DateTime &dt) {
+void RTC_PCF8563::adjust(const DateTime &dt) { adjust(DateTime64(dt)); }
+
+/**************************************************************************/
+/*!
+    @brief  Set the date and time, over the chip's range of 2000 to 2199
+    @details The century bit, bit 7 of the months register, is set for the
+   22nd century. The chip takes 2100 as a leap year: a clock running
+   through 2100-02-28 reads one day ahead afterwards, until adjusted again.
+    @param dt DateTime64 to set. Dates outside 2000 to 2199 are ignored.
+*/
+/**************************************************************************/
+void RTC_PCF8563::adjust(const DateTime64 &dt) {
+  if (dt.year() < 2000 || dt.year() > 2199)
+    return;
+  uint8_t century = dt.year() >= 2100 ? 0x80 : 0;
   uint8_t buffer[8] = {PCF8563_VL_SECONDS, // start at location 2, VL_SECONDS
-                       bin2bcd(dt.second()), bin2bcd(dt.minute()),
-                       bin2bcd(dt.hour()),   bin2bcd(dt.day()),
-                       bin2bcd(0), // skip weekdays
-                       bin2bcd(dt.month()),  bin2bcd(dt.year() - 2000U)};
+                       bin2bcd(dt.second()),
+                       bin2bcd(dt.minute()),
+                       bin2bcd(dt.hour()),
+                       bin2bcd(dt.day()),
+                       dt.dayOfTheWeek(), // 0 (Sunday) to 6
+                       (uint8_t)(bin2bcd(dt.month()) | century),
+                       bin2bcd(dt.year() % 100)};
   i2c_dev->write(buffer, 8);
 }
 
 /**************************************************************************/
 /*!
     @brief  Get the current date/time
-    @return DateTime object containing the current date/time
+    @return DateTime object containing the current date/time, invalid past
+   2099
+*/
+/**************************************************************************/
+DateTime RTC_PCF8563::now() { return now64().toDateTime(); }
+
+/**************************************************************************/
+/*!
+    @brief  Get the current date/time, over the chip's range of 2000 to 2199
+    @return DateTime64 object containing the current date/time, with the
+   century taken from bit 7 of the months register
 */
 /**************************************************************************/
-DateTime RTC_PCF8563::now() {
+DateTime64 RTC_PCF8563::now64() {
   uint8_t buffer[7];
   buffer[0] = PCF8563_VL_SECONDS; // start at location 2, VL_SECONDS
   i2c_dev->write_then_read(buffer, 1, buffer, 7);
 
-  return DateTime(bcd2bin(buffer[6]) + 2000U, bcd2bin(buffer[5] & 0x1F),
-                  bcd2bin(buffer[3] & 0x3F), bcd2bin(buffer[2] & 0x3F),
-                  bcd2bin(buffer[1] & 0x7F), bcd2bin(buffer[0] & 0x7F));
+  uint16_t year = bcd2bin(buffer[6]) + (buffer[5] & 0x80 ? 2100U : 2000U);
+  return DateTime64(year, bcd2bin(buffer[5] & 0x1F), bcd2bin(buffer[3] & 0x3F),
+                    bcd2bin(buffer[2] & 0x3F), bcd2bin(buffer[1] & 0x7F),
+                    bcd2bin(buffer[0] & 0x7F));
 }
 
 /**************************************************************************/
@@ -121,3 +158,247 @@ Pcf8563SqwPinMode RTC_PCF8563::readSqwPinMode() {
 void RTC_PCF8563::writeSqwPinMode(Pcf8563SqwPinMode mode) {
   write_register(PCF8563_CLKOUTCONTROL, mode);
 }
+
+/**************************************************************************/
+/*!
+    @brief  Set the alarm and enable its interrupt on the INT pin
+    @details The alarm fires when all the selected fields match the current
+   time; the seconds are not compared, so it fires at the start of the
+   minute. The day of the week is taken from dt, as written by adjust().
+   The alarm flag is cleared, and stays set once the alarm fires until
+   cleared with clearAlarm() or readAndClearFlags().
+    @param dt DateTime object holding the minute, hour, day and day of the
+   week to match
+    @param mode Fields to match, an OR of #Pcf8563AlarmMode values
+    @return False if no field is selected, otherwise true
+*/
+/**************************************************************************/
+bool RTC_PCF8563::setAlarm(const DateTime &dt, uint8_t mode) {
+  if (!(mode & 0x0F))
+    return false;
+  // AE_x bit 7 set disables the field
+  uint8_t buffer[5] = {
+      PCF8563_ALARM,
+      (uint8_t)(bin2bcd(dt.minute()) | (mode & PCF8563_AlarmMinute ? 0 : 0x80)),
+      (uint8_t)(bin2bcd(dt.hour()) | (mode & PCF8563_AlarmHour ? 0 : 0x80)),
+      (uint8_t)(bin2bcd(dt.day()) | (mode & PCF8563_AlarmDay ? 0 : 0x80)),
+      (uint8_t)(dt.dayOfTheWeek() | (mode & PCF8563_AlarmWeekday ? 0 : 0x80))};
+  i2c_dev->write(buffer, 5);
+
+  // Set AIE and clear AF; writing 1 to TF leaves it unchanged
+  uint8_t ctlreg = read_register(PCF8563_CONTROL_2);
+  write_register(PCF8563_CONTROL_2,
+                 (ctlreg | PCF8563_TimerFlag | PCF8563_AIE) &
+                     ~PCF8563_AlarmFlag);
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the date/time value of the alarm
+    @return DateTime object with the alarm minute and hour set. The day is
+   the day of the month, or, if only the day of the week is matched, a day
+   of the first week of May 2000, where it equals the day of the week
+   (7 for Sunday).
+*/
+/**************************************************************************/
+DateTime RTC_PCF8563::getAlarm() {
+  uint8_t buffer[4] = {PCF8563_ALARM};
+  i2c_dev->write_then_read(buffer, 1, buffer, 4);
+
+  uint8_t day = bcd2bin(buffer[2] & 0x3F);
+  if ((buffer[2] & 0x80) && !(buffer[3] & 0x80)) {
+    day = buffer[3] & 0x07;
+    if (day == 0)
+      day = 7;
+  }
+  return DateTime(2000, 5, day, bcd2bin(buffer[1] & 0x3F),
+                  bcd2bin(buffer[0] & 0x7F), 0);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the fields matched by the alarm
+    @return An OR of #Pcf8563AlarmMode values, 0 if the alarm is disabled
+*/
+/**************************************************************************/
+uint8_t RTC_PCF8563::getAlarmMode() {
+  uint8_t buffer[4] = {PCF8563_ALARM};
+  i2c_dev->write_then_read(buffer, 1, buffer, 4);
+
+  uint8_t mode = 0;
+  for (uint8_t i = 0; i < 4; i++)
+    if (!(buffer[i] & 0x80))
+      mode |= 1 << i;
+  return mode;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Disable the alarm and its interrupt
+*/
+/**************************************************************************/
+void RTC_PCF8563::disableAlarm(void) {
+  uint8_t ctlreg = read_register(PCF8563_CONTROL_2);
+  write_register(PCF8563_CONTROL_2, (ctlreg | PCF8563_FLAGS) & ~PCF8563_AIE);
+
+  uint8_t buffer[5] = {PCF8563_ALARM, 0x80, 0x80, 0x80, 0x80};
+  i2c_dev->write(buffer, 5);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clear the alarm flag (AF), releasing the INT pin
+*/
+/**************************************************************************/
+void RTC_PCF8563::clearAlarm(void) {
+  uint8_t ctlreg = read_register(PCF8563_CONTROL_2);
+  write_register(PCF8563_CONTROL_2,
+                 (ctlreg | PCF8563_FLAGS) & ~PCF8563_AlarmFlag);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the status of the alarm flag (AF)
+    @return True if the alarm has fired since it was last cleared
+*/
+/**************************************************************************/
+bool RTC_PCF8563::alarmFired(void) {
+  return read_register(PCF8563_CONTROL_2) & PCF8563_AlarmFlag;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Enable the countdown timer and its interrupt on the INT pin
+    @details The timer counts numPeriods periods of clkFreq down to zero,
+   then sets the timer flag (TF), reloads and starts again.
+    @param clkFreq One of the PCF8563's Timer Source Clock Frequencies.
+   See the #Pcf8563TimerClockFreq enum for options and associated time ranges.
+    @param numPeriods The number of clkFreq periods (1-255) to count down.
+    @param pulse If true, INT pulses at each period end regardless of TF.
+   Otherwise, INT stays asserted as long as TF is set.
+*/
+/**************************************************************************/
+void RTC_PCF8563::enableCountdownTimer(Pcf8563TimerClockFreq clkFreq,
+                                       uint8_t numPeriods, bool pulse) {
+  // Stop the timer while loading its value, then start it (TE)
+  uint8_t buffer[3] = {PCF8563_TIMER_CONTROL, clkFreq, numPeriods};
+  i2c_dev->write(buffer, 3);
+  write_register(PCF8563_TIMER_CONTROL, 0x80 | clkFreq);
+
+  // Set TIE and TI_TP, clear TF; writing 1 to AF leaves it unchanged
+  uint8_t ctlreg = read_register(PCF8563_CONTROL_2);
+  ctlreg = (ctlreg | PCF8563_AlarmFlag | PCF8563_TIE) & ~PCF8563_TimerFlag;
+  if (pulse)
+    ctlreg |= PCF8563_TI_TP;
+  else
+    ctlreg &= ~PCF8563_TI_TP;
+  write_register(PCF8563_CONTROL_2, ctlreg);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Disable the countdown timer and its interrupt
+*/
+/**************************************************************************/
+void RTC_PCF8563::disableCountdownTimer(void) {
+  // The 1/60 Hz source clock draws the least current
+  write_register(PCF8563_TIMER_CONTROL, PCF8563_FrequencyMinute);
+
+  uint8_t ctlreg = read_register(PCF8563_CONTROL_2);
+  write_register(PCF8563_CONTROL_2, (ctlreg | PCF8563_FLAGS) &
+                                        ~(PCF8563_TIE | PCF8563_TI_TP));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the current value of the countdown timer
+    @return Number of source clock periods left before the timer fires
+*/
+/**************************************************************************/
+uint8_t RTC_PCF8563::readCountdownTimer(void) {
+  return read_register(PCF8563_TIMER);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Clear the timer flag (TF), releasing the INT pin
+*/
+/**************************************************************************/
+void RTC_PCF8563::clearCountdownTimer(void) {
+  uint8_t ctlreg = read_register(PCF8563_CONTROL_2);
+  write_register(PCF8563_CONTROL_2,
+                 (ctlreg | PCF8563_FLAGS) & ~PCF8563_TimerFlag);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the status of the timer flag (TF)
+    @return True if the countdown timer has fired since it was last cleared
+*/
+/**************************************************************************/
+bool RTC_PCF8563::countdownFired(void) {
+  return read_register(PCF8563_CONTROL_2) & PCF8563_TimerFlag;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Read the alarm and timer flags and clear those that are set
+    @details The flags are read in a single transfer, and only written back
+   when one of them is set. The write puts 0 only in the flags that were
+   read as set: since writing 1 leaves a flag unchanged, an event occurring
+   between the read and the write is not lost, and is reported by the next
+   call.
+    @return An OR of the #Pcf8563Flag values that were set
+*/
+/**************************************************************************/
+uint8_t RTC_PCF8563::readAndClearFlags(void) {
+  uint8_t ctlreg;
+  read_registers(PCF8563_CONTROL_2, &ctlreg, 1); // one write_then_read
+  uint8_t flags = ctlreg & PCF8563_FLAGS;
+  if (flags)
+    write_register(PCF8563_CONTROL_2, (ctlreg | PCF8563_FLAGS) & ~flags);
+  return flags;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Save the configuration of the PCF8563 in a single transfer
+    @return Pcf8563Snapshot holding the control, alarm, CLKOUT and timer
+   registers
+*/
+/**************************************************************************/
+Pcf8563Snapshot RTC_PCF8563::snapshot() {
+  // Registers 0x00 to 0x0F, time registers included
+  uint8_t buffer[PCF8563_TIMER + 1] = {PCF8563_CONTROL_1};
+  i2c_dev->write_then_read(buffer, 1, buffer, sizeof(buffer));
+
+  Pcf8563Snapshot snap;
+  memcpy(snap.control, buffer, sizeof(snap.control));
+  memcpy(snap.registers, buffer + PCF8563_ALARM, sizeof(snap.registers));
+  return snap;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restore a configuration saved with snapshot()
+    @details This takes two transfers, one for the control registers and one
+   for the alarm to timer registers, leaving the time registers in between
+   untouched. The alarm and timer flags are left untouched as well: they
+   reflect events, not configuration.
+    @param snap Pcf8563Snapshot to restore
+*/
+/**************************************************************************/
+void RTC_PCF8563::restore(const Pcf8563Snapshot &snap) {
+  uint8_t control[sizeof(snap.control)];
+  memcpy(control, snap.control, sizeof(control));
+  // Writing 1 to AF and TF leaves them unchanged
+  control[PCF8563_CONTROL_2] |= 0x0C;
+  uint8_t addrByte = PCF8563_CONTROL_1;
+  i2c_dev->write(control, sizeof(control), true, &addrByte, 1);
+
+  addrByte = PCF8563_ALARM;
+  i2c_dev->write(snap.registers, sizeof(snap.registers), true, &addrByte, 1);
+}
+
+#endif // ARDUINO
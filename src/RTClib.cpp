@@ -23,7 +23,19 @@
   - Classes for manipulating dates, times and durations:
         - DateTime represents a specific point in time; this is the data
           type used for setting and reading the supported RTCs
+        - DateTime64 extends DateTime to years 1--9999, with a signed 64-bit
+          Unix time
         - TimeSpan represents the length of a time interval
+        - MonotonicTime represents a reading of a monotonic clock, which is
+          not affected by adjustments of the date and time
+        - PreciseDateTime and PreciseTimeSpan add a microsecond field to
+          DateTime and TimeSpan
+        - DateTimeFormat renders many timestamps at once with a pre-compiled
+          format
+        - TimeZone converts between UTC and local time, following the DST
+          rules of a POSIX TZ string
+        - CompiledTimeZone does the same from a TzTable of transitions
+          compiled from tzdata by `extras/tzcompile.py`
   - Interfacing specific RTC chips:
         - RTC_DS1307
         - RTC_DS3231
@@ -33,6 +45,31 @@
         - RTC_Millis is based on `millis()`
         - RTC_Micros is based on `micros()`; its drift rate can be tuned by
           the user
+  - RTC_Monotonic adds a monotonic timescale to any of the above
+  - RTC_NvramCentury extends a DS1307 to years 1--9999 by keeping the
+    century in its NVRAM; the DS3231, DS3232 and PCF8563 cover 2000--2199
+    through `now64()` with their own century bit
+  - Scheduling:
+        - AlarmQueue keeps any number of software alarms ordered by time
+        - RTC_AlarmScheduler multiplexes them over alarm 1 of a DS3231 or
+          DS3232
+        - Pcf8523Countdown plans a countdown of any length over Timer A and
+          Timer B of a PCF8523
+  - Storage:
+        - RTC_NvramCache mirrors the NVRAM of a DS1307 or DS3232 in RAM and
+          writes the changed bytes back in a few burst transfers
+        - RTC_NvramStore keeps small values in the same NVRAM as a journaled
+          key/value store that survives a reset in the middle of a write
+        - RTC_NvramLog logs timestamped samples there as a ring buffer, with
+          delta-of-delta compressed timestamps
+
+  @section host Linux host builds
+
+  The date/time classes and the software RTCs can also be compiled on a
+  Linux host, without the Arduino core, by compiling every source file; the
+  RTC_<chip>.cpp drivers then compile to nothing. RTC_Millis and RTC_Micros
+  are backed by `clock_gettime()`, see RTC_Host.cpp. The checks and
+  benchmarks in `extras` are built this way, see `extras/run_checks.sh`.
 
   @section license License
 
@@ -45,17 +82,11 @@
 
 #include "RTClib.h"
 
-#ifdef __AVR__
-#include <avr/pgmspace.h>
-#elif defined(ESP8266)
-#include <pgmspace.h>
-#elif defined(ARDUINO_ARCH_SAMD)
-// nothing special needed
-#elif defined(ARDUINO_SAM_DUE)
-#define PROGMEM
-#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#ifndef ARDUINO
+#include <stdio.h>
 #endif
 
+#ifdef ARDUINO
 /**************************************************************************/
 /*!
         @brief Write value to register.
@@ -82,17 +113,110 @@ uint8_t RTC_I2C::read_register(uint8_t reg) {
   return buffer[0];
 }
 
+/**************************************************************************/
+/*!
+        @brief Read consecutive registers, in as few transfers as the I2C
+   buffer allows.
+        @details Each transfer re-sends the register address, so the result
+   does not depend on the bus library splitting long reads.
+        @param reg address of the first register
+        @param buf buffer receiving the values
+        @param size number of registers to read
+        @return number of registers actually read
+*/
+/**************************************************************************/
+size_t RTC_I2C::read_registers(uint8_t reg, uint8_t *buf, size_t size) {
+  size_t chunk = i2c_dev->maxBufferSize();
+  size_t done = 0;
+  while (done < size) {
+    size_t len = size - done < chunk ? size - done : chunk;
+    uint8_t addrByte = reg + done;
+    if (!i2c_dev->write_then_read(&addrByte, 1, buf + done, len))
+      break;
+    done += len;
+  }
+  return done;
+}
+
+/**************************************************************************/
+/*!
+        @brief Write consecutive registers, in as few transfers as the I2C
+   buffer allows.
+        @details Each transfer carries the register address followed by as
+   many values as fit in the I2C buffer.
+        @param reg address of the first register
+        @param buf buffer holding the values
+        @param size number of registers to write
+        @return number of registers actually written
+*/
+/**************************************************************************/
+size_t RTC_I2C::write_registers(uint8_t reg, const uint8_t *buf,
+                                size_t size) {
+  size_t chunk = i2c_dev->maxBufferSize() - 1; // room for the address
+  size_t done = 0;
+  while (done < size) {
+    size_t len = size - done < chunk ? size - done : chunk;
+    uint8_t addrByte = reg + done;
+    if (!i2c_dev->write(buf + done, len, true, &addrByte, 1))
+      break;
+    done += len;
+  }
+  return done;
+}
+#endif
+
 /**************************************************************************/
 // utility code, some of this could be exposed in the DateTime API if needed
 /**************************************************************************/
 
-/**
-  Number of days in each month, from January to November. December is not
-  needed. Omitting it avoids an incompatibility with Paul Stoffregen's Time
-  library. C.f. https://github.com/adafruit/RTClib/issues/114
+/*
+  The conversions between day numbers and dates below count years from
+  March 1st, so that the leap day ends the year, and the month lengths from
+  March repeat the pattern 31-30-31-30-31 every five months. This makes them
+  plain arithmetic, without branches or table lookups, which lets compilers
+  vectorise the batch conversions. Counting from 1996-03-01 keeps all
+  intermediate values unsigned.
 */
-const uint8_t daysInMonth[] PROGMEM = {31, 28, 31, 30, 31, 30,
-                                       31, 31, 30, 31, 30};
+
+/**************************************************************************/
+/*!
+        @brief  Given a date, return number of days since 2000/01/01,
+                valid for 2000--2099
+        @param yOff Year offset from 2000
+        @param m Month
+        @param d Day
+        @return Number of days
+*/
+/**************************************************************************/
+static inline uint32_t civil2days(uint8_t yOff, uint8_t m, uint8_t d) {
+  uint32_t early = m <= 2; // January and February end the March-based year
+  uint32_t yoe = yOff + 4 - early;
+  uint32_t mp = m + 9 - 12 * (1 - early);
+  uint32_t doy = (153 * mp + 2) / 5 + d - 1;
+  return 365 * yoe + yoe / 4 + doy - 1401;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Given a number of days since 2000/01/01, return the date,
+                valid for 2000--2099
+        @param days Number of days
+        @param[out] yOff Year offset from 2000
+        @param[out] m Month
+        @param[out] d Day
+*/
+/**************************************************************************/
+static inline void days2civil(uint32_t days, uint8_t &yOff, uint8_t &m,
+                              uint8_t &d) {
+  uint32_t z = days + 1401; // days since 1996-03-01
+  uint32_t yoe = (4 * z + 3) / 1461;
+  uint32_t doy = z - 365 * yoe - yoe / 4;
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t early = mp >= 10;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp + 3 - 12 * early;
+  yOff = yoe - 4 + early;
+}
 
 /**************************************************************************/
 /*!
@@ -107,12 +231,7 @@ const uint8_t daysInMonth[] PROGMEM = {31, 28, 31, 30, 31, 30,
 static uint16_t date2days(uint16_t y, uint8_t m, uint8_t d) {
   if (y >= 2000U)
     y -= 2000U;
-  uint16_t days = d;
-  for (uint8_t i = 1; i < m; ++i)
-    days += pgm_read_byte(daysInMonth + i - 1);
-  if (m > 2 && y % 4 == 0)
-    ++days;
-  return days + 365 * y + (y + 3) / 4 - 1;
+  return civil2days(y, m, d);
 }
 
 /**************************************************************************/
@@ -159,30 +278,22 @@ static uint32_t time2ulong(uint16_t days, uint8_t h, uint8_t m, uint8_t s) {
 */
 /**************************************************************************/
 DateTime::DateTime(uint32_t t) {
-  t -= SECONDS_FROM_1970_TO_2000; // bring to 2000 timestamp from 1970
+  setSecondstime(t - SECONDS_FROM_1970_TO_2000);
+}
 
+/**************************************************************************/
+/*!
+        @brief  Set the date and time from seconds since 1 Jan 2000
+        @param t Time elapsed in seconds since 2000-01-01 00:00:00.
+*/
+/**************************************************************************/
+void DateTime::setSecondstime(uint32_t t) {
   ss = t % 60;
   t /= 60;
   mm = t % 60;
   t /= 60;
   hh = t % 24;
-  uint16_t days = t / 24;
-  uint8_t leap;
-  for (yOff = 0;; ++yOff) {
-    leap = yOff % 4 == 0;
-    if (days < 365U + leap)
-      break;
-    days -= 365 + leap;
-  }
-  for (m = 1; m < 12; ++m) {
-    uint8_t daysPerMonth = pgm_read_byte(daysInMonth + m - 1);
-    if (leap && m == 2)
-      ++daysPerMonth;
-    if (days < daysPerMonth)
-      break;
-    days -= daysPerMonth;
-  }
-  d = days + 1;
+  days2civil(t / 24, yOff, m, d);
 }
 
 /**************************************************************************/
@@ -236,6 +347,37 @@ static uint8_t conv2d(const char *p) {
   return 10 * v + *++p - '0';
 }
 
+/**************************************************************************/
+/*!
+        @brief  Convert an abbreviated English month name, e.g. "Apr", to
+   the month number
+        @param p Pointer to the month name, as in `__DATE__`
+        @return Month number (1--12), or 0 if not recognised
+*/
+/**************************************************************************/
+static uint8_t conv2month(const char *p) {
+  // Jan Feb Mar Apr May Jun Jul Aug Sep Oct Nov Dec
+  switch (p[0]) {
+  case 'J':
+    return (p[1] == 'a') ? 1 : ((p[2] == 'n') ? 6 : 7);
+  case 'F':
+    return 2;
+  case 'A':
+    return p[2] == 'r' ? 4 : 8;
+  case 'M':
+    return p[2] == 'r' ? 3 : 5;
+  case 'S':
+    return 9;
+  case 'O':
+    return 10;
+  case 'N':
+    return 11;
+  case 'D':
+    return 12;
+  }
+  return 0;
+}
+
 /**************************************************************************/
 /*!
         @brief  Constructor for generating the build time.
@@ -257,39 +399,14 @@ static uint8_t conv2d(const char *p) {
 /**************************************************************************/
 DateTime::DateTime(const char *date, const char *time) {
   yOff = conv2d(date + 9);
-  // Jan Feb Mar Apr May Jun Jul Aug Sep Oct Nov Dec
-  switch (date[0]) {
-  case 'J':
-    m = (date[1] == 'a') ? 1 : ((date[2] == 'n') ? 6 : 7);
-    break;
-  case 'F':
-    m = 2;
-    break;
-  case 'A':
-    m = date[2] == 'r' ? 4 : 8;
-    break;
-  case 'M':
-    m = date[2] == 'r' ? 3 : 5;
-    break;
-  case 'S':
-    m = 9;
-    break;
-  case 'O':
-    m = 10;
-    break;
-  case 'N':
-    m = 11;
-    break;
-  case 'D':
-    m = 12;
-    break;
-  }
+  m = conv2month(date);
   d = conv2d(date + 4);
   hh = conv2d(time);
   mm = conv2d(time + 3);
   ss = conv2d(time + 6);
 }
 
+#ifdef ARDUINO
 /**************************************************************************/
 /*!
         @brief  Memory friendly constructor for generating the build time.
@@ -310,39 +427,14 @@ DateTime::DateTime(const __FlashStringHelper *date,
   char buff[11];
   memcpy_P(buff, date, 11);
   yOff = conv2d(buff + 9);
-  // Jan Feb Mar Apr May Jun Jul Aug Sep Oct Nov Dec
-  switch (buff[0]) {
-  case 'J':
-    m = (buff[1] == 'a') ? 1 : ((buff[2] == 'n') ? 6 : 7);
-    break;
-  case 'F':
-    m = 2;
-    break;
-  case 'A':
-    m = buff[2] == 'r' ? 4 : 8;
-    break;
-  case 'M':
-    m = buff[2] == 'r' ? 3 : 5;
-    break;
-  case 'S':
-    m = 9;
-    break;
-  case 'O':
-    m = 10;
-    break;
-  case 'N':
-    m = 11;
-    break;
-  case 'D':
-    m = 12;
-    break;
-  }
+  m = conv2month(buff);
   d = conv2d(buff + 4);
   memcpy_P(buff, time, 8);
   hh = conv2d(buff);
   mm = conv2d(buff + 3);
   ss = conv2d(buff + 6);
 }
+#endif
 
 /**************************************************************************/
 /*!
@@ -369,7 +461,8 @@ DateTime::DateTime(const __FlashStringHelper *date,
 /**************************************************************************/
 DateTime::DateTime(const char *iso8601dateTime) {
   char ref[] = "2000-01-01T00:00:00";
-  memcpy(ref, iso8601dateTime, min(strlen(ref), strlen(iso8601dateTime)));
+  size_t len = strlen(iso8601dateTime);
+  memcpy(ref, iso8601dateTime, len < sizeof(ref) - 1 ? len : sizeof(ref) - 1);
   yOff = conv2d(ref + 2);
   m = conv2d(ref + 5);
   d = conv2d(ref + 8);
@@ -595,6 +688,395 @@ uint32_t DateTime::secondstime(void) const {
   return t;
 }
 
+/**************************************************************************/
+/*!
+        @brief  Convert a binary number from 0 to 99 to BCD
+        @param val Binary number
+        @return BCD number
+*/
+/**************************************************************************/
+static uint8_t dec2bcd(uint8_t val) { return val + 6 * (val / 10); }
+
+/**************************************************************************/
+/*!
+        @brief  Convert a BCD number to binary
+        @param val BCD number
+        @return Binary number
+*/
+/**************************************************************************/
+static uint8_t bcd2dec(uint8_t val) { return val - 6 * (val >> 4); }
+
+/**************************************************************************/
+/*!
+        @brief  Store a 32-bit number as little-endian bytes
+        @param buf Buffer receiving 4 bytes
+        @param val Number to store
+*/
+/**************************************************************************/
+static void put32(uint8_t *buf, uint32_t val) {
+  buf[0] = val;
+  buf[1] = val >> 8;
+  buf[2] = val >> 16;
+  buf[3] = val >> 24;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Load a 32-bit number from little-endian bytes
+        @param buf Buffer holding 4 bytes
+        @return The number
+*/
+/**************************************************************************/
+static uint32_t get32(const uint8_t *buf) {
+  return buf[0] | (uint32_t)buf[1] << 8 | (uint32_t)buf[2] << 16 |
+         (uint32_t)buf[3] << 24;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode the DateTime in 4 bytes, as the little-endian
+                secondstime().
+
+        This covers the whole range of the class, at one second resolution.
+
+        @param buf Buffer receiving 4 bytes
+*/
+/**************************************************************************/
+void DateTime::encode32(uint8_t *buf) const { put32(buf, secondstime()); }
+
+/**************************************************************************/
+/*!
+        @brief  Encode the DateTime in 5 bytes, with a sub-second part.
+
+        The first 4 bytes are as in encode32(); the last one holds the
+        fraction of the second, in units of 1/256 s.
+
+        @param buf Buffer receiving 5 bytes
+        @param fraction Fraction of the second, in units of 1/256 s
+*/
+/**************************************************************************/
+void DateTime::encode40(uint8_t *buf, uint8_t fraction) const {
+  put32(buf, secondstime());
+  buf[4] = fraction;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode the DateTime as a packed FAT date and time.
+
+        This is the layout used by FAT file systems, and returned by the
+        `get_fattime()` callback of FatFs:
+
+        | Bits  | Content               |
+        |-------|-----------------------|
+        | 31-25 | Year - 1980           |
+        | 24-21 | Month (1--12)         |
+        | 20-16 | Day (1--31)           |
+        | 15-11 | Hour (0--23)          |
+        | 10-5  | Minute (0--59)        |
+        | 4-0   | Second / 2 (0--29)    |
+
+        @return Packed date and time. Odd seconds are rounded down.
+*/
+/**************************************************************************/
+uint32_t DateTime::encodeFat() const {
+  return (uint32_t)(yOff + 20) << 25 | (uint32_t)m << 21 |
+         (uint32_t)d << 16 | (uint16_t)hh << 11 | (uint16_t)mm << 5 | ss >> 1;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode the DateTime as the BCD time registers of a DS1307,
+                DS3231 or DS3232.
+
+        The 7 bytes hold the second, minute, hour (24-hour mode), day of the
+        week (1 = Monday to 7 = Sunday), day, month and year - 2000, in BCD.
+
+        @param buf Buffer receiving 7 bytes
+*/
+/**************************************************************************/
+void DateTime::encodeBCD(uint8_t *buf) const {
+  buf[0] = dec2bcd(ss);
+  buf[1] = dec2bcd(mm);
+  buf[2] = dec2bcd(hh);
+  buf[3] = (dayOfTheWeek() + 6) % 7 + 1;
+  buf[4] = dec2bcd(d);
+  buf[5] = dec2bcd(m);
+  buf[6] = dec2bcd(yOff);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Set the date and time from a packed FAT date and time
+        @param fat Packed date and time, as returned by encodeFat()
+*/
+/**************************************************************************/
+void DateTime::setFat(uint32_t fat) {
+  yOff = (fat >> 25) - 20;
+  m = (fat >> 21) & 0x0F;
+  d = (fat >> 16) & 0x1F;
+  hh = (fat >> 11) & 0x1F;
+  mm = (fat >> 5) & 0x3F;
+  ss = (fat & 0x1F) << 1;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Set the date and time from BCD time registers
+        @details The Clock Halt bit, the 12-hour mode and the century bit
+        are ignored.
+        @param buf Buffer holding 7 bytes, as written by encodeBCD()
+*/
+/**************************************************************************/
+void DateTime::setBCD(const uint8_t *buf) {
+  ss = bcd2dec(buf[0] & 0x7F);
+  mm = bcd2dec(buf[1] & 0x7F);
+  hh = bcd2dec(buf[2] & 0x3F);
+  d = bcd2dec(buf[4] & 0x3F);
+  m = bcd2dec(buf[5] & 0x1F);
+  yOff = bcd2dec(buf[6]);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode a DateTime encoded by encode32()
+        @param buf Buffer holding 4 bytes
+        @return DateTime object
+*/
+/**************************************************************************/
+DateTime DateTime::decode32(const uint8_t *buf) {
+  DateTime dt;
+  dt.setSecondstime(get32(buf));
+  return dt;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode a DateTime encoded by encode40()
+        @param buf Buffer holding 5 bytes
+        @param[out] fraction Fraction of the second, in units of 1/256 s,
+          or NULL to ignore it
+        @return DateTime object
+*/
+/**************************************************************************/
+DateTime DateTime::decode40(const uint8_t *buf, uint8_t *fraction) {
+  DateTime dt;
+  dt.setSecondstime(get32(buf));
+  if (fraction)
+    *fraction = buf[4];
+  return dt;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode a DateTime encoded by encodeFat()
+        @warning The result is invalid if the year is before 2000 or after
+        2099.
+        @param fat Packed date and time
+        @return DateTime object
+*/
+/**************************************************************************/
+DateTime DateTime::decodeFat(uint32_t fat) {
+  DateTime dt;
+  dt.setFat(fat);
+  return dt;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode a DateTime from BCD time registers
+        @param buf Buffer holding 7 bytes
+        @return DateTime object
+*/
+/**************************************************************************/
+DateTime DateTime::decodeBCD(const uint8_t *buf) {
+  DateTime dt;
+  dt.setBCD(buf);
+  return dt;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode an array of DateTime objects with encode32()
+        @param times DateTime objects to encode
+        @param buf Buffer receiving 4 * count bytes
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::encode32(const DateTime *times, uint8_t *buf,
+                        uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, buf += 4)
+    put32(buf, times[i].secondstime());
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode an array of DateTime objects encoded by encode32()
+        @param buf Buffer holding 4 * count bytes
+        @param times DateTime objects receiving the result
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::decode32(const uint8_t *buf, DateTime *times,
+                        uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, buf += 4)
+    times[i].setSecondstime(get32(buf));
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode an array of DateTime objects with encode40()
+        @param times DateTime objects to encode
+        @param fractions Fractions of the seconds, or NULL for zeros
+        @param buf Buffer receiving 5 * count bytes
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::encode40(const DateTime *times, const uint8_t *fractions,
+                        uint8_t *buf, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, buf += 5)
+    times[i].encode40(buf, fractions ? fractions[i] : 0);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode an array of DateTime objects encoded by encode40()
+        @param buf Buffer holding 5 * count bytes
+        @param times DateTime objects receiving the result
+        @param[out] fractions Fractions of the seconds, or NULL to ignore
+          them
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::decode40(const uint8_t *buf, DateTime *times,
+                        uint8_t *fractions, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, buf += 5) {
+    times[i].setSecondstime(get32(buf));
+    if (fractions)
+      fractions[i] = buf[4];
+  }
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode an array of DateTime objects with encodeFat()
+        @param times DateTime objects to encode
+        @param[out] fat Packed dates and times
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::encodeFat(const DateTime *times, uint32_t *fat,
+                         uint16_t count) {
+  for (uint16_t i = 0; i < count; i++)
+    fat[i] = times[i].encodeFat();
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode an array of DateTime objects encoded by encodeFat()
+        @param fat Packed dates and times
+        @param times DateTime objects receiving the result
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::decodeFat(const uint32_t *fat, DateTime *times,
+                         uint16_t count) {
+  for (uint16_t i = 0; i < count; i++)
+    times[i].setFat(fat[i]);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Encode an array of DateTime objects with encodeBCD()
+        @param times DateTime objects to encode
+        @param buf Buffer receiving 7 * count bytes
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::encodeBCD(const DateTime *times, uint8_t *buf,
+                         uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, buf += 7)
+    times[i].encodeBCD(buf);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Decode an array of DateTime objects from BCD time registers
+        @param buf Buffer holding 7 * count bytes
+        @param times DateTime objects receiving the result
+        @param count Number of objects
+*/
+/**************************************************************************/
+void DateTime::decodeBCD(const uint8_t *buf, DateTime *times,
+                         uint16_t count) {
+  for (uint16_t i = 0; i < count; i++, buf += 7)
+    times[i].setBCD(buf);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Convert an array of Unix times to calendar fields.
+
+        This is equivalent to calling the `DateTime(uint32_t)` constructor on
+        each element, but the loop has no branches, so that it can be
+        vectorised.
+
+        @param times Unix times, from 2000 to 2099
+        @param fields Arrays receiving the calendar fields. If
+          `fields.dayOfWeek` is NULL, the days of the week are not computed.
+        @param count Number of times
+*/
+/**************************************************************************/
+void DateTime::toFields(const uint32_t *times, const DateTimeFields &fields,
+                        size_t count) {
+  // local copies, as the byte stores could otherwise alias the pointers
+  uint16_t *year = fields.year;
+  uint8_t *month = fields.month, *day = fields.day, *hour = fields.hour;
+  uint8_t *minute = fields.minute, *second = fields.second;
+  uint8_t *dayOfWeek = fields.dayOfWeek;
+  // separate passes keep the number of arrays per loop low enough for the
+  // compiler to check them for overlap
+  for (size_t i = 0; i < count; i++) {
+    uint8_t yOff, m, d;
+    days2civil((times[i] - SECONDS_FROM_1970_TO_2000) / 86400, yOff, m, d);
+    year[i] = 2000U + yOff;
+    month[i] = m;
+    day[i] = d;
+  }
+  for (size_t i = 0; i < count; i++) {
+    uint32_t s = (times[i] - SECONDS_FROM_1970_TO_2000) % 86400;
+    hour[i] = s / 3600;
+    minute[i] = s / 60 % 60;
+    second[i] = s % 60;
+  }
+  if (dayOfWeek)
+    for (size_t i = 0; i < count; i++)
+      dayOfWeek[i] = ((times[i] - SECONDS_FROM_1970_TO_2000) / 86400 + 6) % 7;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Convert arrays of calendar fields to Unix times.
+
+        This is equivalent to calling `unixtime()` on each date; the loop has
+        no branches, so that it can be vectorised.
+
+        @param fields Calendar fields. `fields.dayOfWeek` is ignored.
+        @param times Array receiving the Unix times
+        @param count Number of dates
+*/
+/**************************************************************************/
+void DateTime::fromFields(const DateTimeFields &fields, uint32_t *times,
+                          size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    uint32_t days =
+        civil2days(fields.year[i] - 2000U, fields.month[i], fields.day[i]);
+    times[i] = SECONDS_FROM_1970_TO_2000 + days * 86400 +
+               fields.hour[i] * 3600UL + fields.minute[i] * 60U +
+               fields.second[i];
+  }
+}
+
 /**************************************************************************/
 /*!
         @brief  Add a TimeSpan to the DateTime object
@@ -675,6 +1157,7 @@ bool DateTime::operator==(const DateTime &right) const {
           right.second() == ss);
 }
 
+#ifdef ARDUINO
 /**************************************************************************/
 /*!
         @brief  Return a ISO 8601 timestamp as a `String` object.
@@ -710,6 +1193,7 @@ String DateTime::timestamp(timestampOpt opt) const {
   }
   return String(buffer);
 }
+#endif
 
 /**************************************************************************/
 /*!
@@ -763,3 +1247,422 @@ TimeSpan TimeSpan::operator+(const TimeSpan &right) const {
 TimeSpan TimeSpan::operator-(const TimeSpan &right) const {
   return TimeSpan(_seconds - right._seconds);
 }
+
+/*
+  DateTime64 counts days from 0000-03-01 of the proleptic Gregorian
+  calendar, the start of a 400-year cycle, so that day numbers stay
+  unsigned over years 1--9999. The date conversions are those of
+  civil2days() and days2civil(), extended with the century rules.
+*/
+#define DAYS_FROM_0000_TO_1970 719468UL   ///< 0000-03-01 to 1970-01-01
+#define DAYS_FROM_0000_TO_0001 306UL      ///< 0000-03-01 to 0001-01-01
+#define DAYS_FROM_0000_TO_10000 3652365UL ///< 0000-03-01 to 10000-01-01
+
+/**************************************************************************/
+/*!
+        @brief  Constructor from a signed 64-bit Unix time.
+
+        Times before 1970-01-01 00:00:00 are negative. The seconds are split
+        into days with a shift and a 32-bit division, as 86400 = 128 * 675,
+        which avoids a 64-bit division on 8-bit targets.
+
+        @param t Time elapsed in seconds since 1970-01-01 00:00:00. Times
+        outside years 1--9999 give an invalid DateTime64.
+*/
+/**************************************************************************/
+DateTime64::DateTime64(int64_t t) {
+  int64_t u = t + (int64_t)DAYS_FROM_0000_TO_1970 * SECONDS_PER_DAY;
+  if (u < (int64_t)DAYS_FROM_0000_TO_0001 * SECONDS_PER_DAY ||
+      u >= (int64_t)DAYS_FROM_0000_TO_10000 * SECONDS_PER_DAY) {
+    y = 0;
+    m = d = hh = mm = ss = 0;
+    return;
+  }
+  uint32_t z = (uint32_t)((uint64_t)u >> 7) / 675;
+  uint32_t s = (uint32_t)u - z * 86400UL; // wraps back below 86400
+  ss = s % 60;
+  s /= 60;
+  mm = s % 60;
+  hh = s / 60;
+  uint32_t era = z / 146097;
+  uint32_t doe = z - era * 146097;
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t early = mp >= 10; // January and February end the March-based year
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp + 3 - 12 * early;
+  y = 400 * era + yoe + early;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Constructor from (year, month, day, hour, minute, second).
+        @warning If the provided parameters are not valid (e.g. 31 February),
+                   the constructed DateTime64 will be invalid.
+        @param year Full year (1--9999).
+        @param month Month number (1--12).
+        @param day Day of the month (1--31).
+        @param hour,min,sec Hour (0--23), minute (0--59) and second (0--59).
+*/
+/**************************************************************************/
+DateTime64::DateTime64(uint16_t year, uint8_t month, uint8_t day, uint8_t hour,
+                       uint8_t min, uint8_t sec)
+    : y(year), m(month), d(day), hh(hour), mm(min), ss(sec) {}
+
+/**************************************************************************/
+/*!
+        @brief  Constructor from a DateTime.
+        @param dt DateTime to extend, kept unchanged.
+*/
+/**************************************************************************/
+DateTime64::DateTime64(const DateTime &dt)
+    : y(dt.year()), m(dt.month()), d(dt.day()), hh(dt.hour()),
+      mm(dt.minute()), ss(dt.second()) {}
+
+/**************************************************************************/
+/*!
+        @brief  Constructor for generating the build time.
+
+        Unlike the DateTime version, this reads all four digits of the
+        year. Usage:
+
+        ```
+        DateTime64 buildTime(__DATE__, __TIME__);
+        ```
+
+        @param date Date string, e.g. "Apr 16 2020".
+        @param time Time string, e.g. "18:34:56".
+*/
+/**************************************************************************/
+DateTime64::DateTime64(const char *date, const char *time) {
+  y = 100 * conv2d(date + 7) + conv2d(date + 9);
+  m = conv2month(date);
+  d = conv2d(date + 4);
+  hh = conv2d(time);
+  mm = conv2d(time + 3);
+  ss = conv2d(time + 6);
+}
+
+#ifdef ARDUINO
+/**************************************************************************/
+/*!
+        @brief  Memory friendly constructor for generating the build time.
+
+        Use it with the `F()` macro:
+
+        ```
+        DateTime64 buildTime(F(__DATE__), F(__TIME__));
+        ```
+
+        @param date Date PROGMEM string, e.g. F("Apr 16 2020").
+        @param time Time PROGMEM string, e.g. F("18:34:56").
+*/
+/**************************************************************************/
+DateTime64::DateTime64(const __FlashStringHelper *date,
+                       const __FlashStringHelper *time) {
+  char buff[11];
+  memcpy_P(buff, date, 11);
+  y = 100 * conv2d(buff + 7) + conv2d(buff + 9);
+  m = conv2month(buff);
+  d = conv2d(buff + 4);
+  memcpy_P(buff, time, 8);
+  hh = conv2d(buff);
+  mm = conv2d(buff + 3);
+  ss = conv2d(buff + 6);
+}
+#endif
+
+/**************************************************************************/
+/*!
+        @brief  Constructor from an ISO 8601 date string.
+        @param iso8601dateTime A dateTime string in ISO 8601 format with a
+        four-digit year, e.g. "1969-07-20T20:17:40".
+*/
+/**************************************************************************/
+DateTime64::DateTime64(const char *iso8601dateTime) {
+  char ref[] = "2000-01-01T00:00:00";
+  size_t len = strlen(iso8601dateTime);
+  memcpy(ref, iso8601dateTime, len < sizeof(ref) - 1 ? len : sizeof(ref) - 1);
+  y = 100 * conv2d(ref) + conv2d(ref + 2);
+  m = conv2d(ref + 5);
+  d = conv2d(ref + 8);
+  hh = conv2d(ref + 11);
+  mm = conv2d(ref + 14);
+  ss = conv2d(ref + 17);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Check whether this DateTime64 is valid.
+        @return true if valid, false if not.
+*/
+/**************************************************************************/
+bool DateTime64::isValid() const {
+  if (y < 1 || y > 9999)
+    return false;
+  DateTime64 other(unixtime());
+  return *this == other;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Check whether this DateTime64 can be held by a DateTime.
+        @return true if the year is within 2000--2099.
+*/
+/**************************************************************************/
+bool DateTime64::inDateTimeRange() const { return y >= 2000 && y <= 2099; }
+
+/**************************************************************************/
+/*!
+        @brief  Convert to a DateTime.
+        @return The same date and time, or an invalid DateTime if the year
+        is outside 2000--2099.
+*/
+/**************************************************************************/
+DateTime DateTime64::toDateTime() const {
+  // year 2255 gives a year offset that DateTime::isValid() rejects
+  return DateTime(inDateTimeRange() ? y : 2255U, m, d, hh, mm, ss);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Number of days since 0000-03-01
+        @return Number of days
+*/
+/**************************************************************************/
+uint32_t DateTime64::days() const {
+  uint32_t early = m <= 2; // January and February end the March-based year
+  uint32_t yy = y - early;
+  uint32_t era = yy / 400;
+  uint32_t yoe = yy - 400 * era;
+  uint32_t mp = m + 9 - 12 * (1 - early);
+  uint32_t doy = (153 * mp + 2) / 5 + d - 1;
+  return era * 146097 + 365 * yoe + yoe / 4 - yoe / 100 + doy;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Return the day of the week.
+        @return Day of week as an integer from 0 (Sunday) to 6 (Saturday).
+*/
+/**************************************************************************/
+uint8_t DateTime64::dayOfTheWeek() const {
+  return (days() + 3) % 7; // 0000-03-01 was a Wednesday
+}
+
+/**************************************************************************/
+/*!
+        @brief  Return Unix time: seconds since 1 Jan 1970.
+        @see The `DateTime64::DateTime64(int64_t)` constructor is the
+        converse of this method.
+        @return Number of seconds since 1970-01-01 00:00:00, negative
+        before it.
+*/
+/**************************************************************************/
+int64_t DateTime64::unixtime() const {
+  int32_t days = this->days() - DAYS_FROM_0000_TO_1970;
+  return (int64_t)days * SECONDS_PER_DAY + (hh * 60L + mm) * 60 + ss;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Add a TimeSpan to the DateTime64 object
+        @param span TimeSpan object
+        @return New DateTime64 object with span added to it.
+*/
+/**************************************************************************/
+DateTime64 DateTime64::operator+(const TimeSpan &span) const {
+  return DateTime64(unixtime() + span.totalseconds());
+}
+
+/**************************************************************************/
+/*!
+        @brief  Subtract a TimeSpan from the DateTime64 object
+        @param span TimeSpan object
+        @return New DateTime64 object with span subtracted from it.
+*/
+/**************************************************************************/
+DateTime64 DateTime64::operator-(const TimeSpan &span) const {
+  return DateTime64(unixtime() - span.totalseconds());
+}
+
+/**************************************************************************/
+/*!
+        @brief  Subtract one DateTime64 from another
+        @note A TimeSpan holds about 68 years either way; subtract the
+        `unixtime()` values for longer intervals.
+        @param right The DateTime64 object to subtract from self
+        @return TimeSpan of the difference between DateTime64s.
+*/
+/**************************************************************************/
+TimeSpan DateTime64::operator-(const DateTime64 &right) const {
+  return TimeSpan(unixtime() - right.unixtime());
+}
+
+/**************************************************************************/
+/*!
+        @brief  Test if one DateTime64 is less (earlier) than another.
+        @param right Comparison DateTime64 object
+        @return True if the left DateTime64 is earlier than the right one.
+*/
+/**************************************************************************/
+bool DateTime64::operator<(const DateTime64 &right) const {
+  if (y != right.y)
+    return y < right.y;
+  // month, day and time packed in their order of significance
+  uint32_t left = (uint32_t)m << 22 | (uint32_t)d << 17 |
+                  (uint32_t)hh << 12 | mm << 6 | ss;
+  uint32_t other = (uint32_t)right.m << 22 | (uint32_t)right.d << 17 |
+                   (uint32_t)right.hh << 12 | right.mm << 6 | right.ss;
+  return left < other;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Test if two DateTime64 objects are equal.
+        @param right Comparison DateTime64 object
+        @return True if both DateTime64 objects are the same.
+*/
+/**************************************************************************/
+bool DateTime64::operator==(const DateTime64 &right) const {
+  return y == right.y && m == right.m && d == right.d && hh == right.hh &&
+         mm == right.mm && ss == right.ss;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Create a PreciseTimeSpan from seconds and microseconds.
+        @param seconds Number of seconds
+        @param micros Number of microseconds to add, of either sign and
+        possibly more than a second
+*/
+/**************************************************************************/
+PreciseTimeSpan::PreciseTimeSpan(int32_t seconds, int32_t micros) {
+  int32_t carry = micros / 1000000;
+  micros -= carry * 1000000;
+  if (micros < 0) {
+    micros += 1000000;
+    carry--;
+  }
+  _seconds = seconds + carry;
+  _micros = micros;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Add another PreciseTimeSpan
+        @param right PreciseTimeSpan to add
+        @return New PreciseTimeSpan object, sum of left and right
+*/
+/**************************************************************************/
+PreciseTimeSpan PreciseTimeSpan::operator+(const PreciseTimeSpan &right) const {
+  return PreciseTimeSpan(_seconds + right._seconds, _micros + right._micros);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Subtract a PreciseTimeSpan
+        @param right PreciseTimeSpan to subtract
+        @return New PreciseTimeSpan object, right subtracted from left
+*/
+/**************************************************************************/
+PreciseTimeSpan PreciseTimeSpan::operator-(const PreciseTimeSpan &right) const {
+  return PreciseTimeSpan(_seconds - right._seconds,
+                         (int32_t)_micros - (int32_t)right._micros);
+}
+
+/**************************************************************************/
+/*!
+        @brief  Constructor from Unix time and a fraction of a second.
+        @param t Time elapsed in seconds since 1970-01-01 00:00:00.
+        @param micros Microseconds to add; whole seconds are carried over.
+*/
+/**************************************************************************/
+PreciseDateTime::PreciseDateTime(uint32_t t, uint32_t micros)
+    : _seconds(t + micros / 1000000), _micros(micros % 1000000) {}
+
+/**************************************************************************/
+/*!
+        @brief  Constructor from a DateTime and a fraction of a second.
+        @param dt Date and time of the whole second.
+        @param micros Microseconds to add; whole seconds are carried over.
+*/
+/**************************************************************************/
+PreciseDateTime::PreciseDateTime(const DateTime &dt, uint32_t micros)
+    : _seconds(dt.unixtime() + micros / 1000000), _micros(micros % 1000000) {}
+
+/**************************************************************************/
+/*!
+        @brief  Writes the PreciseDateTime as a string in a user-defined
+   format.
+
+        This accepts the specifiers of DateTime::toString(), plus runs of
+        one to six "f", which are replaced with as many leading digits of
+        the fraction of a second: "fff" gives the milliseconds and "ffffff"
+        the microseconds. Digits are truncated, not rounded, so that the
+        seconds never need a carry.
+
+        __Example__: The format "hh:mm:ss.fff" generates an output of the
+        form "18:34:56.042".
+
+        @param[in,out] buffer Array of `char` initialized with the format
+        string, and overwritten with the formatted date and time.
+        @return A pointer to the provided buffer.
+*/
+/**************************************************************************/
+char *PreciseDateTime::toString(char *buffer) const {
+  toDateTime().toString(buffer);
+  char *p = buffer;
+  while (*p) {
+    if (*p != 'f') {
+      p++;
+      continue;
+    }
+    uint32_t scale = 100000;
+    while (*p == 'f' && scale) {
+      *p++ = '0' + _micros / scale % 10;
+      scale /= 10;
+    }
+  }
+  return buffer;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Add a PreciseTimeSpan to the PreciseDateTime object
+        @param span PreciseTimeSpan object
+        @return New PreciseDateTime object with span added to it.
+*/
+/**************************************************************************/
+PreciseDateTime PreciseDateTime::operator+(const PreciseTimeSpan &span) const {
+  return PreciseDateTime(_seconds + span.totalseconds(),
+                         _micros + span.microseconds());
+}
+
+/**************************************************************************/
+/*!
+        @brief  Subtract a PreciseTimeSpan from the PreciseDateTime object
+        @param span PreciseTimeSpan object
+        @return New PreciseDateTime object with span subtracted from it.
+*/
+/**************************************************************************/
+PreciseDateTime PreciseDateTime::operator-(const PreciseTimeSpan &span) const {
+  uint32_t borrow = _micros < span.microseconds();
+  return PreciseDateTime(_seconds - span.totalseconds() - borrow,
+                         _micros + 1000000 * borrow - span.microseconds());
+}
+
+/**************************************************************************/
+/*!
+        @brief  Subtract one PreciseDateTime from another
+        @param right The PreciseDateTime object to subtract from self
+        @return PreciseTimeSpan of the difference, negative if right is
+        later.
+*/
+/**************************************************************************/
+PreciseTimeSpan
+PreciseDateTime::operator-(const PreciseDateTime &right) const {
+  return PreciseTimeSpan(_seconds - right._seconds,
+                         (int32_t)_micros - (int32_t)right._micros);
+}
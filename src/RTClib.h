@@ -22,10 +22,39 @@
 #ifndef _RTCLIB_H_
 #define _RTCLIB_H_
 
+#ifdef ARDUINO
 #include <Adafruit_I2CDevice.h>
 #include <Arduino.h>
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#elif defined(ESP8266)
+#include <pgmspace.h>
+#endif
+#else
+// Linux host build: the I2C drivers are left out, and the RTC_<chip>.cpp
+// files compile to nothing, so every source file can be built.
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+// Cores without pgmspace, such as the Due and the Linux host, keep PROGMEM
+// data in plain memory
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef pgm_read_byte
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#endif
+#ifndef pgm_read_word
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#endif
+#ifndef pgm_read_dword
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#endif
 
 class TimeSpan;
+class Pcf8523Countdown;
 
 /** Constants */
 #define SECONDS_PER_DAY 86400L ///< 60 * 60 * 24
@@ -157,6 +186,29 @@ enum PCF8523TimerIntPulse {
   PCF8523_LowPulse14x64Hz = 7  /**< 218.750 ms  14/64ths second */
 };
 
+/** PCF8523 alarm fields, OR-ed together to select the ones to match */
+enum Pcf8523AlarmMode {
+  PCF8523_AlarmMinute = 0x01,  /**< Alarm when the minutes match */
+  PCF8523_AlarmHour = 0x02,    /**< Alarm when the hours match */
+  PCF8523_AlarmDay = 0x04,     /**< Alarm when the day of the month matches */
+  PCF8523_AlarmWeekday = 0x08, /**< Alarm when the day of the week matches */
+};
+
+/** PCF8523 battery switchover modes (PM bits of Control_3). In standard
+    mode, the battery takes over when VDD drops below both VBAT and 2.5 V,
+    in direct mode as soon as VDD drops below VBAT. BLD is the battery low
+    detection. The power-on default is PCF8523_SwitchoverDisabledNoBLD. The
+    PM codes 011 and 110 read back as PCF8523_SwitchoverDisabled and
+    PCF8523_SwitchoverDisabledNoBLD. */
+enum Pcf8523SwitchoverMode {
+  PCF8523_SwitchoverStandard = 0x00,      /**< Standard, BLD enabled */
+  PCF8523_SwitchoverDirect = 0x20,        /**< Direct, BLD enabled */
+  PCF8523_SwitchoverDisabled = 0x40,      /**< VDD only, BLD enabled */
+  PCF8523_SwitchoverStandardNoBLD = 0x80, /**< Standard, BLD disabled */
+  PCF8523_SwitchoverDirectNoBLD = 0xA0,   /**< Direct, BLD disabled */
+  PCF8523_SwitchoverDisabledNoBLD = 0xE0, /**< VDD only, BLD disabled */
+};
+
 /** PCF8523 Offset modes for making temperature/aging/accuracy adjustments */
 enum Pcf8523OffsetMode {
   PCF8523_TwoHours = 0x00, /**< Offset made every two hours */
@@ -172,6 +224,47 @@ enum Pcf8563SqwPinMode {
   PCF8563_SquareWave32kHz = 0x80 /**< 32kHz square wave */
 };
 
+/** PCF8563 alarm fields, to be combined with `|`: the alarm fires when all
+ * selected fields match */
+enum Pcf8563AlarmMode {
+  PCF8563_AlarmMinute = 0x01,  /**< Alarm when the minutes match */
+  PCF8563_AlarmHour = 0x02,    /**< Alarm when the hours match */
+  PCF8563_AlarmDay = 0x04,     /**< Alarm when the day of the month matches */
+  PCF8563_AlarmWeekday = 0x08, /**< Alarm when the day of the week matches */
+};
+
+/** PCF8563 Timer Source Clock Frequencies */
+enum Pcf8563TimerClockFreq {
+  PCF8563_Frequency4kHz = 0,   /**< 1/4096th second, max 62.256 milliseconds */
+  PCF8563_Frequency64Hz = 1,   /**< 1/64th second, max 3.984375 seconds */
+  PCF8563_FrequencySecond = 2, /**< 1 second, max 255 seconds = 4.25 minutes */
+  PCF8563_FrequencyMinute = 3, /**< 1 minute, max 255 minutes = 4.25 hours */
+};
+
+/** PCF8563 interrupt flags, as returned by `readAndClearFlags()` */
+enum Pcf8563Flag {
+  PCF8563_TimerFlag = 0x04, /**< TF: the countdown timer reached zero */
+  PCF8563_AlarmFlag = 0x08, /**< AF: the alarm fired */
+};
+
+/**************************************************************************/
+/*!
+        @brief  Calendar fields of many dates, as a structure of arrays, for
+   the batch conversions `DateTime::toFields()` and `DateTime::fromFields()`.
+
+        Each member points to an array with one element per date.
+*/
+/**************************************************************************/
+struct DateTimeFields {
+  uint16_t *year;     ///< Years (2000--2099)
+  uint8_t *month;     ///< Months (1--12)
+  uint8_t *day;       ///< Days of the month (1--31)
+  uint8_t *hour;      ///< Hours (0--23)
+  uint8_t *minute;    ///< Minutes (0--59)
+  uint8_t *second;    ///< Seconds (0--59)
+  uint8_t *dayOfWeek; ///< Days of the week (0 = Sunday), or NULL
+};
+
 /**************************************************************************/
 /*!
         @brief  Simple general-purpose date/time class (no TZ / DST / leap
@@ -195,7 +288,9 @@ public:
            uint8_t min = 0, uint8_t sec = 0);
   DateTime(const DateTime &copy);
   DateTime(const char *date, const char *time);
+#ifdef ARDUINO
   DateTime(const __FlashStringHelper *date, const __FlashStringHelper *time);
+#endif
   DateTime(const char *iso8601date);
   bool isValid() const;
   char *toString(char *buffer) const;
@@ -246,6 +341,32 @@ public:
   /* 32-bit times as seconds since 1970-01-01. */
   uint32_t unixtime(void) const;
 
+  /* Compact binary encodings, and their batch versions. */
+  void encode32(uint8_t *buf) const;
+  void encode40(uint8_t *buf, uint8_t fraction = 0) const;
+  uint32_t encodeFat() const;
+  void encodeBCD(uint8_t *buf) const;
+  static DateTime decode32(const uint8_t *buf);
+  static DateTime decode40(const uint8_t *buf, uint8_t *fraction = NULL);
+  static DateTime decodeFat(uint32_t fat);
+  static DateTime decodeBCD(const uint8_t *buf);
+  static void encode32(const DateTime *times, uint8_t *buf, uint16_t count);
+  static void decode32(const uint8_t *buf, DateTime *times, uint16_t count);
+  static void encode40(const DateTime *times, const uint8_t *fractions,
+                       uint8_t *buf, uint16_t count);
+  static void decode40(const uint8_t *buf, DateTime *times,
+                       uint8_t *fractions, uint16_t count);
+  static void encodeFat(const DateTime *times, uint32_t *fat, uint16_t count);
+  static void decodeFat(const uint32_t *fat, DateTime *times, uint16_t count);
+  static void encodeBCD(const DateTime *times, uint8_t *buf, uint16_t count);
+  static void decodeBCD(const uint8_t *buf, DateTime *times, uint16_t count);
+
+  /* Batch conversions between Unix times and calendar fields. */
+  static void toFields(const uint32_t *times, const DateTimeFields &fields,
+                       size_t count);
+  static void fromFields(const DateTimeFields &fields, uint32_t *times,
+                         size_t count);
+
   /*!
           Format of the ISO 8601 timestamp generated by `timestamp()`. Each
           option corresponds to a `toString()` format as follows:
@@ -255,7 +376,9 @@ public:
     TIMESTAMP_TIME, //!< `hh:mm:ss`
     TIMESTAMP_DATE  //!< `YYYY-MM-DD`
   };
+#ifdef ARDUINO
   String timestamp(timestampOpt opt = TIMESTAMP_FULL) const;
+#endif
 
   DateTime operator+(const TimeSpan &span) const;
   DateTime operator-(const TimeSpan &span) const;
@@ -309,6 +432,10 @@ public:
   bool operator!=(const DateTime &right) const { return !(*this == right); }
 
 protected:
+  void setSecondstime(uint32_t t);
+  void setFat(uint32_t fat);
+  void setBCD(const uint8_t *buf);
+
   uint8_t yOff; ///< Year offset from 2000
   uint8_t m;    ///< Month 1-12
   uint8_t d;    ///< Day 1-31
@@ -369,6 +496,544 @@ protected:
   int32_t _seconds; ///< Actual TimeSpan value is stored as seconds
 };
 
+/**************************************************************************/
+/*!
+        @brief  Date and time over years 1--9999 of the proleptic Gregorian
+   calendar, with a signed 64-bit Unix time.
+
+        This is the extended-range companion of DateTime, for records
+        before 2000 or after 2099. It converts losslessly to and from
+        DateTime within 2000--2099, and TimeSpans can be added to it in the
+        same way. Conversions to and from Unix time take constant time and
+        only need 32-bit divisions.
+*/
+/**************************************************************************/
+class DateTime64 {
+public:
+  DateTime64(int64_t t = 0);
+  DateTime64(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0,
+             uint8_t min = 0, uint8_t sec = 0);
+  DateTime64(const DateTime &dt);
+  DateTime64(const char *date, const char *time);
+#ifdef ARDUINO
+  DateTime64(const __FlashStringHelper *date, const __FlashStringHelper *time);
+#endif
+  DateTime64(const char *iso8601date);
+  bool isValid() const;
+  bool inDateTimeRange() const;
+  DateTime toDateTime() const;
+
+  /*!
+          @brief  Return the year.
+          @return Year (range: 1--9999).
+  */
+  uint16_t year() const { return y; }
+  /*!
+          @brief  Return the month.
+          @return Month number (1--12).
+  */
+  uint8_t month() const { return m; }
+  /*!
+          @brief  Return the day of the month.
+          @return Day of the month (1--31).
+  */
+  uint8_t day() const { return d; }
+  /*!
+          @brief  Return the hour
+          @return Hour (0--23).
+  */
+  uint8_t hour() const { return hh; }
+  /*!
+          @brief  Return the minute.
+          @return Minute (0--59).
+  */
+  uint8_t minute() const { return mm; }
+  /*!
+          @brief  Return the second.
+          @return Second (0--59).
+  */
+  uint8_t second() const { return ss; }
+
+  uint8_t dayOfTheWeek() const;
+
+  /* Signed 64-bit times as seconds since 1970-01-01. */
+  int64_t unixtime() const;
+
+  DateTime64 operator+(const TimeSpan &span) const;
+  DateTime64 operator-(const TimeSpan &span) const;
+  TimeSpan operator-(const DateTime64 &right) const;
+  bool operator<(const DateTime64 &right) const;
+  bool operator==(const DateTime64 &right) const;
+
+  /*!
+          @brief  Test if one DateTime64 is greater (later) than another.
+          @param right DateTime64 object to compare
+          @return True if the left DateTime64 is later than the right one
+  */
+  bool operator>(const DateTime64 &right) const { return right < *this; }
+  /*!
+          @brief  Test if one DateTime64 is less (earlier) than or equal to
+     another.
+          @param right DateTime64 object to compare
+          @return True if the left DateTime64 is not later than the right one
+  */
+  bool operator<=(const DateTime64 &right) const { return !(right < *this); }
+  /*!
+          @brief  Test if one DateTime64 is greater (later) than or equal to
+     another.
+          @param right DateTime64 object to compare
+          @return True if the left DateTime64 is not earlier than the right one
+  */
+  bool operator>=(const DateTime64 &right) const { return !(*this < right); }
+  /*!
+          @brief  Test if two DateTime64 objects are not equal.
+          @param right DateTime64 object to compare
+          @return True if the two objects are not equal
+  */
+  bool operator!=(const DateTime64 &right) const { return !(*this == right); }
+
+protected:
+  uint32_t days() const;
+
+  uint16_t y; ///< Year 1-9999
+  uint8_t m;  ///< Month 1-12
+  uint8_t d;  ///< Day 1-31
+  uint8_t hh; ///< Hours 0-23
+  uint8_t mm; ///< Minutes 0-59
+  uint8_t ss; ///< Seconds 0-59
+};
+
+/**************************************************************************/
+/*!
+        @brief  Point on a monotonic timescale, with microsecond resolution.
+
+        A MonotonicTime is a number of seconds plus a fraction of a second,
+        counted from an arbitrary origin. Unlike a DateTime, it is not tied to
+        the calendar, and it never goes backwards when the clock it comes from
+        is adjusted. It is meant for timeouts and rate limiting, where only
+        the difference between two readings matters.
+*/
+/**************************************************************************/
+class MonotonicTime {
+public:
+  /*!
+          @brief  Create a MonotonicTime from its two components.
+          @param seconds Whole seconds since the origin of the timescale.
+          @param micros Fraction of a second, in microseconds (0--999999).
+  */
+  MonotonicTime(uint32_t seconds = 0, uint32_t micros = 0)
+      : _seconds(seconds), _micros(micros) {}
+  /*!
+          @brief  Whole seconds since the origin of the timescale.
+          @return Number of seconds.
+  */
+  uint32_t seconds() const { return _seconds; }
+  /*!
+          @brief  Fraction of the current second.
+          @return Number of microseconds (0--999999).
+  */
+  uint32_t microseconds() const { return _micros; }
+
+  /*!
+          @brief  Microseconds elapsed since an earlier MonotonicTime.
+          @note The result wraps around after about 71.6 minutes; use
+            `millisSince()` or `secondsSince()` for longer intervals.
+          @param earlier An earlier reading of the same clock.
+          @return Number of microseconds.
+  */
+  uint32_t microsSince(const MonotonicTime &earlier) const {
+    return (_seconds - earlier._seconds) * 1000000UL + _micros -
+           earlier._micros;
+  }
+  /*!
+          @brief  Milliseconds elapsed since an earlier MonotonicTime.
+          @note The result wraps around after about 49.7 days.
+          @param earlier An earlier reading of the same clock.
+          @return Number of milliseconds.
+  */
+  uint32_t millisSince(const MonotonicTime &earlier) const {
+    return (_seconds - earlier._seconds) * 1000UL + _micros / 1000 -
+           earlier._micros / 1000;
+  }
+  /*!
+          @brief  Whole seconds elapsed since an earlier MonotonicTime.
+          @param earlier An earlier reading of the same clock.
+          @return Number of seconds.
+  */
+  uint32_t secondsSince(const MonotonicTime &earlier) const {
+    return _seconds - earlier._seconds - (_micros < earlier._micros ? 1 : 0);
+  }
+
+  /*!
+          @brief  Test if one MonotonicTime is earlier than another.
+          @param right MonotonicTime to compare
+          @return True if the left reading is earlier than the right one.
+  */
+  bool operator<(const MonotonicTime &right) const {
+    return _seconds < right._seconds ||
+           (_seconds == right._seconds && _micros < right._micros);
+  }
+  /*!
+          @brief  Test if one MonotonicTime is later than another.
+          @param right MonotonicTime to compare
+          @return True if the left reading is later than the right one.
+  */
+  bool operator>(const MonotonicTime &right) const { return right < *this; }
+  /*!
+          @brief  Test if two MonotonicTime objects are equal.
+          @param right MonotonicTime to compare
+          @return True if both readings are the same.
+  */
+  bool operator==(const MonotonicTime &right) const {
+    return _seconds == right._seconds && _micros == right._micros;
+  }
+
+protected:
+  uint32_t _seconds; ///< Whole seconds since the origin
+  uint32_t _micros;  ///< Fraction of a second, in microseconds
+};
+
+/**************************************************************************/
+/*!
+        @brief  TimeSpan with microsecond resolution.
+
+        The span is a whole number of seconds, rounded down, plus a
+        fraction of a second that is always positive, so that -0.25 s is
+        stored as -1 s + 750000 us. It takes 8 bytes.
+*/
+/**************************************************************************/
+class PreciseTimeSpan {
+public:
+  PreciseTimeSpan(int32_t seconds = 0, int32_t micros = 0);
+  /*!
+          @brief  Create a PreciseTimeSpan from a TimeSpan.
+          @param span TimeSpan to convert
+  */
+  PreciseTimeSpan(const TimeSpan &span)
+      : _seconds(span.totalseconds()), _micros(0) {}
+
+  /*!
+          @brief  Whole seconds in the span, rounded down.
+          @return Number of seconds
+  */
+  int32_t totalseconds() const { return _seconds; }
+  /*!
+          @brief  Fraction of a second to add to totalseconds().
+          @return Number of microseconds (0--999999)
+  */
+  uint32_t microseconds() const { return _micros; }
+  /*!
+          @brief  Fraction of a second to add to totalseconds().
+          @return Number of milliseconds (0--999)
+  */
+  uint16_t milliseconds() const { return _micros / 1000; }
+  /*!
+          @brief  Total length of the span.
+          @return Number of microseconds
+  */
+  int64_t totalmicros() const { return _seconds * 1000000LL + _micros; }
+  /*!
+          @brief  Convert to a TimeSpan, rounding down to the second.
+          @return TimeSpan of totalseconds()
+  */
+  TimeSpan toTimeSpan() const { return TimeSpan(_seconds); }
+
+  PreciseTimeSpan operator+(const PreciseTimeSpan &right) const;
+  PreciseTimeSpan operator-(const PreciseTimeSpan &right) const;
+
+  /*!
+          @brief  Test if one PreciseTimeSpan is shorter than another.
+          @param right PreciseTimeSpan to compare
+          @return True if the left span is shorter than the right one.
+  */
+  bool operator<(const PreciseTimeSpan &right) const {
+    return _seconds < right._seconds ||
+           (_seconds == right._seconds && _micros < right._micros);
+  }
+  /*!
+          @brief  Test if one PreciseTimeSpan is longer than another.
+          @param right PreciseTimeSpan to compare
+          @return True if the left span is longer than the right one.
+  */
+  bool operator>(const PreciseTimeSpan &right) const { return right < *this; }
+  /*!
+          @brief  Test if two PreciseTimeSpan objects are equal.
+          @param right PreciseTimeSpan to compare
+          @return True if both spans are the same.
+  */
+  bool operator==(const PreciseTimeSpan &right) const {
+    return _seconds == right._seconds && _micros == right._micros;
+  }
+
+protected:
+  int32_t _seconds; ///< Whole seconds, rounded down
+  uint32_t _micros; ///< Fraction of a second, in microseconds
+};
+
+/**************************************************************************/
+/*!
+        @brief  DateTime with microsecond resolution.
+
+        A PreciseDateTime is a Unix time in seconds, as returned by
+        DateTime::unixtime(), plus a fraction of a second. It takes 8
+        bytes, so that timestamped samples no longer need a separate
+        `millis()` reading.
+*/
+/**************************************************************************/
+class PreciseDateTime {
+public:
+  PreciseDateTime(uint32_t t = SECONDS_FROM_1970_TO_2000, uint32_t micros = 0);
+  PreciseDateTime(const DateTime &dt, uint32_t micros = 0);
+
+  /*!
+          @brief  Convert to a DateTime, dropping the fraction of a second.
+          @return DateTime of the whole second
+  */
+  DateTime toDateTime() const { return DateTime(_seconds); }
+  /*!
+          @brief  Whole seconds since 1970-01-01 00:00:00.
+          @return Unix time
+  */
+  uint32_t unixtime() const { return _seconds; }
+  /*!
+          @brief  Fraction of the current second.
+          @return Number of microseconds (0--999999)
+  */
+  uint32_t microseconds() const { return _micros; }
+  /*!
+          @brief  Fraction of the current second.
+          @return Number of milliseconds (0--999)
+  */
+  uint16_t milliseconds() const { return _micros / 1000; }
+  char *toString(char *buffer) const;
+
+  PreciseDateTime operator+(const PreciseTimeSpan &span) const;
+  PreciseDateTime operator-(const PreciseTimeSpan &span) const;
+  PreciseTimeSpan operator-(const PreciseDateTime &right) const;
+
+  /*!
+          @brief  Test if one PreciseDateTime is earlier than another.
+          @param right PreciseDateTime to compare
+          @return True if the left time is earlier than the right one.
+  */
+  bool operator<(const PreciseDateTime &right) const {
+    return _seconds < right._seconds ||
+           (_seconds == right._seconds && _micros < right._micros);
+  }
+  /*!
+          @brief  Test if one PreciseDateTime is later than another.
+          @param right PreciseDateTime to compare
+          @return True if the left time is later than the right one.
+  */
+  bool operator>(const PreciseDateTime &right) const { return right < *this; }
+  /*!
+          @brief  Test if one PreciseDateTime is earlier than or equal to
+     another.
+          @param right PreciseDateTime to compare
+          @return True if the left time is not later than the right one.
+  */
+  bool operator<=(const PreciseDateTime &right) const {
+    return !(right < *this);
+  }
+  /*!
+          @brief  Test if one PreciseDateTime is later than or equal to
+     another.
+          @param right PreciseDateTime to compare
+          @return True if the left time is not earlier than the right one.
+  */
+  bool operator>=(const PreciseDateTime &right) const {
+    return !(*this < right);
+  }
+  /*!
+          @brief  Test if two PreciseDateTime objects are equal.
+          @param right PreciseDateTime to compare
+          @return True if both times are the same.
+  */
+  bool operator==(const PreciseDateTime &right) const {
+    return _seconds == right._seconds && _micros == right._micros;
+  }
+  /*!
+          @brief  Test if two PreciseDateTime objects are not equal.
+          @param right PreciseDateTime to compare
+          @return True if the times differ.
+  */
+  bool operator!=(const PreciseDateTime &right) const {
+    return !(*this == right);
+  }
+
+protected:
+  uint32_t _seconds; ///< Whole seconds since 1970-01-01 00:00:00
+  uint32_t _micros;  ///< Fraction of a second, in microseconds
+};
+
+/**************************************************************************/
+/*!
+        @brief  Pre-compiled format for rendering many timestamps at once.
+
+        The format uses the specifiers of `DateTime::toString()`. It is
+        parsed once by begin(); format() then renders arrays of times into
+        one contiguous buffer of fixed-width records, each followed by a
+        terminator character. The date part of a record is only rendered
+        when the day changes, which makes logs sorted by time cheap to
+        export. Usage:
+
+        ```
+        DateTimeFormat iso;
+        iso.begin("YYYY-MM-DDThh:mm:ss");
+        char out[8 * (19 + 1)];
+        iso.format(times, 8, out); // eight lines of 19 characters
+        ```
+*/
+/**************************************************************************/
+class DateTimeFormat {
+public:
+  ~DateTimeFormat();
+  bool begin(const char *format);
+  /*!
+          @brief  Width of a rendered record.
+          @return Number of characters in a record, terminator excluded
+  */
+  uint8_t width() const { return length; }
+  size_t format(const uint32_t *times, size_t count, char *out,
+                char terminator = '\n');
+  size_t format(const DateTime *times, size_t count, char *out,
+                char terminator = '\n');
+
+protected:
+  void renderDate(const DateTime &dt);
+  void renderTime(uint8_t hh, uint8_t mm, uint8_t ss);
+  char *record = NULL;     ///< Record being rendered
+  uint8_t *fields = NULL;  ///< Kind and position of each specifier, in pairs
+  uint8_t fieldCount = 0;  ///< Number of specifiers
+  uint8_t length = 0;      ///< Width of a record
+  bool twelveHour = false; ///< True if the format has an AM/PM specifier
+};
+
+#define TIMEZONE_NAME_SIZE 8 ///< Room for a zone abbreviation, with its NUL
+
+/**************************************************************************/
+/*!
+        @brief  Time zone and daylight saving time rules, from a POSIX TZ
+   string.
+
+        The rule string has the form `std offset [dst [offset]
+        [,start[/time],end[/time]]]`, e.g. `CET-1CEST,M3.5.0,M10.5.0/3` for
+        central Europe or `AEST-10AEDT,M10.1.0,M4.1.0/3` for eastern
+        Australia. As in POSIX, offsets count hours _west_ of Greenwich.
+        The start and end of DST can be given as `Mm.w.d` (day `d` of week
+        `w` of month `m`), `Jn` (day of the year, ignoring February 29) or
+        `n` (zero-based day of the year); times default to 02:00. Without a
+        rule, the US rules `M3.2.0,M11.1.0` are used.
+
+        The DST transitions of the current year are cached, so a conversion
+        normally costs a couple of comparisons. Usage:
+
+        ```
+        TimeZone paris;
+        paris.begin("CET-1CEST,M3.5.0,M10.5.0/3");
+        DateTime local = paris.toLocal(rtc.now()); // with the RTC on UTC
+        ```
+*/
+/**************************************************************************/
+class TimeZone {
+public:
+  bool begin(const char *tz);
+  int32_t offset(const DateTime &utc);
+  bool isDST(const DateTime &utc);
+  const char *abbreviation(const DateTime &utc);
+  DateTime toLocal(const DateTime &utc);
+  DateTime toUTC(const DateTime &local);
+
+protected:
+  /** Date and time of a DST transition, in local time */
+  struct Rule {
+    char type;     ///< 'M' (month, week, day), 'J' (Julian day) or 'n'
+    uint8_t month; ///< Month, 1--12, for 'M' rules
+    uint8_t week;  ///< Week, 1--5 (5: last), for 'M' rules
+    uint16_t day;  ///< Day of the week for 'M' rules, else day of the year
+    int32_t time;  ///< Time of the transition after midnight, in seconds
+  };
+  bool parse(const char *tz);
+  bool parseRule(const char *&p, Rule &rule);
+  uint32_t transition(const Rule &rule, uint16_t year) const;
+  bool dstAt(uint32_t utc);
+  void cacheYear(uint32_t utc);
+  char stdName[TIMEZONE_NAME_SIZE] = "UTC"; ///< Abbreviation of standard time
+  char dstName[TIMEZONE_NAME_SIZE] = "";    ///< Abbreviation of DST
+  int32_t stdOffset = 0;                    ///< Standard offset east of UTC (s)
+  int32_t dstOffset = 0;                    ///< DST offset east of UTC (s)
+  bool hasDST = false;                      ///< True if the zone observes DST
+  Rule start;                               ///< Start of DST
+  Rule end;                                 ///< End of DST
+  uint32_t yearStart = 0;                   ///< Start of the cached year, UTC
+  uint32_t yearEnd = 0;                     ///< End of the cached year, UTC
+  uint32_t dstStart = 0;                    ///< Cached start of DST, UTC
+  uint32_t dstEnd = 0;                      ///< Cached end of DST, UTC
+};
+
+#define TZTABLE_ANCHOR_INTERVAL 16 ///< Transitions per absolute time anchor
+
+/**************************************************************************/
+/*!
+        @brief  Transitions of a time zone over 2000--2099, compiled from
+   tzdata by `extras/tzcompile.py`.
+
+        All arrays live in PROGMEM. Transition times are stored as the
+        number of quarter-hours since the previous transition; every
+        #TZTABLE_ANCHOR_INTERVAL-th transition also has its absolute time in
+        `anchors`, so that a lookup can binary-search the anchors and then
+        only add up a few deltas.
+*/
+/**************************************************************************/
+struct TzTable {
+  const uint32_t *anchors; ///< Unix time of every 16th transition, UTC
+  const uint16_t *deltas;  ///< Quarter-hours since the previous transition
+  const uint8_t *indices;  ///< Offset in effect from each transition
+  /*!
+          Distinct offsets of the zone, in quarter-hours east of UTC plus
+          64, with bit 7 set for DST.
+  */
+  const uint8_t *offsets;
+  uint16_t count;  ///< Number of transitions
+  uint8_t initial; ///< Offset in effect before the first transition
+};
+
+/**************************************************************************/
+/*!
+        @brief  Time zone following the historical rules of tzdata, from a
+   TzTable.
+
+        This provides the same conversions as TimeZone, from precomputed
+        transitions rather than rules. The interval between the transitions
+        around the last lookup is cached, so that repeated conversions of
+        nearby times do not search the table. Usage:
+
+        ```
+        #include "zones.h" // generated by extras/tzcompile.py
+        CompiledTimeZone paris;
+        paris.begin(tz_Europe_Paris);
+        DateTime local = paris.toLocal(rtc.now()); // with the RTC on UTC
+        ```
+*/
+/**************************************************************************/
+class CompiledTimeZone {
+public:
+  void begin(const TzTable &table);
+  int32_t offset(const DateTime &utc);
+  bool isDST(const DateTime &utc);
+  DateTime toLocal(const DateTime &utc);
+  DateTime toUTC(const DateTime &local);
+
+protected:
+  uint8_t lookup(uint32_t utc);
+  int32_t offsetAt(uint32_t utc);
+  const TzTable *table = NULL; ///< Transitions of the zone
+  uint32_t hitStart = 1;       ///< Start of the cached interval, UTC
+  uint32_t hitEnd = 0;         ///< End of the cached interval, UTC
+  uint8_t hit = 64;            ///< Offset in effect in the cached interval
+};
+
+#ifdef ARDUINO
 /**************************************************************************/
 /*!
         @brief  A generic I2C RTC base class. DO NOT USE DIRECTLY
@@ -392,6 +1057,18 @@ protected:
   Adafruit_I2CDevice *i2c_dev = NULL; ///< Pointer to I2C bus interface
   uint8_t read_register(uint8_t reg);
   void write_register(uint8_t reg, uint8_t val);
+  size_t read_registers(uint8_t reg, uint8_t *buf, size_t size);
+  size_t write_registers(uint8_t reg, const uint8_t *buf, size_t size);
+};
+
+/**************************************************************************/
+/*!
+        @brief  Configuration registers of a DS1307, as saved by `snapshot()`.
+        This is plain data that can be stored anywhere, e.g. in flash.
+*/
+/**************************************************************************/
+struct Ds1307Snapshot {
+  uint8_t control; ///< Control register (0x07)
 };
 
 /**************************************************************************/
@@ -402,6 +1079,7 @@ protected:
 /**************************************************************************/
 class RTC_DS1307 : RTC_I2C {
 public:
+  static const uint8_t NVRAM_SIZE = 56; ///< Size of the NVRAM, in bytes
   bool begin(TwoWire *wireInstance = &Wire);
   void adjust(const DateTime &dt);
   uint8_t isrunning(void);
@@ -412,8 +1090,52 @@ public:
   void readnvram(uint8_t *buf, uint8_t size, uint8_t address);
   void writenvram(uint8_t address, uint8_t data);
   void writenvram(uint8_t address, const uint8_t *buf, uint8_t size);
+  Ds1307Snapshot snapshot();
+  void restore(const Ds1307Snapshot &snap);
+};
+
+/**************************************************************************/
+/*!
+        @brief  Complete state of a DS3231 or DS3232 alarm, as returned by
+   `readAlarm1()` and `readAlarm2()`.
+*/
+/**************************************************************************/
+struct Ds3231AlarmState {
+  /*!
+          Matched date/time, with the day, hour, minute and second fields set
+          as in `getAlarm1()`. When `dayOfWeek` is set, the day field holds
+          the day of the week, from 1 (Monday) to 7 (Sunday).
+  */
+  DateTime time;
+  /*!
+          Alarm mode: a #Ds3231Alarm1Mode (or #Ds3232Alarm1Mode) value for
+          alarm 1, a #Ds3231Alarm2Mode (or #Ds3232Alarm2Mode) value for
+          alarm 2.
+  */
+  uint8_t mode;
+  bool dayOfWeek; ///< DY/DT bit: match on the day of the week, not the date
+  bool enabled;   ///< Alarm interrupt enable bit (A1IE/A2IE)
+  bool fired;     ///< Alarm flag (A1F/A2F)
+  bool interrupt; ///< INTCN bit: the INT/SQW pin is in interrupt mode
+};
+
+/** Complete state of a DS3232 alarm, identical to the DS3231's */
+typedef Ds3231AlarmState Ds3232AlarmState;
+
+/**************************************************************************/
+/*!
+        @brief  Configuration registers of a DS3231 or DS3232, as saved by
+   `snapshot()`: alarms, control, status and aging offset (0x07 to 0x10).
+   This is plain data that can be stored anywhere, e.g. in flash.
+*/
+/**************************************************************************/
+struct Ds3231Snapshot {
+  uint8_t registers[10]; ///< Register values, starting at 0x07
 };
 
+/** Configuration registers of a DS3232, identical to the DS3231's */
+typedef Ds3231Snapshot Ds3232Snapshot;
+
 /**************************************************************************/
 /*!
         @brief  RTC based on the DS3231 chip connected via I2C and the Wire
@@ -424,8 +1146,10 @@ class RTC_DS3231 : RTC_I2C {
 public:
   bool begin(TwoWire *wireInstance = &Wire);
   void adjust(const DateTime &dt);
+  void adjust(const DateTime64 &dt);
   bool lostPower(void);
   DateTime now();
+  DateTime64 now64();
   Ds3231SqwPinMode readSqwPinMode();
   void writeSqwPinMode(Ds3231SqwPinMode mode);
   bool setAlarm1(const DateTime &dt, Ds3231Alarm1Mode alarm_mode);
@@ -434,6 +1158,10 @@ public:
   DateTime getAlarm2();
   Ds3231Alarm1Mode getAlarm1Mode();
   Ds3231Alarm2Mode getAlarm2Mode();
+  Ds3231AlarmState readAlarm1();
+  Ds3231AlarmState readAlarm2();
+  Ds3231Snapshot snapshot();
+  void restore(const Ds3231Snapshot &snap);
   void disableAlarm(uint8_t alarm_num);
   void clearAlarm(uint8_t alarm_num);
   bool alarmFired(uint8_t alarm_num);
@@ -441,6 +1169,12 @@ public:
   void disable32K(void);
   bool isEnabled32K(void);
   float getTemperature(); // in Celsius degree
+  int16_t getTemperatureQuarters(void);
+  bool startTemperatureConversion(void);
+  bool isConvertingTemperature(void);
+  int8_t readAgingOffset(void);
+  void writeAgingOffset(int8_t offset);
+  int8_t calibrate(int32_t ppb);
   /*!
           @brief  Convert the day of the week to a representation suitable for
                           storing in the DS3231: from 1 (Monday) to 7 (Sunday).
@@ -458,14 +1192,21 @@ public:
 /**************************************************************************/
 class RTC_DS3232 : RTC_I2C {
 public:
+  static const uint8_t NVRAM_SIZE = 236; ///< Size of the NVRAM, in bytes
   boolean begin(TwoWire *wireInstance = &Wire);
   void adjust(const DateTime &dt);
+  void adjust(const DateTime64 &dt);
   bool lostPower(void);
   DateTime now();
+  DateTime64 now64();
   Ds3232SqwPinMode readSqwPinMode();
   void writeSqwPinMode(Ds3232SqwPinMode mode);
   bool setAlarm1(const DateTime &dt, Ds3232Alarm1Mode alarm_mode);
   bool setAlarm2(const DateTime &dt, Ds3232Alarm2Mode alarm_mode);
+  Ds3232AlarmState readAlarm1();
+  Ds3232AlarmState readAlarm2();
+  Ds3232Snapshot snapshot();
+  void restore(const Ds3232Snapshot &snap);
   void disableAlarm(uint8_t alarm_num);
   void clearAlarm(uint8_t alarm_num);
   bool alarmFired(uint8_t alarm_num);
@@ -480,6 +1221,12 @@ public:
   void disableEOSC(void);
   bool isEnabledEOSC(void);
   float getTemperature(); // in Celsius degree
+  int16_t getTemperatureQuarters(void);
+  bool startTemperatureConversion(void);
+  bool isConvertingTemperature(void);
+  int8_t readAgingOffset(void);
+  void writeAgingOffset(int8_t offset);
+  int8_t calibrate(int32_t ppb);
   /*!
           @brief  Convert the day of the week to a representation suitable for
                           storing in the DS3232: from 1 (Monday) to 7 (Sunday).
@@ -493,6 +1240,37 @@ public:
   void writenvram(uint8_t address, uint8_t data);
   void writenvram(uint8_t address, const uint8_t *buf, uint8_t size);
 };
+/**************************************************************************/
+/*!
+        @brief  Power, battery and interrupt state of a PCF8523, as returned
+   by `readStatus()` from a single transfer of registers 0x00 to 0x03.
+*/
+/**************************************************************************/
+struct Pcf8523Status {
+  Pcf8523SwitchoverMode switchover; ///< Battery switchover mode
+  bool batteryLow;                  ///< BLF: the battery is low
+  bool batterySwitchover;           ///< BSF: ran on battery since last cleared
+  bool oscillatorStopped;           ///< OS: see lostPower()
+  bool stopped;                     ///< STOP: the clock is stopped, see stop()
+  bool alarmFired;                  ///< AF: the alarm fired
+  bool secondFired;                 ///< SF: the second timer fired
+  bool timerAFired;                 ///< CTAF or WTAF: Timer A fired
+  bool timerBFired;                 ///< CTBF: Timer B fired
+};
+
+/**************************************************************************/
+/*!
+        @brief  Configuration registers of a PCF8523, as saved by
+   `snapshot()`: control (0x00 to 0x02), alarms, offset, CLKOUT and timers
+   (0x0A to 0x13). This is plain data that can be stored anywhere, e.g. in
+   flash.
+*/
+/**************************************************************************/
+struct Pcf8523Snapshot {
+  uint8_t control[3];    ///< Control registers, starting at 0x00
+  uint8_t registers[10]; ///< Alarm to timer registers, starting at 0x0A
+};
+
 /**************************************************************************/
 /*!
         @brief  RTC based on the PCF8523 chip connected via I2C and the Wire
@@ -517,9 +1295,49 @@ public:
                             uint8_t lowPulseWidth);
   void enableCountdownTimer(PCF8523TimerClockFreq clkFreq, uint8_t numPeriods);
   void disableCountdownTimer(void);
+  void enableCountdownTimerA(PCF8523TimerClockFreq clkFreq, uint8_t numPeriods);
+  void enableWatchdogTimer(PCF8523TimerClockFreq clkFreq, uint8_t numPeriods);
+  void feedWatchdog(uint8_t numPeriods);
+  void disableTimerA(void);
+  bool timerAFired(void);
   void deconfigureAllTimers(void);
+  bool setAlarm(const DateTime &dt, uint8_t mode);
+  DateTime getAlarm();
+  uint8_t getAlarmMode();
+  void disableAlarm(void);
+  void clearAlarm(void);
+  bool alarmFired(void);
+  void startCountdown(Pcf8523Countdown &countdown);
+  bool updateCountdown(Pcf8523Countdown &countdown);
   void calibrate(Pcf8523OffsetMode mode, int8_t offset);
-};
+  int8_t calibrate(int32_t ppb);
+  Pcf8523Status readStatus(void);
+  Pcf8523SwitchoverMode readSwitchoverMode(void);
+  void writeSwitchoverMode(Pcf8523SwitchoverMode mode);
+  void clearBatterySwitchover(void);
+  int8_t readOffset(void);
+  Pcf8523OffsetMode readOffsetMode(void);
+  Pcf8523Snapshot snapshot();
+  void restore(const Pcf8523Snapshot &snap);
+
+protected:
+  void configureTimerA(PCF8523TimerClockFreq clkFreq, uint8_t numPeriods,
+                       uint8_t clkout);
+  void writeControl2(uint8_t enable, uint8_t clear);
+  void writeAlarmControl(bool enable);
+};
+
+/**************************************************************************/
+/*!
+        @brief  Configuration registers of a PCF8563, as saved by
+   `snapshot()`: control (0x00 to 0x01), alarms, CLKOUT and timer (0x09 to
+   0x0F). This is plain data that can be stored anywhere, e.g. in flash.
+*/
+/**************************************************************************/
+struct Pcf8563Snapshot {
+  uint8_t control[2];   ///< Control registers, starting at 0x00
+  uint8_t registers[7]; ///< Alarm to timer registers, starting at 0x09
+};
 
 /**************************************************************************/
 /*!
@@ -532,18 +1350,40 @@ public:
   bool begin(TwoWire *wireInstance = &Wire);
   bool lostPower(void);
   void adjust(const DateTime &dt);
+  void adjust(const DateTime64 &dt);
   DateTime now();
+  DateTime64 now64();
   void start(void);
   void stop(void);
   uint8_t isrunning();
   Pcf8563SqwPinMode readSqwPinMode();
   void writeSqwPinMode(Pcf8563SqwPinMode mode);
+  bool setAlarm(const DateTime &dt, uint8_t mode);
+  DateTime getAlarm();
+  uint8_t getAlarmMode();
+  void disableAlarm(void);
+  void clearAlarm(void);
+  bool alarmFired(void);
+  void enableCountdownTimer(Pcf8563TimerClockFreq clkFreq, uint8_t numPeriods,
+                            bool pulse = false);
+  void disableCountdownTimer(void);
+  uint8_t readCountdownTimer(void);
+  void clearCountdownTimer(void);
+  bool countdownFired(void);
+  uint8_t readAndClearFlags(void);
+  Pcf8563Snapshot snapshot();
+  void restore(const Pcf8563Snapshot &snap);
 };
+#endif // ARDUINO
 
 /**************************************************************************/
 /*!
         @brief  RTC using the internal millis() clock, has to be initialized
    before use. NOTE: this is immune to millis() rollover events.
+
+   On a Linux host, this is backed by `clock_gettime(CLOCK_MONOTONIC)` with
+   nanosecond resolution instead, and can be started from the system's
+   wall clock (`CLOCK_REALTIME`) with begin().
 */
 /**************************************************************************/
 class RTC_Millis {
@@ -553,10 +1393,18 @@ public:
           @param dt DateTime object with the date/time to set
   */
   void begin(const DateTime &dt) { adjust(dt); }
+#ifndef ARDUINO
+  void begin();
+#endif
   void adjust(const DateTime &dt);
   DateTime now();
+  MonotonicTime monotonic();
 
 protected:
+#ifndef ARDUINO
+  int64_t unixNanos = 0; ///< Unix time at `monoNanos`, in nanoseconds
+  int64_t monoNanos = 0; ///< `CLOCK_MONOTONIC` reading at the last adjust()
+#else
   /*!
           Unix time from the previous call to now().
 
@@ -573,6 +1421,17 @@ protected:
           second** of Unix time preceding the last call to now().
   */
   uint32_t lastMillis;
+  /*!
+          Seconds of the monotonic timescale, as of the previous call to
+          monotonic(). This is never changed by adjust().
+  */
+  uint32_t monoSeconds = 0;
+  /*!
+          `millis()` value corresponding to `monoSeconds`. Starting at zero
+          makes the monotonic timescale count from boot.
+  */
+  uint32_t monoMillis = 0;
+#endif
 };
 
 /**************************************************************************/
@@ -582,6 +1441,9 @@ protected:
                         the natural drift of the system clock. Note that now()
    has to be called more frequently than the micros() rollover period, which is
                         approximately 71.6 minutes.
+
+   On a Linux host, this shares the `clock_gettime()` backend of RTC_Millis,
+   and has no rollover constraint.
 */
 /**************************************************************************/
 class RTC_Micros {
@@ -591,11 +1453,23 @@ public:
           @param dt DateTime object with the date/time to set
   */
   void begin(const DateTime &dt) { adjust(dt); }
+#ifndef ARDUINO
+  void begin();
+#endif
   void adjust(const DateTime &dt);
   void adjustDrift(int ppm);
   DateTime now();
+  MonotonicTime monotonic();
 
 protected:
+#ifndef ARDUINO
+  int64_t unixNanos = 0; ///< Unix time at `monoNanos`, in nanoseconds
+  /*!
+          `CLOCK_MONOTONIC` reading at the last adjust() or adjustDrift()
+  */
+  int64_t monoNanos = 0;
+  int32_t driftPpm = 0; ///< Drift compensation set by adjustDrift()
+#else
   /*!
           Number of microseconds reported by `micros()` per "true"
           (calibrated) second.
@@ -611,6 +1485,1163 @@ protected:
           `micros()` value corresponding to `lastUnix`.
   */
   uint32_t lastMicros;
+  /*!
+          Seconds of the monotonic timescale, as of the previous call to
+          monotonic(). This is never changed by adjust().
+  */
+  uint32_t monoSeconds = 0;
+  /*!
+          `micros()` value corresponding to `monoSeconds`.
+  */
+  uint32_t monoMicros = 0;
+#endif
+};
+
+/**************************************************************************/
+/*!
+        @brief  Priority queue of software alarms, ordered by fire time.
+
+        Alarms are identified by a small integer id returned by add(), and
+        kept in a binary min-heap so that the earliest one is always at hand.
+        Adding or removing an alarm costs O(log n). Each alarm uses 12 bytes
+        of RAM, allocated once by begin(). Times are Unix times, as returned
+        by `DateTime::unixtime()`.
+
+        @see RTC_AlarmScheduler drives a hardware alarm from this queue.
+*/
+/**************************************************************************/
+class AlarmQueue {
+public:
+  /*!
+          @brief  Create an empty queue, with no storage until begin().
+  */
+  AlarmQueue() {}
+  ~AlarmQueue();
+  /*!
+          @brief  Not copyable: the queue owns its storage.
+  */
+  AlarmQueue(const AlarmQueue &) = delete;
+  /*!
+          @brief  Not assignable: the queue owns its storage.
+  */
+  AlarmQueue &operator=(const AlarmQueue &) = delete;
+  bool begin(uint16_t capacity);
+  int16_t add(uint32_t time, uint32_t period = 0);
+  bool remove(uint16_t id);
+  int16_t fire(uint32_t now);
+  /*!
+          @brief  Number of scheduled alarms.
+          @return Number of alarms in the queue
+  */
+  uint16_t size() const { return count; }
+  /*!
+          @brief  Check whether the queue is empty.
+          @return True if no alarm is scheduled
+  */
+  bool empty() const { return count == 0; }
+  /*!
+          @brief  Fire time of the earliest alarm.
+          @warning Meaningless if the queue is empty.
+          @return Unix time of the next alarm
+  */
+  uint32_t nextTime() const { return times[heap[0]]; }
+  /*!
+          @brief  Id of the earliest alarm.
+          @warning Meaningless if the queue is empty.
+          @return Id of the next alarm
+  */
+  uint16_t nextId() const { return heap[0]; }
+
+protected:
+  void place(uint16_t index, uint16_t id);
+  void siftUp(uint16_t index);
+  void siftDown(uint16_t index);
+  uint32_t *times = NULL;   ///< Next fire time of each alarm, by id
+  uint32_t *periods = NULL; ///< Repeat period of each alarm (0: one-shot)
+  /*!
+          Heap of alarm ids. The first `count` entries form the heap, the
+          remaining ones are the free ids.
+  */
+  uint16_t *heap = NULL;
+  uint16_t *positions = NULL; ///< Index of each alarm id within `heap`
+  uint16_t capacity = 0;      ///< Maximum number of alarms
+  uint16_t count = 0;         ///< Number of scheduled alarms
+};
+
+/**************************************************************************/
+/*!
+        @brief  Plan mapping a duration onto the countdown timers of a
+   PCF8523.
+
+        Each timer counts at most 255 periods of one of five source clocks,
+        from 1/4096 s to 1 hour. plan() splits a duration into a long stage,
+        repeated on Timer A, which reloads by itself, followed by an
+        optional short stage on Timer B for the remainder. By default it
+        picks the most accurate plan taking at most one wake-up more than
+        the fewest possible; given a maximum error, the plan with the fewest
+        wake-ups within it.
+
+        The 1 Hz, 1/60 Hz and 1/3600 Hz source clocks run on while a timer
+        is stopped, so the first period counted after starting a timer lasts
+        from none to a whole period. This happens once on Timer A, when the
+        countdown starts, and once on Timer B, when it switches to the short
+        stage. The countdown thus elapses up to uncertaintyMicros() earlier
+        than errorMicros() says, and plans are centred on that range. Usage:
+
+        ```
+        Pcf8523Countdown countdown;
+        countdown.plan(TimeSpan(30, 0, 0, 0), 1000); // 30 days, within 1 s
+        rtc.startCountdown(countdown);
+        ...
+        // on each interrupt from the INT pin
+        if (rtc.updateCountdown(countdown)) { ... } // elapsed
+        ```
+*/
+/**************************************************************************/
+class Pcf8523Countdown {
+public:
+  bool plan(uint32_t millis, uint32_t maxErrorMillis = 0);
+  bool plan(const TimeSpan &span, uint32_t maxErrorMillis = 0);
+  bool start();
+  bool countLong();
+
+  /*!
+          @brief  Source clock of the long stage, run on Timer A.
+          @return Source clock frequency
+  */
+  PCF8523TimerClockFreq longFreq() const { return longClock; }
+  /*!
+          @brief  Length of the long stage.
+          @return Number of longFreq() periods (1-255)
+  */
+  uint8_t longPeriods() const { return longCount; }
+  /*!
+          @brief  Number of times the long stage runs.
+          @return Number of Timer A interrupts
+  */
+  uint16_t repeats() const { return repeatCount; }
+  /*!
+          @brief  Source clock of the short stage, run on Timer B.
+          @return Source clock frequency
+  */
+  PCF8523TimerClockFreq shortFreq() const { return shortClock; }
+  /*!
+          @brief  Length of the short stage.
+          @return Number of shortFreq() periods, 0 if there is no short stage
+  */
+  uint8_t shortPeriods() const { return shortCount; }
+  /*!
+          @brief  Number of interrupts before the countdown elapses.
+          @return Number of wake-ups
+  */
+  uint16_t wakeups() const { return repeatCount + (shortCount ? 1 : 0); }
+  /*!
+          @brief  Planned duration minus the requested one.
+          @return Error in microseconds, saturated to the int32_t range, if
+            the first period of each stage is a whole one
+  */
+  int32_t errorMicros() const { return error; }
+  /*!
+          @brief  How much earlier than errorMicros() says the countdown
+            may elapse.
+          @return One period of each source clock of 1 Hz or slower that a
+            stage starts on, in microseconds
+  */
+  uint32_t uncertaintyMicros() const { return uncertainty; }
+
+protected:
+  bool planUnits(uint64_t target, uint64_t maxError);
+  PCF8523TimerClockFreq longClock = PCF8523_FrequencySecond;  ///< Timer A
+  PCF8523TimerClockFreq shortClock = PCF8523_FrequencySecond; ///< Timer B
+  uint8_t longCount = 0;    ///< Timer A periods per long stage
+  uint8_t shortCount = 0;   ///< Timer B periods, 0 for none
+  uint16_t repeatCount = 0; ///< Number of long stages
+  uint16_t remaining = 0;   ///< Long stages left to run
+  int32_t error = 0;        ///< Planned minus requested duration, in us
+  uint32_t uncertainty = 0; ///< Shortfall of the first periods, in us
+};
+
+#define NVRAMCACHE_MAX_GAP 2 ///< Longest clean gap merged into a dirty range
+
+/**************************************************************************/
+/*!
+        @brief  RAM mirror of an RTC's NVRAM, with dirty byte tracking.
+
+        Writes only update the mirror and mark the bytes as dirty;
+        nextDirtyRange() then hands out the dirty bytes as a few merged
+        ranges, so that they can be written back in as few bus transfers as
+        possible. Clean gaps of up to #NVRAMCACHE_MAX_GAP bytes between dirty
+        bytes are merged into the surrounding range, since rewriting them is
+        cheaper than starting a new transfer.
+
+        @see RTC_NvramCache binds this to a DS1307 or DS3232.
+*/
+/**************************************************************************/
+class NvramCache {
+public:
+  /*!
+          @brief  Create an empty mirror, with no storage until begin().
+  */
+  NvramCache() {}
+  ~NvramCache();
+  /*!
+          @brief  Not copyable: the mirror owns its storage.
+  */
+  NvramCache(const NvramCache &) = delete;
+  /*!
+          @brief  Not assignable: the mirror owns its storage.
+  */
+  NvramCache &operator=(const NvramCache &) = delete;
+  bool begin(uint8_t size);
+  /*!
+          @brief  Read one byte from the mirror.
+          @param address NVRAM address
+          @return The cached byte, or 0 past the end of the NVRAM or before
+            begin()
+  */
+  uint8_t readnvram(uint8_t address) const {
+    return address < size ? data[address] : 0;
+  }
+  void readnvram(uint8_t *buf, uint8_t size, uint8_t address) const;
+  void writenvram(uint8_t address, uint8_t data);
+  void writenvram(uint8_t address, const uint8_t *buf, uint8_t size);
+  bool nextDirtyRange(uint8_t &address, uint8_t &size);
+  /*!
+          @brief  Check whether the mirror holds unwritten changes.
+          @return True if at least one byte is dirty
+  */
+  bool isDirty() const { return dirtyCount > 0; }
+
+protected:
+  bool clip(uint8_t address, uint8_t &size) const;
+  uint8_t *data = NULL;   ///< Mirror of the NVRAM
+  uint8_t *dirty = NULL;  ///< Bitmap of the dirty bytes
+  uint8_t size = 0;       ///< Size of the NVRAM, in bytes
+  uint8_t dirtyCount = 0; ///< Number of dirty bytes
+};
+
+#define NVRAMSTORE_ABSENT 0xFF ///< Slot of a key holding no value
+#define NVRAMSTORE_PAIRED 0x02 ///< Flag: the other slot holds an older value
+
+/**************************************************************************/
+/*!
+        @brief  Bookkeeping of a journaled key/value store in NVRAM.
+
+        Every key owns two fixed record slots. A record holds the value,
+        a CRC-8 and a sequence number, in that order, and each write goes to
+        the slot not holding the current value. The sequence number is the
+        last byte written, so a write interrupted by a reset leaves the slot
+        with its older sequence number, or an invalid CRC, and the previous
+        value is recovered by begin(). A slot that may hold garbage is first
+        stamped with an older sequence number, so that an interrupted write
+        cannot make it look newer.
+
+        The slot of each key is computed directly, so a lookup costs a single
+        NVRAM read. This class holds the state; the transfers are done by
+        RTC_NvramStore.
+*/
+/**************************************************************************/
+class NvramStore {
+public:
+  ~NvramStore();
+  bool begin(uint8_t keys, uint8_t valueSize, uint8_t base,
+             uint8_t nvramSize);
+  /*!
+          @brief  Check whether a key holds a value.
+          @param key Key, from 0 to the number of keys - 1
+          @return True if a valid record was found or written for this key
+  */
+  bool contains(uint8_t key) const {
+    return key < keys && copies[key] != NVRAMSTORE_ABSENT;
+  }
+  /*!
+          @brief  Size of a record, in bytes.
+          @return Size of the value plus two
+  */
+  uint8_t recordSize() const { return valueSize + 2; }
+
+protected:
+  uint8_t address(uint8_t key, uint8_t copy) const;
+  uint8_t crc(uint8_t key) const;
+  void recover(uint8_t key, uint8_t copy);
+  bool decode(uint8_t key, uint8_t *value);
+  uint8_t prepare(uint8_t key, const uint8_t *value);
+  uint8_t *record = NULL; ///< Buffer holding one record
+  uint8_t *seqs = NULL;   ///< Sequence number of the current record, by key
+  uint8_t *copies = NULL; ///< Slot of the current record and flags, by key
+  uint8_t keys = 0;       ///< Number of keys
+  uint8_t valueSize = 0;  ///< Size of a value, in bytes
+  uint8_t base = 0;       ///< NVRAM address of the first record
+};
+
+/**************************************************************************/
+/*!
+        @brief  Power-fail-safe key/value store in the NVRAM of a DS1307 or
+        DS3232.
+
+        Keys are small integers and all values have the same size, fixed by
+        begin(). Usage:
+
+        ```
+        RTC_DS1307 rtc;
+        RTC_NvramStore<RTC_DS1307> store(rtc);
+        ...
+        store.begin(4, sizeof(uint32_t)); // 4 keys holding a uint32_t each
+        uint32_t boots = 0;
+        store.read(0, (uint8_t *)&boots);
+        boots++;
+        store.write(0, (uint8_t *)&boots);
+        ```
+
+        Any class providing `NVRAM_SIZE`, `readnvram(buf, size, address)`
+        and `writenvram(address, buf, size)` can serve as storage.
+*/
+/**************************************************************************/
+template <class RTC> class RTC_NvramStore : public NvramStore {
+public:
+  /*!
+          @brief  Attach the store to an RTC.
+          @param rtc The RTC holding the records. It should already be
+            started.
+  */
+  RTC_NvramStore(RTC &rtc) : rtc(rtc) {}
+  /*!
+          @brief  Scan the records and recover the latest value of each key.
+          @param keys Number of keys
+          @param valueSize Size of a value, in bytes
+          @param base NVRAM address of the first record. The store uses
+            `2 * keys * (valueSize + 2)` bytes from there.
+          @return False if the store does not fit in the NVRAM or the memory
+            could not be allocated, otherwise true
+  */
+  bool begin(uint8_t keys, uint8_t valueSize, uint8_t base = 0) {
+    if (!NvramStore::begin(keys, valueSize, base, RTC::NVRAM_SIZE))
+      return false;
+    for (uint8_t key = 0; key < keys; key++)
+      for (uint8_t copy = 0; copy < 2; copy++) {
+        rtc.readnvram(record, recordSize(), address(key, copy));
+        recover(key, copy);
+      }
+    return true;
+  }
+  /*!
+          @brief  Read the value of a key.
+          @details Should the current record have been damaged since
+            begin(), the previous value is returned instead.
+          @param key Key, from 0 to the number of keys - 1
+          @param value Buffer receiving the value
+          @return False if the key holds no valid value, otherwise true
+  */
+  bool read(uint8_t key, uint8_t *value) {
+    for (uint8_t i = 0; i < 2 && contains(key); i++) {
+      rtc.readnvram(record, recordSize(), address(key, copies[key]));
+      if (decode(key, value))
+        return true;
+    }
+    return false;
+  }
+  /*!
+          @brief  Write the value of a key.
+          @param key Key, from 0 to the number of keys - 1
+          @param value Buffer holding the value
+          @return False if the key is out of range, otherwise true
+  */
+  bool write(uint8_t key, const uint8_t *value) {
+    if (key >= keys)
+      return false;
+    if (contains(key) && !(copies[key] & NVRAMSTORE_PAIRED)) {
+      uint8_t older = seqs[key] - 1;
+      rtc.writenvram(address(key, copies[key] ^ 1) + recordSize() - 1, &older,
+                     1);
+    }
+    uint8_t address = prepare(key, value);
+    rtc.writenvram(address, record, recordSize());
+    return true;
+  }
+
+protected:
+  RTC &rtc; ///< RTC holding the records
+};
+
+#define NVRAMLOG_SLOT_SIZE 12 ///< Size of a copy of the NvramLog header
+#define NVRAMLOG_HEADER_SIZE                                                   \
+  (2 * NVRAMLOG_SLOT_SIZE) ///< Size of the NvramLog header, both copies
+#define NVRAMLOG_MAX_VARINT 5 ///< Longest encoding of a timestamp, in bytes
+
+/**************************************************************************/
+/*!
+        @brief  Encoding and bookkeeping of a compressed time-series ring
+        buffer in NVRAM.
+
+        Each record holds a timestamp followed by a fixed-size payload. The
+        timestamp is stored as the difference between the record's interval
+        and the previous one (delta of delta), as a zigzag varint, so that
+        periodic samples take a single byte of timestamp. The header holds
+        the time and interval of the oldest record, the ring position and
+        the number of bytes in use. It is kept in two copies, written in
+        turn, the one with the newer sequence number being current:
+
+        | Offset | Size | Content                                  |
+        |--------|------|------------------------------------------|
+        | 0      | 4    | Unix time of the oldest record           |
+        | 4      | 4    | Interval preceding the oldest record     |
+        | 8      | 1    | Ring offset of the oldest record         |
+        | 9      | 1    | Number of bytes in use                   |
+        | 10     | 1    | Check byte                               |
+        | 11     | 1    | Sequence number                          |
+
+        The sequence number is the last byte written, so a header write
+        interrupted by a reset leaves the older sequence number, or an
+        invalid check byte, and the other copy remains current.
+
+        When the ring is full, the oldest records are dropped. This class
+        holds the state; the transfers are done by RTC_NvramLog.
+*/
+/**************************************************************************/
+class NvramLog {
+public:
+  ~NvramLog();
+  bool begin(uint8_t payloadSize, uint8_t size);
+  /*!
+          @brief  Number of records in the log.
+          @return Number of records
+  */
+  uint8_t size() const { return count; }
+  /*!
+          @brief  Check whether the log is empty.
+          @return True if the log holds no record
+  */
+  bool empty() const { return count == 0; }
+  /*!
+          @brief  Number of bytes used by the records.
+          @return Bytes in use, out of the size given to begin() minus
+            #NVRAMLOG_HEADER_SIZE
+  */
+  uint8_t bytesUsed() const { return used; }
+
+protected:
+  uint8_t wrap(uint16_t offset) const;
+  uint8_t encode(uint32_t time, const uint8_t *payload);
+  void commit(uint32_t time, uint8_t length);
+  uint8_t decode(uint32_t &dod) const;
+  void evict(uint8_t length);
+  uint8_t advance(uint8_t *payload);
+  void packHeader();
+  bool validHeader(const uint8_t *copy) const;
+  uint8_t unpackHeader();
+  uint8_t *record = NULL;   ///< Encoded record to be written
+  uint8_t *buffer = NULL;   ///< Bytes read from the NVRAM
+  uint8_t payloadSize = 0;  ///< Size of a payload, in bytes
+  uint8_t dataSize = 0;     ///< Size of the ring, in bytes
+  uint8_t head = 0;         ///< Ring offset of the oldest record
+  uint8_t used = 0;         ///< Number of bytes in use
+  uint8_t count = 0;        ///< Number of records
+  uint32_t firstTime = 0;   ///< Time of the oldest record
+  uint32_t firstDelta = 0;  ///< Interval preceding the oldest record
+  uint32_t lastTime = 0;    ///< Time of the newest record
+  uint32_t lastDelta = 0;   ///< Interval preceding the newest record
+  uint8_t cursor = 0;       ///< Ring offset of the next record to read
+  uint8_t position = 0;     ///< Index of the next record to read
+  uint32_t cursorTime = 0;  ///< Time of the last record read
+  uint32_t cursorDelta = 0; ///< Interval preceding the last record read
+  uint8_t slot = 0;         ///< Header copy holding the current header
+  uint8_t sequence = 0;     ///< Sequence number of the current header
+};
+
+/**************************************************************************/
+/*!
+        @brief  Compressed time-series log in the NVRAM of a DS1307 or
+        DS3232.
+
+        Records are kept in battery-backed RAM, so they survive resets of
+        the MCU. Once the log is full, appending a record drops the oldest
+        ones. Usage:
+
+        ```
+        RTC_DS3232 rtc;
+        RTC_NvramLog<RTC_DS3232> samples(rtc);
+        ...
+        samples.begin(1); // one byte of payload per record
+        ...
+        uint8_t level = analogRead(A0) >> 2;
+        samples.append(rtc.now(), &level);
+        ...
+        uint32_t time;
+        samples.rewind();
+        while (samples.read(time, &level))
+          Serial.println(level);
+        ```
+
+        Any class providing `NVRAM_SIZE`, `readnvram(buf, size, address)`
+        and `writenvram(address, buf, size)` can serve as storage.
+
+        @warning A record is written before the header that commits it, and
+        the records it overwrites are dropped by a header written first, so
+        a reset in the middle of append() loses at most that record and the
+        ones it would have dropped.
+*/
+/**************************************************************************/
+template <class RTC> class RTC_NvramLog : public NvramLog {
+public:
+  /*!
+          @brief  Attach the log to an RTC.
+          @param rtc The RTC holding the records. It should already be
+            started.
+  */
+  RTC_NvramLog(RTC &rtc) : rtc(rtc) {}
+  /*!
+          @brief  Recover the log from the NVRAM, or start an empty one if
+            none is found.
+          @param payloadSize Size of the payload of a record, in bytes
+          @param base NVRAM address of the log
+          @param size Number of NVRAM bytes used by the log, header included,
+            or zero to use the NVRAM up to its end
+          @return False if the log does not fit in the NVRAM or the memory
+            could not be allocated, otherwise true
+  */
+  bool begin(uint8_t payloadSize, uint8_t base = 0, uint8_t size = 0) {
+    if (base >= RTC::NVRAM_SIZE)
+      return false;
+    if (size == 0 || size > RTC::NVRAM_SIZE - base)
+      size = RTC::NVRAM_SIZE - base;
+    if (!NvramLog::begin(payloadSize, size))
+      return false;
+    this->base = base;
+    rtc.readnvram(buffer, NVRAMLOG_HEADER_SIZE, base);
+    uint8_t copies = unpackHeader();
+    if (copies == 0) {
+      // the next header goes to copy 0, so mark copy 1 as the older one
+      slot = 1;
+      sequence = 0;
+      stamp(1, sequence);
+      clear();
+      return true;
+    }
+    if (copies == 1)
+      stamp(slot ^ 1, sequence - 1);
+    // replay the records to find the newest one
+    uint8_t total = used;
+    used = 0;
+    lastTime = firstTime;
+    lastDelta = firstDelta;
+    rewind();
+    while (used < total) {
+      load(cursor);
+      uint8_t length = advance(NULL);
+      if (length == 0 || length > total - used)
+        break;
+      used += length;
+      count++;
+      lastTime = cursorTime;
+      lastDelta = cursorDelta;
+    }
+    if (used != total)
+      writeHeader();
+    rewind();
+    return true;
+  }
+  /*!
+          @brief  Drop all records.
+  */
+  void clear() {
+    head = used = count = 0;
+    firstTime = lastTime = 0;
+    firstDelta = lastDelta = 0;
+    writeHeader();
+    rewind();
+  }
+  /*!
+          @brief  Append a record, dropping the oldest ones if needed.
+          @param time Unix time of the record
+          @param payload Payload of the record
+  */
+  void append(uint32_t time, const uint8_t *payload) {
+    uint8_t length = encode(time, payload);
+    bool evicted = used + length > dataSize;
+    while (used + length > dataSize) {
+      load(head);
+      uint32_t dod;
+      evict(decode(dod));
+      if (count > 0) {
+        load(head);
+        decode(dod);
+        firstDelta += dod;
+        firstTime += firstDelta;
+      }
+    }
+    if (count == 0)
+      length = encode(time, payload);
+    // drop the evicted records before the new one overwrites them
+    if (evicted)
+      writeHeader();
+    store(wrap(head + used), record, length);
+    commit(time, length);
+    writeHeader();
+  }
+  /*!
+          @brief  Append a record, dropping the oldest ones if needed.
+          @param dt Date and time of the record
+          @param payload Payload of the record
+  */
+  void append(const DateTime &dt, const uint8_t *payload) {
+    append(dt.unixtime(), payload);
+  }
+  /*!
+          @brief  Move the read cursor back to the oldest record.
+  */
+  void rewind() {
+    cursor = head;
+    position = 0;
+  }
+  /*!
+          @brief  Read the record under the cursor and move to the next one.
+          @param[out] time Unix time of the record
+          @param payload Buffer receiving the payload
+          @return False if all the records have been read, otherwise true
+  */
+  bool read(uint32_t &time, uint8_t *payload) {
+    if (position >= count)
+      return false;
+    load(cursor);
+    if (advance(payload) == 0)
+      return false;
+    time = cursorTime;
+    return true;
+  }
+
+protected:
+  /*!
+          @brief  Read the longest possible record from a ring offset into
+            the buffer.
+          @param offset Ring offset
+  */
+  void load(uint8_t offset) {
+    uint8_t size = NVRAMLOG_MAX_VARINT + payloadSize;
+    uint8_t first = dataSize - offset;
+    uint8_t address = base + NVRAMLOG_HEADER_SIZE;
+    if (size <= first) {
+      rtc.readnvram(buffer, size, address + offset);
+    } else {
+      rtc.readnvram(buffer, first, address + offset);
+      rtc.readnvram(buffer + first, size - first, address);
+    }
+  }
+  /*!
+          @brief  Write bytes to the ring, wrapping around its end.
+          @param offset Ring offset
+          @param buf Bytes to write
+          @param size Number of bytes
+  */
+  void store(uint8_t offset, const uint8_t *buf, uint8_t size) {
+    uint8_t first = dataSize - offset;
+    uint8_t address = base + NVRAMLOG_HEADER_SIZE;
+    if (size <= first) {
+      rtc.writenvram(address + offset, buf, size);
+    } else {
+      rtc.writenvram(address + offset, buf, first);
+      rtc.writenvram(address, buf + first, size - first);
+    }
+  }
+  /*!
+          @brief  Write the header to the NVRAM, over the older copy.
+  */
+  void writeHeader() {
+    packHeader();
+    slot ^= 1;
+    rtc.writenvram(base + slot * NVRAMLOG_SLOT_SIZE, buffer,
+                   NVRAMLOG_SLOT_SIZE);
+  }
+  /*!
+          @brief  Overwrite the sequence number of a header copy, so that a
+            header write interrupted there cannot look newer.
+          @param copy Header copy, 0 or 1
+          @param seq Sequence number, older than the current one
+  */
+  void stamp(uint8_t copy, uint8_t seq) {
+    rtc.writenvram(base + (copy + 1) * NVRAMLOG_SLOT_SIZE - 1, &seq, 1);
+  }
+  RTC &rtc;         ///< RTC holding the records
+  uint8_t base = 0; ///< NVRAM address of the header
+};
+
+#ifdef ARDUINO
+/**************************************************************************/
+/*!
+        @brief  Wrapper adding a monotonic timescale to a hardware RTC.
+
+        Hardware RTCs only keep wall-clock time, which jumps whenever they are
+        adjusted. This wrapper keeps track of every adjustment made through it,
+        and combines the RTC seconds with `millis()` to provide a sub-second
+        monotonic reading that never goes backwards. Usage:
+
+        ```
+        RTC_DS3231 rtc;
+        RTC_Monotonic<RTC_DS3231> clock(rtc);
+        MonotonicTime start = clock.monotonic();
+        ...
+        if (clock.monotonic().millisSince(start) > 500) { ... }
+        ```
+
+        @note Adjust the RTC through this wrapper, not directly, otherwise
+          forward jumps cannot be told apart from elapsed time. Backward jumps
+          are always absorbed. The fraction of a second is measured from the
+          first reading that observed the current second, so its accuracy
+          depends on how often monotonic() is called.
+*/
+/**************************************************************************/
+template <class RTC> class RTC_Monotonic {
+public:
+  /*!
+          @brief  Wrap an RTC object.
+          @param rtc The RTC to read from. It should already be started.
+  */
+  RTC_Monotonic(RTC &rtc) : rtc(rtc) {}
+  /*!
+          @brief  Read the wall-clock date/time from the wrapped RTC.
+          @return DateTime object containing the current date/time
+  */
+  DateTime now() { return rtc.now(); }
+  /*!
+          @brief  Set the wall-clock date/time of the wrapped RTC without
+            disturbing the monotonic timescale.
+          @param dt DateTime object with the desired date and time
+  */
+  void adjust(const DateTime &dt) {
+    uint32_t before = rtc.now().unixtime();
+    rtc.adjust(dt);
+    offset += before - dt.unixtime();
+  }
+  /*!
+          @brief  Read the monotonic timescale.
+          @return MonotonicTime whose origin is the Unix epoch, as set on the
+            RTC when the wrapper was created.
+  */
+  MonotonicTime monotonic() {
+    uint32_t seconds = rtc.now().unixtime() + offset;
+    uint32_t ms = millis();
+    if (!started) {
+      started = true;
+      lastSeconds = seconds;
+      lastMillis = ms;
+    } else if (seconds != lastSeconds) {
+      if ((int32_t)(seconds - lastSeconds) < 0) {
+        // The RTC went backwards behind our back: absorb the jump
+        offset += lastSeconds - seconds;
+        seconds = lastSeconds;
+      } else {
+        lastSeconds = seconds;
+        lastMillis = ms;
+      }
+    }
+    uint32_t fraction = ms - lastMillis;
+    if (fraction > 999)
+      fraction = 999;
+    return MonotonicTime(seconds, fraction * 1000);
+  }
+
+protected:
+  RTC &rtc;                 ///< Wrapped RTC
+  uint32_t offset = 0;      ///< Monotonic seconds minus RTC Unix time
+  uint32_t lastSeconds = 0; ///< Last monotonic second observed
+  uint32_t lastMillis = 0;  ///< `millis()` when `lastSeconds` was observed
+  bool started = false;     ///< Whether `lastSeconds` holds a reading yet
+};
+
+/**************************************************************************/
+/*!
+        @brief  Wait for the seconds of an RTC to tick over.
+        @details The RTC is polled every millisecond, which leaves the bus
+          mostly free for other devices, and catches the new second within
+          about a millisecond plus the time of one read.
+        @param rtc The RTC to poll.
+        @return The first DateTime read from the RTC in the new second.
+*/
+/**************************************************************************/
+template <class RTC> DateTime waitForNextSecond(RTC &rtc) {
+  uint8_t second = rtc.now().second();
+  for (;;) {
+    delay(1);
+    DateTime dt = rtc.now();
+    if (dt.second() != second)
+      return dt;
+  }
+}
+
+/**************************************************************************/
+/*!
+        @brief  Measure the drift of an RTC against a reference clock.
+
+        The RTC is read at the exact start of one of its seconds at the
+        beginning and at the end of the measurement window, and the reference
+        is read at the same moments. This blocks for the whole window, so it
+        is meant for calibration sketches. The longer the window, the more
+        precise the result: with a millisecond reference, one day resolves
+        about 0.01&nbsp;ppm.
+
+        @param rtc The RTC being measured, e.g. an RTC_DS3231.
+        @param reference The reference clock: any class with a `monotonic()`
+          method, e.g. RTC_Micros or RTC_Monotonic<RTC_DS3231>.
+        @param windowSeconds Length of the measurement window, in seconds of
+          the reference clock.
+        @return Drift in parts per billion (ppb). Positive values mean the RTC
+          is running fast.
+*/
+/**************************************************************************/
+template <class RTC, class REF>
+int32_t measureDrift(RTC &rtc, REF &reference, uint32_t windowSeconds) {
+  DateTime rtcStart = waitForNextSecond(rtc);
+  MonotonicTime refStart = reference.monotonic();
+  while (reference.monotonic().secondsSince(refStart) < windowSeconds)
+    delay(10);
+  DateTime rtcEnd = waitForNextSecond(rtc);
+  MonotonicTime refEnd = reference.monotonic();
+
+  int64_t refMicros =
+      (int64_t)(refEnd.seconds() - refStart.seconds()) * 1000000 +
+      (int32_t)refEnd.microseconds() - (int32_t)refStart.microseconds();
+  int64_t rtcMicros = (int64_t)(rtcEnd - rtcStart).totalseconds() * 1000000;
+  return (rtcMicros - refMicros) * 1000000000 / refMicros;
+}
+
+/**************************************************************************/
+/*!
+        @brief  Any number of software alarms multiplexed over alarm 1 of a
+   DS3231 or DS3232.
+
+        The earliest alarm of the queue is always programmed into the
+        hardware alarm, in `Date` mode, or in `PerSecond` mode while it is
+        already due. The SQW pin must be in interrupt mode,
+        i.e. `writeSqwPinMode(DS3231_OFF)`, and alarm 1 is reserved for the
+        scheduler. When the INT/SQW pin goes low, or periodically, process the
+        due alarms with:
+
+        ```
+        int16_t id;
+        while ((id = scheduler.poll()) >= 0) {
+          // handle alarm id
+        }
+        ```
+
+        Repeating alarms are rescheduled automatically; missed periods are
+        skipped rather than fired in a burst.
+*/
+/**************************************************************************/
+template <class RTC> class RTC_AlarmScheduler : protected AlarmQueue {
+public:
+  // Only the read-only accessors are exposed as they are: changing the
+  // queue must go through add(), remove() and poll(), which rearm the
+  // hardware alarm
+  using AlarmQueue::begin;
+  using AlarmQueue::empty;
+  using AlarmQueue::nextId;
+  using AlarmQueue::nextTime;
+  using AlarmQueue::size;
+  /*!
+          @brief  Attach the scheduler to an RTC.
+          @param rtc The RTC providing the hardware alarm. It should already
+            be started.
+  */
+  RTC_AlarmScheduler(RTC &rtc) : rtc(rtc) {}
+  /*!
+          @brief  Schedule an alarm, reprogramming the hardware alarm if it
+            becomes the earliest one.
+          @param dt Date and time of the first occurrence. An alarm that
+            is already due is returned by the next poll().
+          @param period Repeat period, or zero for a one-shot alarm
+          @return Alarm id, or -1 if the queue is full or the period is
+            negative
+  */
+  int16_t add(const DateTime &dt, const TimeSpan &period = TimeSpan(0)) {
+    if (period.totalseconds() < 0)
+      return -1;
+    int16_t id = AlarmQueue::add(dt.unixtime(), period.totalseconds());
+    if (id >= 0 && nextId() == (uint16_t)id)
+      arm();
+    return id;
+  }
+  /*!
+          @brief  Cancel an alarm, reprogramming the hardware alarm if it was
+            the earliest one.
+          @param id Alarm id returned by add()
+          @return False if there was no such alarm, otherwise true
+  */
+  bool remove(uint16_t id) {
+    bool wasNext = !empty() && nextId() == id;
+    if (!AlarmQueue::remove(id))
+      return false;
+    if (wasNext)
+      arm();
+    return true;
+  }
+  /*!
+          @brief  Return the next due alarm, if any.
+          @details When no alarm is due anymore, this clears the hardware
+            alarm flag and programs the next alarm.
+          @return Id of a due alarm, or -1 if none is due
+  */
+  int16_t poll() {
+    for (;;) {
+      int16_t id = fire(rtc.now().unixtime());
+      if (id >= 0)
+        return id;
+      rtc.clearAlarm(1);
+      arm();
+      if (!due)
+        return -1;
+    }
+  }
+  /*!
+          @brief  Program the earliest alarm into the hardware alarm, or
+            disable the hardware alarm if the queue is empty.
+          @details The time is read back once the alarm is programmed. If
+            the alarm is due by then, because it was set in the past or the
+            second ticked over meanwhile, a date match would only come next
+            month: alarm 1 is switched to fire every second instead, so that
+            INT/SQW goes low within a second and poll() returns the alarm.
+          @return False if the RTC is not in interrupt mode, otherwise true
+  */
+  bool arm() {
+    due = false;
+    if (empty()) {
+      rtc.disableAlarm(1);
+      return true;
+    }
+    if (!setAlarm(rtc, DateTime(nextTime()), false))
+      return false;
+    if (nextTime() > rtc.now().unixtime())
+      return true;
+    due = true;
+    return setAlarm(rtc, DateTime(nextTime()), true);
+  }
+
+protected:
+  /*!
+          @brief  Program alarm 1 of a DS3231.
+          @param rtc The RTC
+          @param dt Date and time to match
+          @param everySecond True to fire every second rather than on a
+            date match
+          @return Result of `setAlarm1()`
+  */
+  static bool setAlarm(RTC_DS3231 &rtc, const DateTime &dt,
+                       bool everySecond) {
+    return rtc.setAlarm1(dt, everySecond ? DS3231_A1_PerSecond
+                                         : DS3231_A1_Date);
+  }
+  /*!
+          @brief  Program alarm 1 of a DS3232.
+          @param rtc The RTC
+          @param dt Date and time to match
+          @param everySecond True to fire every second rather than on a
+            date match
+          @return Result of `setAlarm1()`
+  */
+  static bool setAlarm(RTC_DS3232 &rtc, const DateTime &dt,
+                       bool everySecond) {
+    return rtc.setAlarm1(dt, everySecond ? DS3232_A1_PerSecond
+                                         : DS3232_A1_Date);
+  }
+  RTC &rtc;         ///< RTC providing the hardware alarm
+  bool due = false; ///< The earliest alarm was due when last armed
+};
+
+/**************************************************************************/
+/*!
+        @brief  Write-back cache of the NVRAM of a DS1307 or DS3232.
+
+        The whole NVRAM is loaded by begin(); reads are then served from RAM
+        without touching the bus, and writes are deferred until flush(),
+        which writes the dirty bytes back as a few burst transfers. Usage:
+
+        ```
+        RTC_DS3232 rtc;
+        RTC_NvramCache<RTC_DS3232> nvram(rtc);
+        ...
+        nvram.begin(1000); // flush at most one second after a change
+        nvram.writenvram(0, counter);
+        ...
+        void loop() { nvram.update(); }
+        ```
+
+        @warning Data written since the last flush is lost if the MCU resets.
+*/
+/**************************************************************************/
+template <class RTC> class RTC_NvramCache : public NvramCache {
+public:
+  /*!
+          @brief  Attach the cache to an RTC.
+          @param rtc The RTC whose NVRAM is mirrored. It should already be
+            started.
+  */
+  RTC_NvramCache(RTC &rtc) : rtc(rtc) {}
+  /*!
+          @brief  Load the NVRAM into the cache.
+          @param flushInterval Maximum time in milliseconds between the first
+            write and the automatic flush performed by update(), or zero to
+            only flush explicitly.
+          @return False if the memory could not be allocated, otherwise true
+  */
+  bool begin(uint32_t flushInterval = 0) {
+    if (!NvramCache::begin(RTC::NVRAM_SIZE))
+      return false;
+    rtc.readnvram(data, RTC::NVRAM_SIZE, 0);
+    interval = flushInterval;
+    return true;
+  }
+  /*!
+          @brief  Shortcut to write one byte to the cache
+          @param address NVRAM address
+          @param data One byte to write
+  */
+  void writenvram(uint8_t address, uint8_t data) {
+    if (!isDirty())
+      dirtySince = millis();
+    NvramCache::writenvram(address, data);
+  }
+  /*!
+          @brief  Write data to the cache
+          @param address Starting NVRAM address
+          @param buf Pointer to buffer containing the data to write
+          @param size Number of bytes in buf to write
+  */
+  void writenvram(uint8_t address, const uint8_t *buf, uint8_t size) {
+    if (!isDirty())
+      dirtySince = millis();
+    NvramCache::writenvram(address, buf, size);
+  }
+  /*!
+          @brief  Write all dirty bytes back to the RTC.
+  */
+  void flush() {
+    uint8_t address, size;
+    while (nextDirtyRange(address, size))
+      rtc.writenvram(address, data + address, size);
+  }
+  /*!
+          @brief  Flush the cache if the flush interval has elapsed since
+            the first unwritten change. Call this from `loop()`.
+          @return True if the cache was flushed
+  */
+  bool update() {
+    if (interval == 0 || !isDirty() || millis() - dirtySince < interval)
+      return false;
+    flush();
+    return true;
+  }
+
+protected:
+  RTC &rtc;                ///< RTC whose NVRAM is mirrored
+  uint32_t interval = 0;   ///< Automatic flush interval, in milliseconds
+  uint32_t dirtySince = 0; ///< `millis()` at the first unwritten change
+};
+
+#define NVRAMCENTURY_SIZE 3 ///< Bytes of NVRAM used by RTC_NvramCentury
+
+/**************************************************************************/
+/*!
+        @brief  Wrapper extending an RTC that stores two-digit years, such
+   as the DS1307, to years 1--9999, with the century kept in its NVRAM.
+
+        The NVRAM holds the century, the last two-digit year seen and a
+        check byte. Reading the time carries a step of the chip's year from
+        99 to 00 into the century; any other change, such as the chip being
+        set by another sketch, only updates the last year seen. The time
+        must thus be read at least once in each year ending in 99, and
+        again in the next one. The NVRAM is only written when the year
+        changes. Usage:
+
+        ```
+        RTC_DS1307 rtc;
+        RTC_NvramCentury<RTC_DS1307> clock(rtc);
+        ...
+        clock.begin();
+        DateTime64 now = clock.now64();
+        ```
+
+        @note The chip takes every year ending in 00 as a leap year: a clock
+          running through the 28th of February of such a non-leap year reads
+          one day ahead afterwards, until adjusted again. The DS3231, DS3232
+          and PCF8563 have a century bit of their own; use their `now64()`
+          for 2000--2199 instead.
+*/
+/**************************************************************************/
+template <class RTC> class RTC_NvramCentury {
+public:
+  /*!
+          @brief  Wrap an RTC object.
+          @param rtc The RTC to read from. It should already be started.
+  */
+  RTC_NvramCentury(RTC &rtc) : rtc(rtc) {}
+  /*!
+          @brief  Load the century from the NVRAM.
+          @param address NVRAM address of the #NVRAMCENTURY_SIZE bytes used,
+            by default at the end of the NVRAM
+          @param century Century to assume, e.g. 20 for 2000--2099, if the
+            NVRAM holds no valid record yet
+          @return False if the NVRAM held no valid record, otherwise true
+  */
+  bool begin(uint8_t address = RTC::NVRAM_SIZE - NVRAMCENTURY_SIZE,
+             uint8_t century = 20) {
+    this->address = address;
+    uint8_t record[NVRAMCENTURY_SIZE];
+    rtc.readnvram(record, NVRAMCENTURY_SIZE, address);
+    if ((uint8_t)(record[0] + record[1] + record[2]) == 0x5A &&
+        record[0] < 100 && record[1] < 100) {
+      this->century = record[0];
+      lastYear = record[1];
+      return true;
+    }
+    this->century = century;
+    lastYear = rtc.now().year() - 2000U;
+    store();
+    return false;
+  }
+  /*!
+          @brief  Set the date and time of the wrapped RTC and the century.
+          @param dt DateTime64 with the desired date and time. Invalid
+            dates are ignored.
+  */
+  void adjust(const DateTime64 &dt) {
+    if (!dt.isValid())
+      return;
+    uint8_t year = dt.year() % 100;
+    rtc.adjust(DateTime(2000U + year, dt.month(), dt.day(), dt.hour(),
+                        dt.minute(), dt.second()));
+    century = dt.year() / 100;
+    lastYear = year;
+    store();
+  }
+  /*!
+          @brief  Read the date and time, with the century.
+          @return DateTime64 object containing the current date/time
+  */
+  DateTime64 now64() {
+    DateTime dt = rtc.now();
+    uint8_t year = dt.year() - 2000U;
+    if (year != lastYear) {
+      if (lastYear == 99 && year == 0)
+        century++;
+      lastYear = year;
+      store();
+    }
+    return DateTime64(100 * century + year, dt.month(), dt.day(), dt.hour(),
+                      dt.minute(), dt.second());
+  }
+
+protected:
+  /*!
+          @brief  Write the century and the last year seen to the NVRAM.
+  */
+  void store() {
+    uint8_t record[NVRAMCENTURY_SIZE] = {
+        century, lastYear, (uint8_t)(0x5A - century - lastYear)};
+    rtc.writenvram(address, record, NVRAMCENTURY_SIZE);
+  }
+  RTC &rtc;             ///< Wrapped RTC
+  uint8_t address = 0;  ///< NVRAM address of the record
+  uint8_t century = 20; ///< Century of the last year seen, e.g. 20
+  uint8_t lastYear = 0; ///< Last two-digit year seen
 };
+#endif // ARDUINO
 
 #endif // _RTCLIB_H_
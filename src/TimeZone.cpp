@@ -0,0 +1,308 @@
+#include "RTClib.h"
+
+/**************************************************************************/
+/*!
+    @brief  Check whether a character is a decimal digit
+    @param c Character
+    @return True if c is a digit
+*/
+/**************************************************************************/
+static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+/**************************************************************************/
+/*!
+    @brief  Parse a decimal number
+    @param[in,out] p Parsing position, moved past the number
+    @param[out] value The number
+    @return False if there is no number at p, otherwise true
+*/
+/**************************************************************************/
+static bool parseNumber(const char *&p, uint16_t &value) {
+  if (!isDigit(*p))
+    return false;
+  value = 0;
+  while (isDigit(*p) && value < 1000)
+    value = value * 10 + (*p++ - '0');
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parse a zone abbreviation, either alphabetic or quoted in
+    angle brackets
+    @param[in,out] p Parsing position, moved past the abbreviation
+    @param[out] name Buffer of #TIMEZONE_NAME_SIZE characters receiving
+    the abbreviation
+    @return False if the abbreviation is malformed or too long, otherwise
+    true
+*/
+/**************************************************************************/
+static bool parseName(const char *&p, char *name) {
+  const char *begin = p;
+  if (*p == '<') {
+    begin = ++p;
+    while (*p && *p != '>')
+      p++;
+    if (*p != '>')
+      return false;
+  } else {
+    while ((*p | 0x20) >= 'a' && (*p | 0x20) <= 'z')
+      p++;
+  }
+  size_t len = p - begin;
+  if (*p == '>')
+    p++;
+  if (len < 3 || len >= TIMEZONE_NAME_SIZE)
+    return false;
+  memcpy(name, begin, len);
+  name[len] = '\0';
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parse a signed time of the form `[+-]hh[:mm[:ss]]`
+    @param[in,out] p Parsing position, moved past the time
+    @param[out] seconds The time, in seconds
+    @return False if the time is malformed, otherwise true
+*/
+/**************************************************************************/
+static bool parseTime(const char *&p, int32_t &seconds) {
+  bool negative = *p == '-';
+  if (*p == '+' || *p == '-')
+    p++;
+  uint16_t hours, minutes = 0, secs = 0;
+  if (!parseNumber(p, hours) || hours > 167)
+    return false;
+  if (*p == ':') {
+    p++;
+    if (!parseNumber(p, minutes) || minutes > 59)
+      return false;
+    if (*p == ':') {
+      p++;
+      if (!parseNumber(p, secs) || secs > 59)
+        return false;
+    }
+  }
+  seconds = hours * 3600L + minutes * 60 + secs;
+  if (negative)
+    seconds = -seconds;
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Load the rules of a time zone
+    @param tz POSIX TZ string, e.g. "CET-1CEST,M3.5.0,M10.5.0/3" or
+    "<+0530>-5:30"
+    @return False if the string is malformed, in which case the zone is set
+    to UTC, otherwise true
+*/
+/**************************************************************************/
+bool TimeZone::begin(const char *tz) {
+  yearStart = yearEnd = 0; // empty the cache
+  if (parse(tz))
+    return true;
+  strcpy(stdName, "UTC");
+  dstName[0] = '\0';
+  stdOffset = dstOffset = 0;
+  hasDST = false;
+  return false;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parse a POSIX TZ string
+    @param tz TZ string
+    @return False if the string is malformed, otherwise true
+*/
+/**************************************************************************/
+bool TimeZone::parse(const char *tz) {
+  const char *p = tz;
+  int32_t west;
+  hasDST = false;
+  dstName[0] = '\0';
+  if (!parseName(p, stdName) || !parseTime(p, west))
+    return false;
+  stdOffset = dstOffset = -west;
+  if (*p == '\0')
+    return true;
+  if (!parseName(p, dstName))
+    return false;
+  dstOffset = stdOffset + 3600;
+  if (*p != '\0' && *p != ',') {
+    if (!parseTime(p, west))
+      return false;
+    dstOffset = -west;
+  }
+  if (*p == ',') {
+    p++;
+    if (!parseRule(p, start) || *p++ != ',' || !parseRule(p, end))
+      return false;
+  } else {
+    const char *rules = "M3.2.0,M11.1.0"; // current US rules
+    parseRule(rules, start);
+    rules++;
+    parseRule(rules, end);
+  }
+  hasDST = *p == '\0';
+  return hasDST;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Parse the start or end of DST, of the form `Mm.w.d[/time]`,
+    `Jn[/time]` or `n[/time]`
+    @param[in,out] p Parsing position, moved past the rule
+    @param[out] rule The rule
+    @return False if the rule is malformed, otherwise true
+*/
+/**************************************************************************/
+bool TimeZone::parseRule(const char *&p, Rule &rule) {
+  uint16_t month, week;
+  rule.type = *p == 'M' || *p == 'J' ? *p++ : 'n';
+  if (rule.type == 'M') {
+    if (!parseNumber(p, month) || month < 1 || month > 12 || *p++ != '.' ||
+        !parseNumber(p, week) || week < 1 || week > 5 || *p++ != '.' ||
+        !parseNumber(p, rule.day) || rule.day > 6)
+      return false;
+    rule.month = month;
+    rule.week = week;
+  } else if (!parseNumber(p, rule.day) || rule.day > 365 ||
+             (rule.type == 'J' && rule.day < 1)) {
+    return false;
+  }
+  rule.time = 7200;
+  if (*p == '/') {
+    p++;
+    return parseTime(p, rule.time);
+  }
+  return true;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compute when a rule applies in a given year
+    @param rule The rule
+    @param year Year, 2000--2099
+    @return Local date and time of the transition, as seconds since
+    1970-01-01 00:00:00 local time
+*/
+/**************************************************************************/
+uint32_t TimeZone::transition(const Rule &rule, uint16_t year) const {
+  uint8_t leap = year % 4 == 0;
+  uint32_t day; // days since 1970-01-01
+  if (rule.type == 'M') {
+    DateTime first(year, rule.month, 1);
+    uint8_t length = rule.month == 2
+                         ? 28 + leap
+                         : 30 + ((rule.month + (rule.month >> 3)) & 1);
+    uint8_t mday = 1 + (rule.day + 7 - first.dayOfTheWeek()) % 7;
+    mday += 7 * (rule.week - 1);
+    if (mday > length)
+      mday -= 7;
+    day = first.unixtime() / 86400 + mday - 1;
+  } else {
+    day = DateTime(year, 1, 1).unixtime() / 86400 + rule.day;
+    if (rule.type == 'J')
+      day += (leap && rule.day >= 60) - 1;
+  }
+  return day * 86400 + rule.time;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Compute the DST transitions of the year of a time
+    @details Times before 2000 or after 2099 use the transitions of the
+    nearest year.
+    @param utc Unix time, UTC
+*/
+/**************************************************************************/
+void TimeZone::cacheYear(uint32_t utc) {
+  uint16_t year =
+      utc < SECONDS_FROM_1970_TO_2000 ? 2000U : DateTime(utc).year();
+  if (year > 2099U)
+    year = 2099U;
+  yearStart = year == 2000U ? 0 : DateTime(year, 1, 1).unixtime();
+  yearEnd = year == 2099U ? 0xFFFFFFFF : DateTime(year + 1, 1, 1).unixtime();
+  // DST starts in standard time and ends in DST
+  dstStart = transition(start, year) - stdOffset;
+  dstEnd = transition(end, year) - dstOffset;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check whether DST is in effect at a given time
+    @param utc Unix time, UTC
+    @return True if DST is in effect
+*/
+/**************************************************************************/
+bool TimeZone::dstAt(uint32_t utc) {
+  if (!hasDST)
+    return false;
+  if (utc < yearStart || utc >= yearEnd)
+    cacheYear(utc);
+  if (dstStart < dstEnd) // northern hemisphere
+    return utc >= dstStart && utc < dstEnd;
+  return utc >= dstStart || utc < dstEnd;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Check whether DST is in effect at a given time
+    @param utc Date and time, UTC
+    @return True if DST is in effect
+*/
+/**************************************************************************/
+bool TimeZone::isDST(const DateTime &utc) { return dstAt(utc.unixtime()); }
+
+/**************************************************************************/
+/*!
+    @brief  Offset of local time from UTC at a given time
+    @param utc Date and time, UTC
+    @return Offset in seconds, positive east of Greenwich
+*/
+/**************************************************************************/
+int32_t TimeZone::offset(const DateTime &utc) {
+  return dstAt(utc.unixtime()) ? dstOffset : stdOffset;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Abbreviation of the local time at a given time
+    @param utc Date and time, UTC
+    @return The abbreviation, e.g. "CET" or "CEST"
+*/
+/**************************************************************************/
+const char *TimeZone::abbreviation(const DateTime &utc) {
+  return dstAt(utc.unixtime()) ? dstName : stdName;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Convert UTC to local time
+    @param utc Date and time, UTC
+    @return Local date and time
+*/
+/**************************************************************************/
+DateTime TimeZone::toLocal(const DateTime &utc) {
+  uint32_t t = utc.unixtime();
+  return DateTime(t + (dstAt(t) ? dstOffset : stdOffset));
+}
+
+/**************************************************************************/
+/*!
+    @brief  Convert local time to UTC
+    @details A local time occurring twice, when DST ends, is taken as the
+    first occurrence, in DST. A local time skipped when DST starts is taken
+    as standard time, and thus lands after the transition.
+    @param local Local date and time
+    @return Date and time, UTC
+*/
+/**************************************************************************/
+DateTime TimeZone::toUTC(const DateTime &local) {
+  uint32_t t = local.unixtime();
+  if (hasDST && dstAt(t - dstOffset))
+    return DateTime(t - dstOffset);
+  return DateTime(t - stdOffset);
+}